@@ -0,0 +1,32 @@
+import os
+import subprocess
+import tempfile
+
+import PySouffle
+
+# programs with user-defined functors are linked against libfunctors in the working directory
+functors = """
+#include <cstdint>
+extern "C" {
+int32_t inc(int32_t x) { return x + 1; }
+}
+"""
+
+datalog = ".functor inc(number):number \n .decl A(x:number) \n .decl B(x:number) \n .output B \n B(@inc(x)) :- A(x)."
+
+workdir = tempfile.mkdtemp()
+os.chdir(workdir)
+with open("functors.cpp", "w") as source:
+    source.write(functors)
+subprocess.check_call(["c++", "-shared", "-fPIC", "functors.cpp", "-o", "libfunctors.so"])
+
+PySouffle.enable_compilation(os.path.join(workdir, "cache"))
+program = PySouffle.Program(datalog)
+assert program.compiled, "the program has not been compiled"
+
+result = program.run({"A": [["1"], ["41"]]})
+print(result)
+assert sorted(t for t in result["B"] if t) == ["2", "42"]
+
+PySouffle.disable_compilation()
+print("end")
@@ -21,6 +21,7 @@
 #include "AstClause.h"
 #include "AstFunctorDeclaration.h"
 #include "AstIO.h"
+#include "AstIOTypeAnalysis.h"
 #include "AstLiteral.h"
 #include "AstNode.h"
 #include "AstProgram.h"
@@ -1577,6 +1578,10 @@ void AstTranslator::translateProgram(const AstTranslationUnit& translationUnit)
     // get auxiliary arity analysis
     auxArityAnalysis = translationUnit.getAnalysis<AuxiliaryArity>();
 
+    // obtain the IO types and the clauses of relations, identifying the read-only relations
+    const auto* ioType = translationUnit.getAnalysis<IOType>();
+    const auto* relationDetail = translationUnit.getAnalysis<RelationDetailCache>();
+
     // start with an empty sequence of ram statements
     std::vector<std::unique_ptr<RamStatement>> res;
 
@@ -1637,6 +1642,11 @@ void AstTranslator::translateProgram(const AstTranslationUnit& translationUnit)
             auto arity = rel->getArity();
             auto auxiliaryArity = auxArityAnalysis->getArity(rel);
             auto representation = rel->getRepresentation();
+            // input relations never derived by a clause are only read after being loaded
+            if (representation == RelationRepresentation::DEFAULT && arity > 0 && ioType->isInput(rel) &&
+                    relationDetail->getClauses(rel).empty() && !Global::config().has("provenance")) {
+                representation = RelationRepresentation::SORTED;
+            }
             const auto& attributes = rel->getAttributes();
             std::vector<std::string> attributeNames;
             std::vector<std::string> attributeTypeQualifiers;
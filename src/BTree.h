@@ -21,14 +21,22 @@
 #include "Util.h"
 
 #include <cassert>
+#include <cstdint>
 #include <iostream>
 #include <iterator>
 #include <type_traits>
 #include <utility>
 #include <vector>
 
+#if defined(__SSE2__) || defined(__AVX2__)
+#include <immintrin.h>
+#endif
+
 namespace souffle {
 
+template <typename Domain, std::size_t arity>
+struct Tuple;
+
 namespace detail {
 
 // ---------- comparators --------------
@@ -197,6 +205,146 @@ struct binary_search : public search_strategy {
     }
 };
 
+/**
+ * Determines whether the keys of a b-tree node can be compared by SIMD
+ * instructions: keys have to be arrays of up to four 32-bit integers, and
+ * the comparator has to name the column it compares first, as the
+ * comparators of index_utils do.
+ */
+template <typename Key, typename Comp, typename Iter, typename = void>
+struct simd_searchable : public std::false_type {};
+
+template <typename Key, typename Comp, typename Iter>
+struct simd_searchable<Key, Comp, Iter,
+        std::void_t<typename Key::value_type, decltype(Comp::first_column), decltype(Comp::num_columns)>>
+        : public std::integral_constant<bool,
+                  std::is_pointer<Iter>::value && std::is_integral<typename Key::value_type>::value &&
+                          std::is_signed<typename Key::value_type>::value &&
+                          sizeof(typename Key::value_type) == 4 && Key::arity <= 4 &&
+                          sizeof(Key) == Key::arity * sizeof(typename Key::value_type)> {};
+
+/**
+ * A search strategy for looking up keys in b-tree nodes comparing the
+ * column compared first of several keys at once by SIMD instructions.
+ * Keys agreeing with the searched key on this column are then located
+ * by a binary search among them. Keys or comparators not supporting
+ * this, see simd_searchable, are located by a binary search right away,
+ * as are all keys on platforms lacking SSE2.
+ */
+struct simd_search : public search_strategy {
+    /**
+     * Required user-defined default constructor.
+     */
+    simd_search() = default;
+
+    /**
+     * Obtains an iterator referencing an element equivalent to the
+     * given key in the given range. If no such element is present,
+     * a reference to the first element not less than the given key
+     * is returned.
+     */
+    template <typename Key, typename Iter, typename Comp>
+    inline Iter operator()(const Key& k, Iter a, Iter b, Comp& comp) const {
+        return lower_bound(k, a, b, comp);
+    }
+
+    /**
+     * Obtains a reference to the first element in the given range that
+     * is not less than the given key.
+     */
+    template <typename Key, typename Iter, typename Comp>
+    inline Iter lower_bound(const Key& k, Iter a, Iter b, Comp& comp) const {
+        using C = typename std::remove_const<Comp>::type;
+        if constexpr (simd_searchable<Key, C, Iter>::value) {
+            std::size_t less = 0;
+            std::size_t notGreater = 0;
+            count<Key::arity, C::first_column>(
+                    reinterpret_cast<const int32_t*>(a), b - a, k[C::first_column], less, notGreater);
+            if (C::num_columns == 1 || less == notGreater) {
+                return a + less;
+            }
+            return binary_search().lower_bound(k, a + less, a + notGreater, comp);
+        } else {
+            return binary_search().lower_bound(k, a, b, comp);
+        }
+    }
+
+    /**
+     * Obtains a reference to the first element in the given range that
+     * such that the given key is less than the referenced element.
+     */
+    template <typename Key, typename Iter, typename Comp>
+    inline Iter upper_bound(const Key& k, Iter a, Iter b, Comp& comp) const {
+        using C = typename std::remove_const<Comp>::type;
+        if constexpr (simd_searchable<Key, C, Iter>::value) {
+            std::size_t less = 0;
+            std::size_t notGreater = 0;
+            count<Key::arity, C::first_column>(
+                    reinterpret_cast<const int32_t*>(a), b - a, k[C::first_column], less, notGreater);
+            if (C::num_columns == 1 || less == notGreater) {
+                return a + notGreater;
+            }
+            return binary_search().upper_bound(k, a + less, a + notGreater, comp);
+        } else {
+            return binary_search().upper_bound(k, a, b, comp);
+        }
+    }
+
+private:
+    /**
+     * Counts the keys of a sorted sequence of n keys of the given arity
+     * whose given column is less than, and not greater than, the given
+     * value. Keys are visited in blocks until a key greater than the
+     * value is encountered.
+     */
+    template <std::size_t Arity, std::size_t Column>
+    static void count(const int32_t* keys, std::size_t n, int32_t value, std::size_t& less,
+            std::size_t& notGreater) {
+        const int32_t* col = keys + Column;
+        std::size_t i = 0;
+#ifdef __AVX2__
+        const __m256i v8 = _mm256_set1_epi32(value);
+        const __m256i stride = _mm256_setr_epi32(0, Arity, 2 * Arity, 3 * Arity, 4 * Arity, 5 * Arity,
+                6 * Arity, 7 * Arity);
+        for (; i + 8 <= n; i += 8) {
+            const __m256i x = (Arity == 1)
+                                      ? _mm256_loadu_si256(reinterpret_cast<const __m256i*>(col + i))
+                                      : _mm256_i32gather_epi32(col + i * Arity, stride, 4);
+            const int lt = _mm256_movemask_ps(_mm256_castsi256_ps(_mm256_cmpgt_epi32(v8, x)));
+            const int gt = _mm256_movemask_ps(_mm256_castsi256_ps(_mm256_cmpgt_epi32(x, v8)));
+            less += __builtin_popcountll(lt);
+            notGreater += __builtin_popcountll(~gt & 0xFF);
+            if (gt != 0) {
+                return;
+            }
+        }
+#endif
+#ifdef __SSE2__
+        const __m128i v4 = _mm_set1_epi32(value);
+        for (; i + 4 <= n; i += 4) {
+            const __m128i x = (Arity == 1) ? _mm_loadu_si128(reinterpret_cast<const __m128i*>(col + i))
+                                           : _mm_set_epi32(col[(i + 3) * Arity], col[(i + 2) * Arity],
+                                                     col[(i + 1) * Arity], col[i * Arity]);
+            const int lt = _mm_movemask_ps(_mm_castsi128_ps(_mm_cmpgt_epi32(v4, x)));
+            const int gt = _mm_movemask_ps(_mm_castsi128_ps(_mm_cmpgt_epi32(x, v4)));
+            less += __builtin_popcountll(lt);
+            notGreater += __builtin_popcountll(~gt & 0xF);
+            if (gt != 0) {
+                return;
+            }
+        }
+#endif
+        for (; i < n; ++i) {
+            const int32_t x = col[i * Arity];
+            if (x > value) {
+                return;
+            }
+            less += (x < value) ? 1 : 0;
+            ++notGreater;
+        }
+    }
+};
+
 // ---------- search strategies selection --------------
 
 /**
@@ -210,6 +358,7 @@ struct strategy_selection {
 
 struct linear : public strategy_selection<linear_search> {};
 struct binary : public strategy_selection<binary_search> {};
+struct simd : public strategy_selection<simd_search> {};
 
 // by default every key utilizes binary search
 template <typename Key>
@@ -221,6 +370,12 @@ struct default_strategy<int> : public linear {};
 template <typename... Ts>
 struct default_strategy<std::tuple<Ts...>> : public linear {};
 
+// narrow tuples of 32-bit integers are searched by SIMD instructions
+template <typename Domain, std::size_t arity>
+struct default_strategy<Tuple<Domain, arity>>
+        : public std::conditional<std::is_integral<Domain>::value && sizeof(Domain) == 4 && arity <= 4,
+                  simd, binary>::type {};
+
 /**
  * The default non-updater
  */
@@ -1244,6 +1399,9 @@ public:
     // the maximum number of keys stored per node
     static constexpr size_t max_keys_per_node = node::maxKeys;
 
+    // trees are rebuilt by bulk insertions of at least 1/MERGE_REBUILD_RATIO of their size
+    static constexpr size_type MERGE_REBUILD_RATIO = 2;
+
     // -- ctors / dtors --
 
     // the default constructor creating an empty tree
@@ -1692,6 +1850,74 @@ public:
         }
     }
 
+    /**
+     * Inserts all elements of the given tree into this tree.
+     */
+    void insertAll(const btree& other) {
+        if (this == &other || other.empty()) {
+            return;
+        }
+        insertAll(other.begin(), other.end());
+    }
+
+    /**
+     * Inserts the given range of elements, sorted in the order of this tree
+     * and -- for sets -- free of duplicates, into this tree. If the range is
+     * not much smaller than this tree, both sorted sequences are merged and
+     * the leaves of a new tree are built from the result sequentially, as by
+     * the bulk-load operation. Otherwise, the elements are inserted in order,
+     * such that the operation hints skip most of the descents. Not to be
+     * called concurrently with other operations on this tree.
+     */
+    template <typename Iter>
+    void insertAll(const Iter& a, const Iter& b) {
+        if (a == b) {
+            return;
+        }
+
+        // inserting into a large tree is cheaper than rebuilding it
+        const size_type count = std::distance(a, b);
+        const size_type present = size();
+        if (count * MERGE_REBUILD_RATIO < present) {
+            insert(a, b);
+            return;
+        }
+
+        // merge the elements of this tree and the given range
+        std::vector<Key> merged;
+        merged.reserve(present + count);
+        auto x = begin();
+        auto y = a;
+        while (x != end() && y != b) {
+            if (weak_less(*x, *y)) {
+                merged.push_back(*x);
+                ++x;
+            } else if (!isSet || weak_less(*y, *x)) {
+                merged.push_back(*y);
+                ++y;
+            } else {
+                // equal keys in sets - update provenance information
+                merged.push_back(*x);
+                if (typeid(Comparator) != typeid(WeakComparator) && less(*y, *x)) {
+                    update(merged.back(), *y);
+                }
+                ++x;
+                ++y;
+            }
+        }
+        merged.insert(merged.end(), x, end());
+        merged.insert(merged.end(), y, b);
+
+        // replace the content of this tree by a tree built bottom-up
+        clear();
+        root = buildSubTree(merged.begin(), merged.end() - 1);
+        node* first = root;
+        while (!first->isLeaf()) {
+            first = first->getChild(0);
+        }
+        leftmost = static_cast<leaf_node*>(first);
+    }
+
     // Obtains an iterator referencing the first element of the tree.
     iterator begin() const {
         return iterator(leftmost, 0);
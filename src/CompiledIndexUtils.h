@@ -20,6 +20,7 @@
 #include "CompiledTuple.h"
 #include "Util.h"
 #include <cassert>
+#include <functional>
 #include <iterator>
 #include <ostream>
 #include <string>
@@ -78,6 +79,10 @@ struct comparator;
 
 template <unsigned First, unsigned... Rest>
 struct comparator<First, Rest...> {
+    // the column compared first and the number of compared columns, utilized by SIMD searches
+    static constexpr std::size_t first_column = First;
+    static constexpr std::size_t num_columns = 1 + sizeof...(Rest);
+
     template <typename T>
     int operator()(const T& a, const T& b) const {
         return (a[First] < b[First]) ? -1 : ((a[First] > b[First]) ? 1 : comparator<Rest...>()(a, b));
@@ -108,6 +113,31 @@ struct comparator<> {
     }
 };
 
+// -------- generic tuple hasher ----------
+//   (hashes the given columns, the key of hash indices)
+
+template <unsigned... Columns>
+struct hasher;
+
+template <unsigned First, unsigned... Rest>
+struct hasher<First, Rest...> {
+    template <typename T>
+    std::size_t operator()(const T& a) const {
+        std::size_t res = hasher<Rest...>()(a);
+        // from boost hash combine
+        return res ^ (std::hash<typename std::decay<decltype(a[First])>::type>()(a[First]) + 0x9e3779b9 +
+                             (res << 6) + (res >> 2));
+    }
+};
+
+template <>
+struct hasher<> {
+    template <typename T>
+    std::size_t operator()(const T&) const {
+        return 0;
+    }
+};
+
 // ----- a comparator wrapper dereferencing pointers ----------
 //         (required for handling indirect indices)
 
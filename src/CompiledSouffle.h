@@ -20,17 +20,21 @@
 #include "souffle/CompiledIndexUtils.h"
 #include "souffle/CompiledTuple.h"
 #include "souffle/EquivalenceRelation.h"
+#include "souffle/HashSet.h"
 #include "souffle/IOSystem.h"
 #include "souffle/IterUtils.h"
 #include "souffle/ParallelUtils.h"
 #include "souffle/RWOperation.h"
 #include "souffle/RamTypes.h"
 #include "souffle/RecordTable.h"
+#include "souffle/RegexCache.h"
 #include "souffle/SignalHandler.h"
+#include "souffle/SortedArray.h"
 #include "souffle/SouffleInterface.h"
 #include "souffle/SymbolTable.h"
 #include "souffle/Table.h"
 #include "souffle/Util.h"
+#include "souffle/WorkStealing.h"
 #include "souffle/WriteStream.h"
 #ifndef __EMBEDDED_SOUFFLE__
 #include "souffle/CompiledOptions.h"
@@ -0,0 +1,532 @@
+/*
+ * Souffle - A Datalog Compiler
+ * Copyright (c) 2020, The Souffle Developers. All rights reserved
+ * Licensed under the Universal Permissive License v 1.0 as shown at:
+ * - https://opensource.org/licenses/UPL
+ * - <souffle root>/licenses/SOUFFLE-UPL.txt
+ */
+
+/************************************************************************
+ *
+ * @file DynBTree.h
+ *
+ * A B-tree set of tuples whose arity is fixed at construction time rather
+ * than at compile time. It serves the interpreter for relations wider than
+ * the arities the templated B-tree indexes are instantiated for.
+ *
+ * Tuples are stored inline with a fixed stride in the leaf nodes; inner
+ * nodes hold separators and child pointers only, and the leaves are linked
+ * for iteration. Inserts may not be conducted concurrently with each other
+ * or with read operations; read operations may run concurrently.
+ *
+ ***********************************************************************/
+
+#pragma once
+
+#include "RamTypes.h"
+#include "Util.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cstdint>
+#include <cstring>
+#include <iterator>
+#include <new>
+#include <utility>
+#include <vector>
+
+namespace souffle {
+
+/**
+ * A set of tuples of a construction-time arity, ordered lexicographically.
+ *
+ * Tuples are identified by their first keyArity components. If fewer
+ * components than the arity form the key, the remaining ones are a payload
+ * that an insert of a tuple with the same key replaces if the new tuple is
+ * lexicographically smaller. This mirrors the updater of provenance B-trees.
+ */
+class DynBTree {
+    /** The header of a node; the arrays of a node follow its header in the same allocation */
+    struct Node {
+        Node(bool inner) : inner(inner) {}
+
+        // whether this is an inner node
+        const bool inner;
+
+        // the number of tuples of a leaf, or of separators of an inner node
+        uint32_t numElements = 0;
+
+        // the next leaf in order, for leaves
+        Node* next = nullptr;
+    };
+
+    /** Target size of a node in bytes */
+    static constexpr std::size_t NODE_SIZE = 1024;
+
+    /** Minimal number of entries of a node, such that splits are well-defined */
+    static constexpr std::size_t MIN_CAPACITY = 4;
+
+public:
+    class iterator;
+    using chunk = range<iterator>;
+
+    /** The leaf accessed last by an operation, exploited by operations on nearby tuples */
+    struct operation_hints {
+        const Node* last = nullptr;
+    };
+
+    /**
+     * An iterator over tuples; dereferencing yields the address of the components
+     * of a tuple, valid until the next insert.
+     */
+    class iterator : public std::iterator<std::forward_iterator_tag, const RamDomain*> {
+        friend class DynBTree;
+
+        const DynBTree* tree = nullptr;
+        const Node* leaf = nullptr;
+        std::size_t pos = 0;
+
+        // moves on to the next leaf if the position is past the current one
+        iterator(const DynBTree* tree, const Node* leaf, std::size_t pos) : tree(tree), leaf(leaf), pos(pos) {
+            while (this->leaf != nullptr && this->pos >= this->leaf->numElements) {
+                this->leaf = this->leaf->next;
+                this->pos = 0;
+            }
+        }
+
+    public:
+        iterator() = default;
+
+        iterator& operator++() {
+            if (++pos >= leaf->numElements) {
+                leaf = leaf->next;
+                pos = 0;
+            }
+            return *this;
+        }
+
+        const RamDomain* operator*() const {
+            return tree->getTuple(leaf, pos);
+        }
+
+        bool operator==(const iterator& other) const {
+            return leaf == other.leaf && pos == other.pos;
+        }
+
+        bool operator!=(const iterator& other) const {
+            return !(*this == other);
+        }
+    };
+
+    DynBTree(std::size_t arity, std::size_t keyArity)
+            : arity(arity), keyArity(keyArity),
+              leafCapacity(std::max(MIN_CAPACITY, NODE_SIZE / (arity * sizeof(RamDomain)))),
+              innerCapacity(std::max(
+                      MIN_CAPACITY, NODE_SIZE / (keyArity * sizeof(RamDomain) + sizeof(Node*)))) {
+        assert(arity > 0 && keyArity > 0 && keyArity <= arity && "invalid key of tuples");
+    }
+
+    explicit DynBTree(std::size_t arity) : DynBTree(arity, arity) {}
+
+    DynBTree(const DynBTree&) = delete;
+    DynBTree& operator=(const DynBTree&) = delete;
+
+    ~DynBTree() {
+        clear();
+    }
+
+    std::size_t getArity() const {
+        return arity;
+    }
+
+    std::size_t size() const {
+        return numTuples;
+    }
+
+    bool empty() const {
+        return numTuples == 0;
+    }
+
+    /**
+     * Inserts a tuple; returns true if it was added or replaced the payload
+     * of a tuple with the same key.
+     */
+    bool insert(const RamDomain* tuple, operation_hints& hints) {
+        if (root == nullptr) {
+            root = leftmost = newNode(false);
+        }
+
+        // the last leaf accepts the tuple if it is in its bounds and has room for it
+        Node* cur = const_cast<Node*>(hints.last);
+        if (cur == nullptr || cur->numElements == leafCapacity || !covers(cur, tuple)) {
+            cur = findLeafForInsert(tuple);
+        }
+        hints.last = cur;
+
+        RamDomain* tuples = getTuples(cur);
+        std::size_t pos = lowerBound(tuples, cur->numElements, arity, tuple, keyArity);
+        RamDomain* hit = tuples + pos * arity;
+        if (pos < cur->numElements && compare(hit, tuple, keyArity) == 0) {
+            if (keyArity == arity || compare(tuple, hit, arity) >= 0) {
+                return false;
+            }
+            std::copy(tuple + keyArity, tuple + arity, hit + keyArity);
+            return true;
+        }
+        std::memmove(hit + arity, hit, (cur->numElements - pos) * arity * sizeof(RamDomain));
+        std::copy(tuple, tuple + arity, hit);
+        ++cur->numElements;
+        ++numTuples;
+        return true;
+    }
+
+    bool insert(const RamDomain* tuple) {
+        operation_hints hints;
+        return insert(tuple, hints);
+    }
+
+    /**
+     * Inserts sorted, duplicate-free tuples given in row-major order. An empty
+     * tree is built bottom-up from full leaves.
+     */
+    void insertSorted(const RamDomain* tuples, std::size_t count) {
+        if (!empty()) {
+            operation_hints hints;
+            for (std::size_t i = 0; i < count; ++i) {
+                insert(tuples + i * arity, hints);
+            }
+            return;
+        }
+        clear();
+        if (count == 0) {
+            return;
+        }
+
+        // the nodes of the current level and the smallest tuple of each of their subtrees
+        std::vector<Node*> level;
+        std::vector<const RamDomain*> mins;
+        Node* last = nullptr;
+        for (std::size_t i = 0; i < count; i += leafCapacity) {
+            Node* leaf = newNode(false);
+            leaf->numElements = static_cast<uint32_t>(std::min(leafCapacity, count - i));
+            std::copy(tuples + i * arity, tuples + (i + leaf->numElements) * arity, getTuples(leaf));
+            if (last != nullptr) {
+                last->next = leaf;
+            }
+            last = leaf;
+            level.push_back(leaf);
+            mins.push_back(getTuples(leaf));
+        }
+        leftmost = level.front();
+        numTuples = count;
+
+        while (level.size() > 1) {
+            std::vector<Node*> parents;
+            std::vector<const RamDomain*> parentMins;
+            for (std::size_t i = 0; i < level.size(); i += innerCapacity + 1) {
+                Node* node = newNode(true);
+                std::size_t numChildren = std::min(innerCapacity + 1, level.size() - i);
+                for (std::size_t j = 0; j < numChildren; ++j) {
+                    getChildren(node)[j] = level[i + j];
+                    if (j > 0) {
+                        std::copy(mins[i + j], mins[i + j] + keyArity, getSeparator(node, j - 1));
+                    }
+                }
+                node->numElements = static_cast<uint32_t>(numChildren - 1);
+                parents.push_back(node);
+                parentMins.push_back(mins[i]);
+            }
+            level.swap(parents);
+            mins.swap(parentMins);
+        }
+        root = level.front();
+    }
+
+    /** Determines whether the given tuple is an element of this set */
+    bool contains(const RamDomain* tuple, operation_hints& hints) const {
+        if (root == nullptr) {
+            return false;
+        }
+        const Node* cur = hints.last;
+        if (cur == nullptr || !covers(cur, tuple)) {
+            cur = findLeaf(tuple);
+        }
+        hints.last = cur;
+        const RamDomain* tuples = getTuples(cur);
+        std::size_t pos = lowerBound(tuples, cur->numElements, arity, tuple, keyArity);
+        return pos < cur->numElements && compare(tuples + pos * arity, tuple, arity) == 0;
+    }
+
+    bool contains(const RamDomain* tuple) const {
+        operation_hints hints;
+        return contains(tuple, hints);
+    }
+
+    /** Obtains the first tuple not less than the given one */
+    iterator lower_bound(const RamDomain* tuple, operation_hints& hints) const {
+        if (root == nullptr) {
+            return end();
+        }
+        const Node* cur = findLeaf(tuple);
+        hints.last = cur;
+        return iterator(this, cur, lowerBound(getTuples(cur), cur->numElements, arity, tuple, arity));
+    }
+
+    /** Obtains the first tuple greater than the given one */
+    iterator upper_bound(const RamDomain* tuple, operation_hints& hints) const {
+        if (root == nullptr) {
+            return end();
+        }
+        const Node* cur = findLeaf(tuple);
+        hints.last = cur;
+        return iterator(this, cur, upperBound(getTuples(cur), cur->numElements, arity, tuple, arity));
+    }
+
+    iterator begin() const {
+        return iterator(this, leftmost, 0);
+    }
+
+    iterator end() const {
+        return iterator();
+    }
+
+    /**
+     * Partitions the given range into up to the given number of chunks of
+     * approximately the same number of tuples, walking the leaves in between.
+     */
+    std::vector<chunk> getChunks(const iterator& a, const iterator& b, std::size_t num) const {
+        std::vector<chunk> res;
+        if (a == b) {
+            return res;
+        }
+        std::size_t total = 0;
+        for (const Node* cur = a.leaf; cur != b.leaf; cur = cur->next) {
+            total += cur->numElements;
+        }
+        total = total - a.pos + b.pos;
+
+        // cut the range every step tuples, at leaf granularity
+        const std::size_t step = std::max<std::size_t>(1, (total + num - 1) / std::max<std::size_t>(1, num));
+        iterator last = a;
+        std::size_t seen = a.leaf->numElements - a.pos;
+        for (const Node* cur = a.leaf; cur != b.leaf && cur->next != b.leaf; cur = cur->next) {
+            if (seen >= step * (res.size() + 1)) {
+                iterator next(this, cur->next, 0);
+                res.push_back({last, next});
+                last = next;
+            }
+            seen += cur->next->numElements;
+        }
+        res.push_back({last, b});
+        return res;
+    }
+
+    std::vector<chunk> getChunks(std::size_t num) const {
+        return getChunks(begin(), end(), num);
+    }
+
+    /** Removes all tuples */
+    void clear() {
+        if (root != nullptr) {
+            freeNode(root);
+        }
+        root = leftmost = nullptr;
+        numTuples = 0;
+    }
+
+    void swap(DynBTree& other) {
+        assert(arity == other.arity && keyArity == other.keyArity && "swapping trees of different arity");
+        std::swap(root, other.root);
+        std::swap(leftmost, other.leftmost);
+        std::swap(numTuples, other.numTuples);
+    }
+
+private:
+    /** Lexicographically compares the first n components of two tuples */
+    static int compare(const RamDomain* a, const RamDomain* b, std::size_t n) {
+        for (std::size_t i = 0; i < n; ++i) {
+            if (a[i] != b[i]) {
+                return a[i] < b[i] ? -1 : 1;
+            }
+        }
+        return 0;
+    }
+
+    /** The first position of count entries of the given stride not less than a tuple on n components */
+    static std::size_t lowerBound(const RamDomain* entries, std::size_t count, std::size_t stride,
+            const RamDomain* tuple, std::size_t n) {
+        std::size_t a = 0;
+        std::size_t b = count;
+        while (a < b) {
+            std::size_t m = (a + b) / 2;
+            if (compare(entries + m * stride, tuple, n) < 0) {
+                a = m + 1;
+            } else {
+                b = m;
+            }
+        }
+        return a;
+    }
+
+    /** The first position of count entries of the given stride greater than a tuple on n components */
+    static std::size_t upperBound(const RamDomain* entries, std::size_t count, std::size_t stride,
+            const RamDomain* tuple, std::size_t n) {
+        std::size_t a = 0;
+        std::size_t b = count;
+        while (a < b) {
+            std::size_t m = (a + b) / 2;
+            if (compare(entries + m * stride, tuple, n) <= 0) {
+                a = m + 1;
+            } else {
+                b = m;
+            }
+        }
+        return a;
+    }
+
+    // -- node layout --
+    //   leaf:  header | tuples [leafCapacity * arity]
+    //   inner: header | children [innerCapacity + 1] | separators [innerCapacity * keyArity]
+
+    Node* newNode(bool inner) const {
+        std::size_t bytes = sizeof(Node) + (inner ? (innerCapacity + 1) * sizeof(Node*) +
+                                                            innerCapacity * keyArity * sizeof(RamDomain)
+                                                  : leafCapacity * arity * sizeof(RamDomain));
+        return new (::operator new(bytes)) Node(inner);
+    }
+
+    void freeNode(Node* node) {
+        if (node->inner) {
+            for (std::size_t i = 0; i <= node->numElements; ++i) {
+                freeNode(getChildren(node)[i]);
+            }
+        }
+        node->~Node();
+        ::operator delete(node);
+    }
+
+    static Node** getChildren(Node* node) {
+        return reinterpret_cast<Node**>(node + 1);
+    }
+
+    static Node* const* getChildren(const Node* node) {
+        return reinterpret_cast<Node* const*>(node + 1);
+    }
+
+    RamDomain* getSeparator(Node* node, std::size_t i) const {
+        return reinterpret_cast<RamDomain*>(getChildren(node) + innerCapacity + 1) + i * keyArity;
+    }
+
+    const RamDomain* getSeparator(const Node* node, std::size_t i) const {
+        return reinterpret_cast<const RamDomain*>(getChildren(node) + innerCapacity + 1) + i * keyArity;
+    }
+
+    static RamDomain* getTuples(Node* leaf) {
+        return reinterpret_cast<RamDomain*>(leaf + 1);
+    }
+
+    static const RamDomain* getTuples(const Node* leaf) {
+        return reinterpret_cast<const RamDomain*>(leaf + 1);
+    }
+
+    const RamDomain* getTuple(const Node* leaf, std::size_t pos) const {
+        return getTuples(leaf) + pos * arity;
+    }
+
+    /** Determines whether the key of the given tuple lies within the first and last tuple of a leaf */
+    bool covers(const Node* leaf, const RamDomain* tuple) const {
+        return leaf->numElements > 0 && compare(getTuple(leaf, 0), tuple, keyArity) <= 0 &&
+               compare(tuple, getTuple(leaf, leaf->numElements - 1), keyArity) <= 0;
+    }
+
+    /** The child of an inner node whose subtree holds the key of the given tuple */
+    std::size_t findChild(const Node* node, const RamDomain* tuple) const {
+        return upperBound(getSeparator(node, 0), node->numElements, keyArity, tuple, keyArity);
+    }
+
+    /** Locates the leaf of the key of the given tuple */
+    const Node* findLeaf(const RamDomain* tuple) const {
+        const Node* cur = root;
+        while (cur->inner) {
+            cur = getChildren(cur)[findChild(cur, tuple)];
+        }
+        return cur;
+    }
+
+    /**
+     * Locates the leaf of the key of the given tuple for an insert, splitting
+     * the full nodes on the way such that the leaf has room for the tuple.
+     */
+    Node* findLeafForInsert(const RamDomain* tuple) {
+        if (isFull(root)) {
+            Node* node = newNode(true);
+            getChildren(node)[0] = root;
+            root = node;
+            split(root, 0);
+        }
+        Node* cur = root;
+        while (cur->inner) {
+            std::size_t idx = findChild(cur, tuple);
+            if (isFull(getChildren(cur)[idx])) {
+                split(cur, idx);
+                idx = findChild(cur, tuple);
+            }
+            cur = getChildren(cur)[idx];
+        }
+        return cur;
+    }
+
+    bool isFull(const Node* node) const {
+        return node->numElements == (node->inner ? innerCapacity : leafCapacity);
+    }
+
+    /** Splits the full child at the given position of a non-full inner node */
+    void split(Node* parent, std::size_t idx) {
+        Node* left = getChildren(parent)[idx];
+        Node* right = newNode(left->inner);
+
+        // the separator of the two halves, written to the parent
+        const RamDomain* separator;
+        if (!left->inner) {
+            std::size_t mid = left->numElements / 2;
+            right->numElements = left->numElements - mid;
+            left->numElements = mid;
+            std::copy(getTuple(left, mid), getTuple(left, mid + right->numElements), getTuples(right));
+            right->next = left->next;
+            left->next = right;
+            separator = getTuples(right);
+        } else {
+            // the middle separator moves up, the others are divided
+            std::size_t mid = left->numElements / 2;
+            right->numElements = left->numElements - mid - 1;
+            left->numElements = mid;
+            std::copy(getSeparator(left, mid + 1), getSeparator(left, mid + 1 + right->numElements),
+                    getSeparator(right, 0));
+            std::copy(getChildren(left) + mid + 1, getChildren(left) + mid + 2 + right->numElements,
+                    getChildren(right));
+            separator = getSeparator(left, mid);
+        }
+
+        const std::size_t n = parent->numElements;
+        std::copy_backward(getSeparator(parent, idx), getSeparator(parent, n), getSeparator(parent, n + 1));
+        std::copy_backward(getChildren(parent) + idx + 1, getChildren(parent) + n + 1,
+                getChildren(parent) + n + 2);
+        std::copy(separator, separator + keyArity, getSeparator(parent, idx));
+        getChildren(parent)[idx + 1] = right;
+        ++parent->numElements;
+    }
+
+    // the number of components of tuples, and of their key
+    const std::size_t arity;
+    const std::size_t keyArity;
+
+    // the maximal number of tuples of a leaf and of separators of an inner node
+    const std::size_t leafCapacity;
+    const std::size_t innerCapacity;
+
+    Node* root = nullptr;
+    Node* leftmost = nullptr;
+    std::size_t numTuples = 0;
+};
+
+}  // end of namespace souffle
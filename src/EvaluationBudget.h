@@ -0,0 +1,197 @@
+/*
+ * Souffle - A Datalog Compiler
+ * Copyright (c) 2020, The Souffle Developers. All rights reserved.
+ * Licensed under the Universal Permissive License v 1.0 as shown at:
+ * - https://opensource.org/licenses/UPL
+ * - <souffle root>/licenses/SOUFFLE-UPL.txt
+ */
+
+/************************************************************************
+ *
+ * @file EvaluationBudget.h
+ *
+ * Limits on the wall-clock time, the number of derived tuples and the
+ * resident memory of one evaluation of a program. Used by the interpreter
+ * and the synthesised code. The memory limit is process-wide: it is checked
+ * against the resident memory of the whole process.
+ *
+ * The evaluation polls the budget at query boundaries, at the iterations
+ * of fixpoint loops and, in the interpreter, every CHECK_INTERVAL tuples of
+ * a scan. Once a limit is exceeded the budget stays exhausted: the remaining
+ * queries are skipped and loops stop, so that the evaluation ends early with
+ * the relations computed so far.
+ *
+ ***********************************************************************/
+
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <fstream>
+#include <unistd.h>
+
+namespace souffle {
+
+/**
+ * @class EvaluationBudget
+ * @brief Limits of one evaluation; a limit of zero is no limit
+ */
+class EvaluationBudget {
+    using clock = std::chrono::steady_clock;
+
+public:
+    /** Outcome of an evaluation */
+    enum class Status { Complete, TimeLimit, TupleLimit, MemoryLimit };
+
+    /** Number of tuples a scan visits between two checks of the budget */
+    static constexpr std::size_t CHECK_INTERVAL = 4096;
+
+    /** Minimal time between two reads of the resident memory, which costs a system call */
+    static constexpr std::chrono::milliseconds MEMORY_CHECK_INTERVAL{10};
+
+    /** @brief Set the limit on the wall-clock time of an evaluation */
+    void setTimeLimit(std::chrono::milliseconds limit) {
+        timeLimit = limit;
+    }
+
+    /** @brief Set the limit on the number of tuples derived by an evaluation */
+    void setTupleLimit(std::size_t limit) {
+        tupleLimit = limit;
+    }
+
+    /**
+     * @brief Set the limit on the resident memory, in bytes. The resident memory is the one of the
+     * whole process; evaluations running at the same time share it, hence one evaluation may
+     * exhaust the budget of the others.
+     */
+    void setMemoryLimit(std::size_t limit) {
+        memoryLimit = limit;
+    }
+
+    /** @brief Take over the limits of another budget */
+    void setLimits(const EvaluationBudget& other) {
+        timeLimit = other.timeLimit;
+        tupleLimit = other.tupleLimit;
+        memoryLimit = other.memoryLimit;
+    }
+
+    /** @brief Check whether the resident memory is limited */
+    bool hasMemoryLimit() const {
+        return memoryLimit != 0;
+    }
+
+    /** @brief Check whether any limit is set */
+    bool isLimited() const {
+        return timeLimit.count() != 0 || tupleLimit != 0 || memoryLimit != 0;
+    }
+
+    /** @brief Start an evaluation, restoring the full budget */
+    void start() {
+        startTime = clock::now();
+        lastMemoryCheck.store(0, std::memory_order_relaxed);
+        tuples.store(0, std::memory_order_relaxed);
+        status.store(Status::Complete, std::memory_order_relaxed);
+        running.store(true, std::memory_order_relaxed);
+    }
+
+    /** @brief End an evaluation; later checks, e.g., by subroutines, keep its status */
+    void finish() {
+        running.store(false, std::memory_order_relaxed);
+    }
+
+    /** @brief Account for tuples derived by the evaluation */
+    void addTuples(std::size_t count) {
+        tuples.fetch_add(count, std::memory_order_relaxed);
+    }
+
+    /** @brief Return the number of tuples accounted for */
+    std::size_t getTuples() const {
+        return tuples.load(std::memory_order_relaxed);
+    }
+
+    /** @brief Check the limits; return true if the budget is exhausted */
+    bool check() {
+        if (isExhausted() || !running.load(std::memory_order_relaxed)) {
+            return isExhausted();
+        }
+        if (tupleLimit != 0 && getTuples() > tupleLimit) {
+            return exhaust(Status::TupleLimit);
+        }
+        if (timeLimit.count() != 0 && clock::now() - startTime > timeLimit) {
+            return exhaust(Status::TimeLimit);
+        }
+        if (memoryLimit != 0 && isMemoryCheckDue() && getResidentMemory() > memoryLimit) {
+            return exhaust(Status::MemoryLimit);
+        }
+        return false;
+    }
+
+    /** @brief Check whether a limit was exceeded, without checking the limits again */
+    bool isExhausted() const {
+        return getStatus() != Status::Complete;
+    }
+
+    /** @brief Return the outcome of the evaluation so far */
+    Status getStatus() const {
+        return status.load(std::memory_order_relaxed);
+    }
+
+    /** @brief Return a description of an outcome */
+    static const char* getStatusText(Status status) {
+        switch (status) {
+            case Status::Complete:
+                return "complete";
+            case Status::TimeLimit:
+                return "time limit exceeded";
+            case Status::TupleLimit:
+                return "tuple limit exceeded";
+            case Status::MemoryLimit:
+                return "memory limit exceeded";
+        }
+        return "unknown";
+    }
+
+    /** @brief Return the resident memory of the process in bytes, or 0 if it cannot be determined */
+    static std::size_t getResidentMemory() {
+        std::ifstream statm("/proc/self/statm");
+        std::size_t size = 0;
+        std::size_t resident = 0;
+        if (!(statm >> size >> resident)) {
+            return 0;
+        }
+        return resident * static_cast<std::size_t>(sysconf(_SC_PAGESIZE));
+    }
+
+private:
+    /** @brief Check whether the resident memory is to be read again, claiming the read for the caller */
+    bool isMemoryCheckDue() {
+        auto now = std::chrono::duration_cast<std::chrono::milliseconds>(clock::now() - startTime).count();
+        auto last = lastMemoryCheck.load(std::memory_order_relaxed);
+        return (last == 0 || now - last >= MEMORY_CHECK_INTERVAL.count()) &&
+               lastMemoryCheck.compare_exchange_strong(last, now + 1, std::memory_order_relaxed);
+    }
+
+    bool exhaust(Status reason) {
+        Status expected = Status::Complete;
+        status.compare_exchange_strong(expected, reason, std::memory_order_relaxed);
+        return true;
+    }
+
+    std::chrono::milliseconds timeLimit{0};
+    std::size_t tupleLimit = 0;
+    std::size_t memoryLimit = 0;
+
+    /** Start of the current evaluation */
+    clock::time_point startTime = clock::now();
+    /** Time of the last read of the resident memory since the start plus one, in milliseconds, or 0 */
+    std::atomic<std::chrono::milliseconds::rep> lastMemoryCheck{0};
+    /** Tuples derived by the current evaluation */
+    std::atomic<std::size_t> tuples{0};
+    /** Whether an evaluation is in progress */
+    std::atomic<bool> running{false};
+    /** First limit exceeded by the current evaluation */
+    std::atomic<Status> status{Status::Complete};
+};
+
+}  // namespace souffle
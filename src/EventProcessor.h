@@ -537,6 +537,23 @@ public:
 
 } relationReadsProcessor;
 
+/**
+ * Parallel busy time processor
+ */
+const class ParallelBusyTimeProcessor : public EventProcessor {
+public:
+    ParallelBusyTimeProcessor() {
+        EventProcessorSingleton::instance().registerEventProcessor("@parallel-busy", this);
+    }
+    /** process event input */
+    void process(ProfileDatabase& db, const std::vector<std::string>& signature, va_list& args) override {
+        const std::string& thread = signature[1];
+        size_t busyTime = va_arg(args, size_t);
+        db.addSizeEntry({"program", "thread", thread, "busy-time"}, busyTime);
+    }
+
+} parallelBusyTimeProcessor;
+
 /**
  * Config entry processor
  */
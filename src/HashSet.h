@@ -0,0 +1,403 @@
+/*
+ * Souffle - A Datalog Compiler
+ * Copyright (c) 2020, The Souffle Developers. All rights reserved
+ * Licensed under the Universal Permissive License v 1.0 as shown at:
+ * - https://opensource.org/licenses/UPL
+ * - <souffle root>/licenses/SOUFFLE-UPL.txt
+ */
+
+/************************************************************************
+ *
+ * @file HashSet.h
+ *
+ * A concurrent open-addressing hash set whose elements are located by a
+ * key, i.e., by some of their components. Elements sharing a key can be
+ * enumerated in constant expected time, which makes the set an index for
+ * searches binding exactly the key components. There is no order on the
+ * elements, so the set can not answer range queries.
+ *
+ ***********************************************************************/
+
+#pragma once
+
+#include "ParallelUtils.h"
+#include "Util.h"
+
+#include <atomic>
+#include <cassert>
+#include <cstdint>
+#include <iterator>
+#include <memory>
+#include <utility>
+#include <vector>
+
+namespace souffle {
+
+/**
+ * A set of elements hashed by their key, the components of an element
+ * considered by KeyHash and KeyEqual. Distinct elements may share a key.
+ *
+ * Elements are stored inline in a table of slots using linear probing. The
+ * table is never filled beyond half of its slots. Insertions are safe to
+ * conduct concurrently with each other and with lookups. A full table is
+ * replaced by one twice its size; the replaced tables are retained until the
+ * set is cleared, such that iterators and concurrent lookups remain valid.
+ *
+ * @tparam Key the type of the stored elements
+ * @tparam KeyHash a functor hashing the key of an element
+ * @tparam KeyEqual a functor comparing the keys of two elements by equal(a,b)
+ */
+template <typename Key, typename KeyHash, typename KeyEqual>
+class hash_set {
+public:
+    using element_type = Key;
+    using size_type = std::size_t;
+
+    /** Hash sets do not exploit access patterns; provided for interface compatibility with B-trees */
+    struct operation_hints {};
+
+    class iterator;
+    using chunk = range<iterator>;
+
+private:
+    /** The state of a slot; a slot is busy while an element is written to it */
+    enum SlotState : uint8_t { EMPTY, BUSY, FULL };
+
+    struct Slot {
+        std::atomic<uint8_t> state{EMPTY};
+        Key element;
+    };
+
+    struct Table {
+        Table(size_type capacity) : capacity(capacity), slots(std::make_unique<Slot[]>(capacity)) {}
+
+        // the number of slots, a power of two
+        const size_type capacity;
+
+        std::unique_ptr<Slot[]> slots;
+    };
+
+    /** The number of slots of the table of an empty set */
+    static constexpr size_type INITIAL_CAPACITY = 8;
+
+    /** Position of iterators past the last element */
+    static constexpr size_type END = ~size_type(0);
+
+public:
+    /**
+     * An iterator over the elements of a set, either all elements or
+     * the elements sharing a key.
+     */
+    class iterator : public std::iterator<std::forward_iterator_tag, Key> {
+        friend class hash_set;
+
+        // the set and the table traversed
+        const hash_set* set = nullptr;
+        const Table* table = nullptr;
+
+        // the slot of the current element
+        size_type pos = END;
+
+        // whether only elements sharing the key of the probe element are visited
+        bool probing = false;
+        Key probe;
+
+        iterator(const hash_set* set, const Table* table, size_type pos, bool probing, const Key& probe)
+                : set(set), table(table), pos(pos), probing(probing), probe(probe) {
+            seek();
+        }
+
+        // moves forward to the next element to be visited, starting at the current slot
+        void seek() {
+            if (pos == END) {
+                return;
+            }
+            if (!probing) {
+                while (pos < table->capacity &&
+                        table->slots[pos].state.load(std::memory_order_acquire) != FULL) {
+                    ++pos;
+                }
+                if (pos == table->capacity) {
+                    pos = END;
+                }
+                return;
+            }
+            // an empty slot ends the probe sequence; busy slots are not inserted yet
+            const size_type mask = table->capacity - 1;
+            while (true) {
+                const Slot& slot = table->slots[pos];
+                const uint8_t state = slot.state.load(std::memory_order_acquire);
+                if (state == EMPTY) {
+                    pos = END;
+                    return;
+                }
+                if (state == FULL && set->equal.equal(slot.element, probe)) {
+                    return;
+                }
+                pos = (pos + 1) & mask;
+            }
+        }
+
+    public:
+        iterator() = default;
+
+        iterator& operator++() {
+            assert(pos != END && "incrementing end iterator");
+            pos = probing ? (pos + 1) & (table->capacity - 1) : pos + 1;
+            seek();
+            return *this;
+        }
+
+        const Key& operator*() const {
+            return table->slots[pos].element;
+        }
+
+        const Key* operator->() const {
+            return &table->slots[pos].element;
+        }
+
+        bool operator==(const iterator& other) const {
+            return pos == other.pos && (pos == END || table == other.table);
+        }
+
+        bool operator!=(const iterator& other) const {
+            return !(*this == other);
+        }
+    };
+
+    hash_set(KeyHash hash = KeyHash(), KeyEqual equal = KeyEqual())
+            : hash(std::move(hash)), equal(std::move(equal)) {
+        clear();
+    }
+
+    hash_set(const hash_set&) = delete;
+    hash_set& operator=(const hash_set&) = delete;
+
+    /** Obtains the number of elements of this set */
+    size_type size() const {
+        return count.load(std::memory_order_relaxed);
+    }
+
+    /** Determines whether this set is empty */
+    bool empty() const {
+        return size() == 0;
+    }
+
+    /** Inserts the given element; returns false if it is present already */
+    bool insert(const Key& k) {
+        operation_hints hints;
+        return insert(k, hints);
+    }
+
+    /** Inserts the given element; returns false if it is present already */
+    bool insert(const Key& k, operation_hints&) {
+        const size_type h = mix(hash(k));
+
+        // the element is counted before it is placed, such that concurrent
+        // insertions can not fill the table beyond half of its slots
+        lock.start_read();
+        size_type n = count.fetch_add(1, std::memory_order_relaxed) + 1;
+        while (2 * n > current()->capacity) {
+            count.fetch_sub(1, std::memory_order_relaxed);
+            lock.end_read();
+            grow(n);
+            lock.start_read();
+            n = count.fetch_add(1, std::memory_order_relaxed) + 1;
+        }
+
+        Table& t = *current();
+        const size_type mask = t.capacity - 1;
+        bool inserted = false;
+        for (size_type pos = h & mask;; pos = (pos + 1) & mask) {
+            Slot& slot = t.slots[pos];
+            uint8_t state = EMPTY;
+            if (slot.state.compare_exchange_strong(state, BUSY, std::memory_order_acquire)) {
+                slot.element = k;
+                slot.state.store(FULL, std::memory_order_release);
+                inserted = true;
+                break;
+            }
+            // another thread may be writing an equal element to this slot
+            while (state == BUSY) {
+                state = slot.state.load(std::memory_order_acquire);
+            }
+            if (slot.element == k) {
+                count.fetch_sub(1, std::memory_order_relaxed);
+                break;
+            }
+        }
+        lock.end_read();
+        return inserted;
+    }
+
+    /** Inserts all elements of the given range */
+    template <typename Iter>
+    void insert(const Iter& a, const Iter& b) {
+        operation_hints hints;
+        for (auto cur = a; cur != b; ++cur) {
+            insert(*cur, hints);
+        }
+    }
+
+    /** Makes room for the given number of elements without growing the table again */
+    void reserve(size_type n) {
+        if (2 * n > current()->capacity) {
+            grow(n);
+        }
+    }
+
+    /** Determines whether the given element is a member of this set */
+    bool contains(const Key& k) const {
+        operation_hints hints;
+        return contains(k, hints);
+    }
+
+    /** Determines whether the given element is a member of this set */
+    bool contains(const Key& k, operation_hints& hints) const {
+        return find(k, hints) != end();
+    }
+
+    /**
+     * Locates the given element; if found, the returned iterator continues
+     * with the other elements sharing its key. Otherwise, an end-iterator is returned.
+     */
+    iterator find(const Key& k) const {
+        operation_hints hints;
+        return find(k, hints);
+    }
+
+    /**
+     * Locates the given element; if found, the returned iterator continues
+     * with the other elements sharing its key. Otherwise, an end-iterator is returned.
+     */
+    iterator find(const Key& k, operation_hints& hints) const {
+        for (auto it = equal_range(k, hints).begin(); it != end(); ++it) {
+            if (*it == k) {
+                return it;
+            }
+        }
+        return end();
+    }
+
+    /** Obtains the elements sharing the key of the given element */
+    range<iterator> equal_range(const Key& k) const {
+        operation_hints hints;
+        return equal_range(k, hints);
+    }
+
+    /** Obtains the elements sharing the key of the given element */
+    range<iterator> equal_range(const Key& k, operation_hints&) const {
+        const Table* t = current();
+        return {iterator(this, t, mix(hash(k)) & (t->capacity - 1), true, k), end()};
+    }
+
+    iterator begin() const {
+        return iterator(this, current(), 0, false, Key());
+    }
+
+    iterator end() const {
+        return iterator();
+    }
+
+    /**
+     * Partitions this set into up to the given number of chunks covering
+     * approximately the same number of slots.
+     */
+    std::vector<chunk> getChunks(size_type num) const {
+        std::vector<chunk> res;
+        const Table* t = current();
+        num = std::max<size_type>(1, std::min(num, t->capacity));
+        iterator last = iterator(this, t, 0, false, Key());
+        for (size_type i = 1; i <= num && last != end(); ++i) {
+            iterator next = i == num ? end() : iterator(this, t, i * t->capacity / num, false, Key());
+            if (last != next) {
+                res.push_back({last, next});
+            }
+            last = next;
+        }
+        return res;
+    }
+
+    std::vector<chunk> partition(size_type num) const {
+        return getChunks(num);
+    }
+
+    /** Removes all elements; not to be called concurrently with other operations */
+    void clear() {
+        tables.clear();
+        tables.push_back(std::make_unique<Table>(INITIAL_CAPACITY));
+        table.store(tables.back().get(), std::memory_order_release);
+        count.store(0, std::memory_order_relaxed);
+    }
+
+    /** Obtains the number of slots of the current table */
+    size_type capacity() const {
+        return current()->capacity;
+    }
+
+private:
+    const Table* current() const {
+        return table.load(std::memory_order_acquire);
+    }
+
+    Table* current() {
+        return table.load(std::memory_order_acquire);
+    }
+
+    /** Scrambles the bits of a hash value, such that the low bits select well-distributed slots */
+    static size_type mix(size_type h) {
+        uint64_t x = h;
+        x ^= x >> 33;
+        x *= 0xff51afd7ed558ccdULL;
+        x ^= x >> 33;
+        x *= 0xc4ceb9fe1a85ec53ULL;
+        x ^= x >> 33;
+        return static_cast<size_type>(x);
+    }
+
+    /** Replaces the table by one large enough for the given number of elements */
+    void grow(size_type n) {
+        lock.start_write();
+        const Table* old = current();
+        if (2 * n > old->capacity) {
+            size_type capacity = old->capacity;
+            while (2 * n > capacity) {
+                capacity *= 2;
+            }
+            auto next = std::make_unique<Table>(capacity);
+            const size_type mask = capacity - 1;
+            for (size_type i = 0; i < old->capacity; ++i) {
+                const Slot& slot = old->slots[i];
+                if (slot.state.load(std::memory_order_relaxed) != FULL) {
+                    continue;
+                }
+                size_type pos = mix(hash(slot.element)) & mask;
+                while (next->slots[pos].state.load(std::memory_order_relaxed) != EMPTY) {
+                    pos = (pos + 1) & mask;
+                }
+                next->slots[pos].element = slot.element;
+                next->slots[pos].state.store(FULL, std::memory_order_relaxed);
+            }
+            table.store(next.get(), std::memory_order_release);
+            tables.push_back(std::move(next));
+        }
+        lock.end_write();
+    }
+
+    KeyHash hash;
+    KeyEqual equal;
+
+    // the table holding the elements
+    std::atomic<Table*> table{nullptr};
+
+    // the current table and all tables it replaced
+    std::vector<std::unique_ptr<Table>> tables;
+
+    // the number of elements
+    std::atomic<size_type> count{0};
+
+    // inserting threads share this lock, growing the table requires it exclusively
+    ReadWriteLock lock;
+};
+
+}  // end of namespace souffle
@@ -16,12 +16,16 @@
 
 #pragma once
 
+#include "InterpreterEnvironment.h"
 #include "InterpreterIndex.h"
+#include "InterpreterInsertBuffer.h"
 #include "InterpreterRelation.h"
 #include "RamIndexAnalysis.h"
 #include "RamNode.h"
 #include "RamTypes.h"
+#include <algorithm>
 #include <cassert>
+#include <cstddef>
 #include <memory>
 #include <unordered_map>
 #include <vector>
@@ -34,44 +38,107 @@ namespace souffle {
 class InterpreterContext {
     using ViewPtr = std::unique_ptr<IndexView>;
 
+    /** Number of values of the first block of scratch tuples; later blocks double in size */
+    static constexpr size_t ARENA_BLOCK_SIZE = 1024;
+
     /** @brief Run-time value */
     std::vector<const RamDomain*> data;
     /** @brief Subroutine return value */
     std::vector<RamDomain>* returnValues = nullptr;
     /** @brief Subroutine arguments */
     const std::vector<RamDomain>* args = nullptr;
-    /** @bref Allocated data */
-    std::vector<std::unique_ptr<RamDomain[]>> allocatedDataContainer;
+    /** @brief Blocks of the arena for scratch tuples; they are kept when the arena is reset */
+    std::vector<std::unique_ptr<RamDomain[]>> arenaBlocks;
+    /** @brief Sizes of the blocks of the arena */
+    std::vector<size_t> arenaSizes;
+    /** @brief Block of the arena tuples are allocated from */
+    size_t arenaBlock = 0;
+    /** @brief Values of the current block in use */
+    size_t arenaUsed = 0;
     /** @brief Views */
     std::vector<std::unique_ptr<IndexView>> views;
+    /** @brief Environment holding the relations of the evaluation */
+    InterpreterEnvironment* env = nullptr;
+    /** @brief Buffer collecting the projected tuples, if inserts are deferred */
+    InterpreterInsertBuffer* insertBuffer = nullptr;
+    /** @brief Budget of the evaluation, or nullptr if the evaluation is not limited */
+    EvaluationBudget* budget = nullptr;
+    /** @brief Tuples visited by scans since the last check of the budget */
+    size_t budgetSteps = 0;
+    /** @brief Tuples derived but not yet accounted for in the budget */
+    size_t pendingTuples = 0;
+    /** @brief Contexts of the threads of parallel regions, reused from one region to the next */
+    std::vector<std::unique_ptr<InterpreterContext>> threadContexts;
 
 public:
-    InterpreterContext(size_t size = 0) : data(size) {}
+    /** Create a context with the given number of tuple slots and views, as counted by the generator */
+    InterpreterContext(size_t numTuples = 0, size_t numViews = 0) : data(numTuples), views(numViews) {}
 
     /** This constructor is used when program enter a new scope.
-     * Only Subroutine value needs to be copied */
-    InterpreterContext(InterpreterContext& ctxt) : returnValues(ctxt.returnValues), args(ctxt.args) {}
+     * Only Subroutine value and environment need to be copied */
+    InterpreterContext(InterpreterContext& ctxt)
+            : data(ctxt.data.size()), returnValues(ctxt.returnValues), args(ctxt.args),
+              views(ctxt.views.size()), env(ctxt.env), budget(ctxt.budget) {}
     virtual ~InterpreterContext() = default;
 
     const RamDomain*& operator[](size_t index) {
-        if (index >= data.size()) {
-            data.resize((index + 1));
-        }
+        assert(index < data.size() && "tuple id out of range");
         return data[index];
     }
 
     const RamDomain* const& operator[](size_t index) const {
+        assert(index < data.size() && "tuple id out of range");
         return data[index];
     }
 
-    /** @brief Allocate a tuple.
-     *  allocatedDataContainer has the ownership of those tuples. */
+    /** @brief Allocate a scratch tuple, which lives until the arena is reset */
     RamDomain* allocateNewTuple(size_t size) {
-        std::unique_ptr<RamDomain[]> newTuple(new RamDomain[size]);
-        allocatedDataContainer.push_back(std::move(newTuple));
+        while (arenaBlock < arenaBlocks.size() && arenaUsed + size > arenaSizes[arenaBlock]) {
+            ++arenaBlock;
+            arenaUsed = 0;
+        }
+        if (arenaBlock == arenaBlocks.size()) {
+            size_t blockSize = std::max(size, arenaSizes.empty() ? ARENA_BLOCK_SIZE : 2 * arenaSizes.back());
+            arenaBlocks.emplace_back(new RamDomain[blockSize]);
+            arenaSizes.push_back(blockSize);
+        }
+        RamDomain* tuple = arenaBlocks[arenaBlock].get() + arenaUsed;
+        arenaUsed += size;
+        return tuple;
+    }
+
+    /** @brief Release all scratch tuples at once, keeping the memory of the arena for later ones */
+    void resetArena() {
+        arenaBlock = 0;
+        arenaUsed = 0;
+    }
+
+    /** @brief Make sure that the given number of threads can take their contexts concurrently */
+    void reserveThreadContexts(size_t numThreads) {
+        if (threadContexts.size() < numThreads) {
+            threadContexts.resize(numThreads);
+        }
+    }
 
-        // Return the reference as raw pointer.
-        return allocatedDataContainer.back().get();
+    /**
+     * @brief Return the context of a thread of a parallel region, in the scope of this context.
+     * Contexts are pooled, so that their tuple slots, views and arena outlive the region.
+     * The views of the nested operations have to be created again.
+     */
+    InterpreterContext& getThreadContext(size_t thread) {
+        assert(thread < threadContexts.size() && "thread contexts not reserved");
+        std::unique_ptr<InterpreterContext>& context = threadContexts[thread];
+        if (context == nullptr) {
+            context = std::make_unique<InterpreterContext>(*this);
+        }
+        context->flushTuples();
+        context->returnValues = returnValues;
+        context->args = args;
+        context->env = env;
+        context->budget = budget;
+        context->insertBuffer = nullptr;
+        context->resetArena();
+        return *context;
     }
 
     /** @brief Get subroutine return value */
@@ -106,6 +173,73 @@ public:
         return (*args)[i];
     }
 
+    /** @brief Get the environment of the evaluation */
+    InterpreterEnvironment& getEnvironment() const {
+        assert(env != nullptr && "no environment set");
+        return *env;
+    }
+
+    /** @brief Set the environment of the evaluation */
+    void setEnvironment(InterpreterEnvironment& e) {
+        env = &e;
+    }
+
+    /** @brief Get the buffer for projected tuples, or nullptr if they are inserted directly */
+    InterpreterInsertBuffer* getInsertBuffer() const {
+        return insertBuffer;
+    }
+
+    /** @brief Defer the inserts of projected tuples to the given buffer */
+    void setInsertBuffer(InterpreterInsertBuffer* buffer) {
+        insertBuffer = buffer;
+    }
+
+    /** @brief Set the budget of the evaluation; nullptr if the evaluation is not limited */
+    void setBudget(EvaluationBudget* b) {
+        budget = b;
+    }
+
+    /** @brief Check whether the evaluation is limited by a budget */
+    bool hasBudget() const {
+        return budget != nullptr;
+    }
+
+    /** @brief Check whether the budget of the evaluation is exhausted, checking the limits */
+    bool isBudgetExhausted() {
+        if (budget == nullptr) {
+            return false;
+        }
+        flushTuples();
+        return budget->check();
+    }
+
+    /**
+     * @brief Count tuples visited by a scan; return false once the budget is exhausted.
+     * The budget is only checked every CHECK_INTERVAL tuples.
+     */
+    bool tick(size_t count = 1) {
+        if (budget == nullptr || (budgetSteps += count) < EvaluationBudget::CHECK_INTERVAL) {
+            return true;
+        }
+        budgetSteps = 0;
+        return !isBudgetExhausted();
+    }
+
+    /** @brief Count derived tuples; they are accounted for in the budget at its next check */
+    void countTuple(size_t count = 1) {
+        if (budget != nullptr) {
+            pendingTuples += count;
+        }
+    }
+
+    /** @brief Account for the derived tuples in the budget */
+    void flushTuples() {
+        if (pendingTuples != 0) {
+            budget->addTuples(pendingTuples);
+            pendingTuples = 0;
+        }
+    }
+
     /** @brief Create a view in the environment */
     void createView(const InterpreterRelation& rel, size_t indexPos, size_t viewPos) {
         ViewPtr view;
@@ -21,10 +21,14 @@
 #include "RamTypes.h"
 #include "RecordTable.h"
 #include "SignalHandler.h"
+#include <algorithm>
+#include <atomic>
 #include <cassert>
+#include <chrono>
 #include <csignal>
+#include <exception>
+#include <numeric>
 #include <regex>
-#include <ffi.h>
 
 namespace souffle {
 
@@ -35,43 +39,21 @@ namespace souffle {
 #define dynamicLibSuffix ".so";
 #endif
 
-// Aliases for foreign function interface.
-#if RAM_DOMAIN_SIZE == 64
-#define FFI_RamSigned ffi_type_sint64
-#define FFI_RamUnsigned ffi_type_uint64
-#define FFI_RamFloat ffi_type_double
-#else
-#define FFI_RamSigned ffi_type_sint32
-#define FFI_RamUnsigned ffi_type_uint32
-#define FFI_RamFloat ffi_type_float
+// GCC and Clang support labels as values, which the engine uses for threaded dispatch
+#if (defined(__GNUC__) || defined(__clang__)) && !defined(SOUFFLE_NO_COMPUTED_GOTO)
+#define SOUFFLE_COMPUTED_GOTO
 #endif
 
-#define FFI_Symbol ffi_type_pointer
-
 namespace {
 constexpr RamDomain RAM_BIT_SHIFT_MASK = RAM_DOMAIN_SIZE - 1;
 }
 
-InterpreterEngine::RelationHandle& InterpreterEngine::getRelationHandle(const size_t idx) {
-    return generator.getRelationHandle(idx);
-}
-
-void InterpreterEngine::swapRelation(const size_t ramRel1, const size_t ramRel2) {
-    RelationHandle& rel1 = getRelationHandle(ramRel1);
-    RelationHandle& rel2 = getRelationHandle(ramRel2);
-    std::swap(rel1, rel2);
-}
-
-int InterpreterEngine::incCounter() {
-    return counter++;
-}
-
 SymbolTable& InterpreterEngine::getSymbolTable() {
     return tUnit.getSymbolTable();
 }
 
 RecordTable& InterpreterEngine::getRecordTable() {
-    return recordTable;
+    return mainEnv.getRecordTable();
 }
 
 RamTranslationUnit& InterpreterEngine::getTranslationUnit() {
@@ -90,7 +72,7 @@ void* InterpreterEngine::getMethodHandle(const std::string& method) {
 }
 
 std::vector<std::unique_ptr<InterpreterEngine::RelationHandle>>& InterpreterEngine::getRelationMap() {
-    return generator.getRelations();
+    return mainEnv.getRelationMap();
 }
 
 const std::vector<void*>& InterpreterEngine::loadDLL() {
@@ -98,19 +80,18 @@ const std::vector<void*>& InterpreterEngine::loadDLL() {
         return dll;
     }
 
-    if (!Global::config().has("libraries")) {
-        Global::config().set("libraries", "functors");
-    }
-    if (!Global::config().has("library-dir")) {
-        Global::config().set("library-dir", ".");
-    }
+    // the configuration is shared with concurrent evaluations; it is not updated with the defaults
+    const std::string libraries =
+            Global::config().has("libraries") ? Global::config().get("libraries") : "functors";
+    const std::string libraryDirs =
+            Global::config().has("library-dir") ? Global::config().get("library-dir") : ".";
 
-    for (const std::string& library : splitString(Global::config().get("libraries"), ' ')) {
+    for (const std::string& library : splitString(libraries, ' ')) {
         // The library may be blank
         if (library.empty()) {
             continue;
         }
-        auto paths = splitString(Global::config().get("library-dir"), ' ');
+        auto paths = splitString(libraryDirs, ' ');
         // Set up our paths to have a library appended
         for (std::string& path : paths) {
             if (path.back() != '/') {
@@ -138,18 +119,64 @@ const std::vector<void*>& InterpreterEngine::loadDLL() {
     return dll;
 }
 
-size_t InterpreterEngine::getIterationNumber() const {
-    return iteration;
+const std::map<std::string, std::vector<std::string>>& InterpreterEngine::get_execute_result() {
+    return mainEnv.getResult();
+}
+
+void InterpreterEngine::generateMain() {
+    std::lock_guard<std::mutex> guard(generatorLock);
+    if (mainProgram == nullptr) {
+        mainProgram = generator.generateTree(tUnit.getProgram().getMain());
+        // Subroutines are generated up-front as well, so that the set of relations is complete
+        // before any evaluation starts and calls of subroutines only read the generated trees.
+        for (const auto& sub : tUnit.getProgram().getSubroutines()) {
+            subroutines[sub.first] = generator.generateTree(*sub.second);
+        }
+    }
 }
-void InterpreterEngine::incIterationNumber() {
-    ++iteration;
+
+void InterpreterEngine::reset() {
+    mainEnv.reset();
 }
-void InterpreterEngine::resetIterationNumber() {
-    iteration = 0;
+
+InterpreterRelation* InterpreterEngine::getRelation(const std::string& name) {
+    return mainEnv.getRelation(name);
 }
 
-std::map<std::string, std::vector<std::string>> InterpreterEngine::get_execute_result(){
-    return execute_result;
+void InterpreterEngine::setInputLoaded(const std::string& name) {
+    mainEnv.setInputLoaded(name);
+}
+
+std::vector<std::string> InterpreterEngine::getOutputRelationNames() const {
+    std::vector<std::string> names;
+    visitDepthFirst(tUnit.getProgram().getMain(), [&](const RamIO& io) {
+        const std::string& op = io.get("operation");
+        if (op == "output" || op == "printsize") {
+            names.push_back(io.getRelation().getName());
+        }
+    });
+    return names;
+}
+
+std::vector<std::vector<RamDomain>> InterpreterEngine::getColumns(const std::string& name) {
+    return getColumns(mainEnv, name);
+}
+
+std::vector<std::vector<RamDomain>> InterpreterEngine::getColumns(
+        InterpreterEnvironment& env, const std::string& name) {
+    InterpreterRelation* rel = env.getRelation(name);
+    assert(rel != nullptr && "unknown relation");
+    const size_t arity = rel->getArity();
+    std::vector<std::vector<RamDomain>> columns(arity);
+    for (auto& column : columns) {
+        column.reserve(rel->size());
+    }
+    for (const auto& tuple : rel->scan()) {
+        for (size_t i = 0; i < arity; ++i) {
+            columns[i].push_back(tuple[i]);
+        }
+    }
+    return columns;
 }
 
 void InterpreterEngine::executeMain() {
@@ -161,24 +188,17 @@ void InterpreterEngine::executeMain() {
     
     std::cout << "Execute main: 2" << std::endl;
     RamStatement& program = tUnit.getProgram().getMain();
-    auto entry = generator.generateTree(program);
-    InterpreterContext ctxt;
+    generateMain();
     std::cout << "Execute main: 3" << std::endl;
 
     if (!profileEnabled) {
         std::cout << "Start Execute no Profiling" << std::endl;
-        InterpreterContext ctxt;
-        execute(entry.get(), ctxt);
+        executeMain(mainEnv);
         std::cout << "Finish Execute no Profiling" << std::endl;
     } else {
         ProfileEventSingleton::instance().setOutputFile(Global::config().get("profile"));
-        // Prepare the frequency table for threaded use
-        visitDepthFirst(program, [&](const RamTupleOperation& node) {
-            if (!node.getProfileText().empty()) {
-                frequencies.emplace(node.getProfileText(), std::deque<std::atomic<size_t>>());
-                frequencies[node.getProfileText()].emplace_back(0);
-            }
-        });
+        // Counters of each thread; the counters were assigned when the trees were generated
+        profile.reset(MAX_THREADS);
         // Enable profiling for execution of main
         ProfileEventSingleton::instance().startTimer();
         ProfileEventSingleton::instance().makeTimeEvent("@time;starttime");
@@ -191,7 +211,6 @@ void InterpreterEngine::executeMain() {
         for (auto rel : tUnit.getProgram().getRelations()) {
             if (rel->getName()[0] != '@') {
                 ++relationCount;
-                reads[rel->getName()] = 0;
             }
         }
         ProfileEventSingleton::instance().makeConfigRecord("relationCount", std::to_string(relationCount));
@@ -201,50 +220,132 @@ void InterpreterEngine::executeMain() {
         visitDepthFirst(program, [&](const RamQuery&) { ++ruleCount; });
         ProfileEventSingleton::instance().makeConfigRecord("ruleCount", std::to_string(ruleCount));
 
-        InterpreterContext ctxt;
-        execute(entry.get(), ctxt);
+        executeMain(mainEnv);
         ProfileEventSingleton::instance().stopTimer();
-        for (auto const& cur : frequencies) {
-            for (size_t i = 0; i < cur.second.size(); ++i) {
-                ProfileEventSingleton::instance().makeQuantityEvent(cur.first, cur.second[i], i);
+        for (size_t counter = 0; counter < profile.getNumCounters(); ++counter) {
+            const std::vector<size_t> counts = profile.getCounts(counter);
+            for (size_t i = 0; i < counts.size(); ++i) {
+                ProfileEventSingleton::instance().makeQuantityEvent(profile.getText(counter), counts[i], i);
             }
         }
-        for (auto const& cur : reads) {
-            ProfileEventSingleton::instance().makeQuantityEvent(
-                    "@relation-reads;" + cur.first, cur.second, 0);
+        // relations which are never read are reported as well
+        for (auto rel : tUnit.getProgram().getRelations()) {
+            const std::string text = "@relation-reads;" + rel->getName();
+            if (rel->getName()[0] != '@' && !profile.hasCounter(text)) {
+                ProfileEventSingleton::instance().makeQuantityEvent(text, 0, 0);
+            }
         }
+        ProfileEventSingleton::instance().makeBusyTimeEvents();
     }
     std::cout << "reset handler" << std::endl;
     SignalHandler::instance()->reset();
     std::cout << "Done reset handler" << std::endl;
 
 }
+
+void InterpreterEngine::executeMain(InterpreterEnvironment& env) {
+    InterpreterContext ctxt(generator.getNumTupleSlots(), generator.getNumViews());
+    ctxt.setEnvironment(env);
+    EvaluationBudget& budget = env.getBudget();
+    budget.start();
+    if (budget.isLimited()) {
+        ctxt.setBudget(&budget);
+    }
+    execute(mainProgram.get(), ctxt);
+    budget.finish();
+}
+
+std::unique_ptr<InterpreterEnvironment> InterpreterEngine::createEnvironment() {
+    generateMain();
+    auto env = std::make_unique<InterpreterEnvironment>(generator.createRelations());
+    env->getBudget().setLimits(mainEnv.getBudget());
+    return env;
+}
+
+void InterpreterEngine::executeBatch(const std::vector<InterpreterEnvironment*>& envs) {
+    generateMain();
+    SignalHandler::instance()->set();
+    // exceptions must not leave a parallel region; they are rethrown once the batch is done
+    std::vector<std::exception_ptr> errors(envs.size());
+    if (profileEnabled) {
+        // profile counters are shared among environments
+        for (InterpreterEnvironment* env : envs) {
+            executeMain(*env);
+        }
+    } else {
+        // Threads are distributed over the environments rather than over the tuples of
+        // a single evaluation. Parallel operations nested in an environment run on one thread;
+        // each thread restores its thread count for nested regions once the batch is done.
+        PARALLEL_START
+#ifdef _OPENMP
+            const int previousThreads = omp_get_max_threads();
+            omp_set_num_threads(1);
+#endif
+            pfor(size_t i = 0; i < envs.size(); ++i) {
+                try {
+                    executeMain(*envs[i]);
+                } catch (...) {
+                    errors[i] = std::current_exception();
+                }
+            }
+#ifdef _OPENMP
+            omp_set_num_threads(previousThreads);
+#endif
+        PARALLEL_END
+    }
+    SignalHandler::instance()->reset();
+    for (const std::exception_ptr& error : errors) {
+        if (error != nullptr) {
+            std::rethrow_exception(error);
+        }
+    }
+}
+
 void InterpreterEngine::executeSubroutine(
         const std::string& name, const std::vector<RamDomain>& args, std::vector<RamDomain>& ret) {
-    InterpreterContext ctxt;
+    generateMain();
+    InterpreterContext ctxt(generator.getNumTupleSlots(), generator.getNumViews());
+    ctxt.setEnvironment(mainEnv);
     ctxt.setReturnValues(ret);
     ctxt.setArguments(args);
 
-    auto entry = generator.generateTree(tUnit.getProgram().getSubroutine(name));
-    execute(entry.get(), ctxt);
+    execute(subroutines.at(name).get(), ctxt);
 }
 
 RamDomain InterpreterEngine::execute(const InterpreterNode* node, InterpreterContext& ctxt) {
 #define DEBUG(Kind) std::cout << "Running Node: " << #Kind << "\n";
 
-#define CASE(Kind)     \
-    case (I_##Kind): { \
+// With labels-as-values every node kind has its own label, and the dispatch is an
+// indirect jump through a table indexed by the node type instead of a bounds-checked switch.
+// Only the dispatch changes; the node tree is still evaluated recursively.
+#ifdef SOUFFLE_COMPUTED_GOTO
+#define CASE_LABEL(Kind) L_##Kind:
+#else
+#define CASE_LABEL(Kind) case (I_##Kind):
+#endif
+
+#define CASE(Kind)       \
+    CASE_LABEL(Kind) {   \
         return [&]() -> RamDomain { \
             const auto& cur = *static_cast<const Ram##Kind*>(node->getShadow());
 #define CASE_NO_CAST(Kind) \
-    case (I_##Kind): {     \
+    CASE_LABEL(Kind) {     \
         return [&]() -> RamDomain {
 #define ESAC(Kind) \
     }              \
     ();            \
     }
 
+#ifdef SOUFFLE_COMPUTED_GOTO
+#define LABEL_ADDRESS(Kind) &&L_##Kind,
+    static const void* const dispatch[] = {FOR_EACH_INTERPRETER_NODE(LABEL_ADDRESS)};
+#undef LABEL_ADDRESS
+    assert(static_cast<size_t>(node->getType()) < sizeof(dispatch) / sizeof(dispatch[0]));
+    goto* dispatch[node->getType()];
+    {
+#else
     switch (node->getType()) {
+#endif
         CASE(Constant)
             return cur.getConstant();
         ESAC(Constant)
@@ -254,7 +355,7 @@ RamDomain InterpreterEngine::execute(const InterpreterNode* node, InterpreterCon
         ESAC(TupleElement)
 
         CASE_NO_CAST(AutoIncrement)
-            return incCounter();
+            return ctxt.getEnvironment().incCounter();
         ESAC(AutoIncrement)
 
         CASE(IntrinsicOperator)
@@ -306,7 +407,8 @@ RamDomain InterpreterEngine::execute(const InterpreterNode* node, InterpreterCon
     case FunctorOp::F##opCode: MINMAX_OP(RamFloat   , op)
             // clang-format on
 
-            const auto& args = cur.getArguments();
+            // the arguments are the children of the node; the RAM node would copy them on each call
+            const auto& args = node->getChildren();
             switch (cur.getOperator()) {
                 /** Unary Functor Operators */
                 case FunctorOp::ORD:
@@ -489,15 +591,30 @@ RamDomain InterpreterEngine::execute(const InterpreterNode* node, InterpreterCon
             const std::string& name = cur.getName();
             const std::vector<TypeAttribute>& type = cur.getArgsTypes();
 
-            auto fn = reinterpret_cast<void (*)()>(getMethodHandle(name));
+            // the symbol and the call interface are resolved by the generator
+            InterpreterFunctor& functor = *node->getFunctor();
+            auto fn = reinterpret_cast<void (*)()>(functor.getHandle());
             if (fn == nullptr) {
                 std::cerr << "Cannot find user-defined operator " << name << std::endl;
                 exit(1);
             }
+            size_t arity = node->getChildren().size();
+
+            // Functors on numbers are called without libffi
+            if (functor.isDirect()) {
+                RamDomain argVals[InterpreterFunctor::MAX_DIRECT_ARITY];
+                for (size_t i = 0; i < arity; i++) {
+                    argVals[i] = execute(node->getChild(i), ctxt);
+                }
+                return functor.callDirect(argVals);
+            }
+            if (!functor.isPrepared()) {
+                std::cerr << "Failed to prepare CIF for user-defined operator ";
+                std::cerr << name << std::endl;
+                exit(1);
+            }
+
             // prepare dynamic call environment
-            size_t arity = cur.getArguments().size();
-            ffi_cif cif;
-            ffi_type* args[arity];
             void* values[arity];
             RamDomain intVal[arity];
             RamUnsigned uintVal[arity];
@@ -510,22 +627,18 @@ RamDomain InterpreterEngine::execute(const InterpreterNode* node, InterpreterCon
                 RamDomain arg = execute(node->getChild(i), ctxt);
                 switch (type[i]) {
                     case TypeAttribute::Symbol:
-                        args[i] = &FFI_Symbol;
                         strVal[i] = getSymbolTable().resolve(arg).c_str();
                         values[i] = &strVal[i];
                         break;
                     case TypeAttribute::Signed:
-                        args[i] = &FFI_RamSigned;
                         intVal[i] = arg;
                         values[i] = &intVal[i];
                         break;
                     case TypeAttribute::Unsigned:
-                        args[i] = &FFI_RamUnsigned;
                         uintVal[i] = ramBitCast<RamUnsigned>(arg);
                         values[i] = &uintVal[i];
                         break;
                     case TypeAttribute::Float:
-                        args[i] = &FFI_RamFloat;
                         floatVal[i] = ramBitCast<RamFloat>(arg);
                         values[i] = &floatVal[i];
                         break;
@@ -534,33 +647,8 @@ RamDomain InterpreterEngine::execute(const InterpreterNode* node, InterpreterCon
                 }
             }
 
-            // Get codomain.
-            auto codomain = &FFI_RamSigned;
-            switch (cur.getReturnType()) {
-                // initialize for string value.
-                case TypeAttribute::Symbol:
-                    codomain = &FFI_Symbol;
-                    break;
-                case TypeAttribute::Signed:
-                    codomain = &FFI_RamSigned;
-                    break;
-                case TypeAttribute::Unsigned:
-                    codomain = &FFI_RamUnsigned;
-                    break;
-                case TypeAttribute::Float:
-                    codomain = &FFI_RamFloat;
-                    break;
-                default:
-                    assert(false && "Not implemented");
-            }
-
             // Call the external function.
-            if (ffi_prep_cif(&cif, FFI_DEFAULT_ABI, arity, codomain, args) != FFI_OK) {
-                std::cerr << "Failed to prepare CIF for user-defined operator ";
-                std::cerr << name << std::endl;
-                exit(1);
-            }
-            ffi_call(&cif, fn, &rc, values);
+            ffi_call(functor.getCif(), fn, &rc, values);
 
             RamDomain result;
             switch (cur.getReturnType()) {
@@ -583,14 +671,13 @@ RamDomain InterpreterEngine::execute(const InterpreterNode* node, InterpreterCon
             return result;
         ESAC(UserDefinedOperator)
 
-        CASE(PackRecord)
-            auto values = cur.getArguments();
-            size_t arity = values.size();
+        CASE_NO_CAST(PackRecord)
+            size_t arity = node->getChildren().size();
             RamDomain data[arity];
             for (size_t i = 0; i < arity; ++i) {
                 data[i] = execute(node->getChild(i), ctxt);
             }
-            return getRecordTable().pack(data, arity);
+            return ctxt.getEnvironment().getRecordTable().pack(data, arity);
         ESAC(PackRecord)
 
         CASE(SubroutineArgument)
@@ -614,7 +701,7 @@ RamDomain InterpreterEngine::execute(const InterpreterNode* node, InterpreterCon
         ESAC(Negation)
 
         CASE_NO_CAST(EmptinessCheck)
-            return node->getRelation()->empty();
+            return getRelation(node, ctxt)->empty();
         ESAC(EmptinessCheck)
 
         CASE(ExistenceCheck)
@@ -623,8 +710,8 @@ RamDomain InterpreterEngine::execute(const InterpreterNode* node, InterpreterCon
 
             size_t viewPos = node->getData(0);
 
-            if (profileEnabled && !cur.getRelation().isTemp()) {
-                reads[cur.getRelation().getName()]++;
+            if (profileEnabled && node->getData(1) != InterpreterProfile::NO_COUNTER) {
+                profile.inc(node->getData(1), 0);
             }
             // for total we use the exists test
             if (isa->isTotalSignature(&cur)) {
@@ -693,31 +780,31 @@ RamDomain InterpreterEngine::execute(const InterpreterNode* node, InterpreterCon
                 COMPARE(GT, >)
                 COMPARE(GE, >=)
 
-                case BinaryConstraintOp::MATCH: {
-                    RamDomain left = execute(node->getChild(0), ctxt);
-                    RamDomain right = execute(node->getChild(1), ctxt);
-                    const std::string& pattern = getSymbolTable().resolve(left);
-                    const std::string& text = getSymbolTable().resolve(right);
-                    bool result = false;
-                    try {
-                        result = std::regex_match(text, std::regex(pattern));
-                    } catch (...) {
-                        std::cerr << "warning: wrong pattern provided for match(\"" << pattern << "\",\""
-                                  << text << "\").\n";
-                    }
-                    return result;
-                }
+                case BinaryConstraintOp::MATCH:
                 case BinaryConstraintOp::NOT_MATCH: {
+                    const bool negated = cur.getOperator() == BinaryConstraintOp::NOT_MATCH;
                     RamDomain left = execute(node->getChild(0), ctxt);
                     RamDomain right = execute(node->getChild(1), ctxt);
-                    const std::string& pattern = getSymbolTable().resolve(left);
                     const std::string& text = getSymbolTable().resolve(right);
+                    const std::regex* regex = node->getRegex().get();
+                    RegexCache::RegexPtr dynamicRegex;
+                    if (regex == nullptr) {
+                        dynamicRegex = regexCache.get(left, getSymbolTable());
+                        regex = dynamicRegex.get();
+                    }
+                    bool valid = regex != nullptr;
                     bool result = false;
-                    try {
-                        result = !std::regex_match(text, std::regex(pattern));
-                    } catch (...) {
-                        std::cerr << "warning: wrong pattern provided for !match(\"" << pattern << "\",\""
-                                  << text << "\").\n";
+                    if (valid) {
+                        try {
+                            result = std::regex_match(text, *regex) != negated;
+                        } catch (...) {
+                            valid = false;
+                        }
+                    }
+                    if (!valid) {
+                        std::cerr << "warning: wrong pattern provided for " << (negated ? "!" : "")
+                                  << "match(\"" << getSymbolTable().resolve(left) << "\",\"" << text
+                                  << "\").\n";
                     }
                     return result;
                 }
@@ -747,27 +834,29 @@ RamDomain InterpreterEngine::execute(const InterpreterNode* node, InterpreterCon
 #undef COMPARE_EQ_NE
         ESAC(Constraint)
 
-        CASE(TupleOperation)
+        CASE_NO_CAST(TupleOperation)
             bool result = execute(node->getChild(0), ctxt);
 
-            if (profileEnabled && !cur.getProfileText().empty()) {
-                auto& currentFrequencies = frequencies[cur.getProfileText()];
-                while (currentFrequencies.size() <= getIterationNumber()) {
-                    currentFrequencies.emplace_back(0);
-                }
-                frequencies[cur.getProfileText()][getIterationNumber()]++;
+            if (profileEnabled && node->getData(0) != InterpreterProfile::NO_COUNTER) {
+                profile.inc(node->getData(0), ctxt.getEnvironment().getIterationNumber());
             }
             return result;
         ESAC(TupleOperation)
 
         CASE(Scan)
             // get the targeted relation
-            auto& rel = *node->getRelation();
+            auto& rel = *getRelation(node, ctxt);
+
+            if (const InterpreterNode* filter = getBatchedFilter(node->getChild(0))) {
+                Stream stream = rel.scan();
+                executeBatched(filter, cur.getTupleId(), stream, ctxt);
+                return true;
+            }
 
             // use simple iterator
             for (const RamDomain* tuple : rel) {
                 ctxt[cur.getTupleId()] = tuple;
-                if (!execute(node->getChild(0), ctxt)) {
+                if (!ctxt.tick() || !execute(node->getChild(0), ctxt)) {
                     break;
                 }
             }
@@ -776,26 +865,43 @@ RamDomain InterpreterEngine::execute(const InterpreterNode* node, InterpreterCon
 
         CASE(ParallelScan)
             auto preamble = node->getPreamble();
-            auto& rel = *node->getRelation();
+            auto& rel = *getRelation(node, ctxt);
 
-            auto pStream = rel.partitionScan(numOfThreads);
+            auto pStream = rel.partitionScan(getPartitionCount(rel.size(), MAX_THREADS));
 
+            std::vector<InterpreterInsertBuffer> insertBuffers;
+            WorkStealingLoop loop(pStream.size());
+            ctxt.reserveThreadContexts(MAX_THREADS);
             PARALLEL_START
                 ;
-                InterpreterContext newCtxt(ctxt);
-                auto viewInfo = preamble->getViewInfoForNested();
+                InterpreterContext& newCtxt = ctxt.getThreadContext(THREAD_NUM);
+                InterpreterInsertBuffer insertBuffer;
+                if (useInsertBuffers) {
+                    newCtxt.setInsertBuffer(&insertBuffer);
+                }
+                const auto& viewInfo = preamble->getViewInfoForNested();
                 for (const auto& info : viewInfo) {
-                    newCtxt.createView(*getRelationHandle(info[0]), info[1], info[2]);
+                    newCtxt.createView(*ctxt.getEnvironment().getRelationHandle(info[0]), info[1], info[2]);
                 }
-                pfor(auto it = pStream.begin(); it < pStream.end(); it++) {
-                    for (const TupleRef& val : *it) {
+                const InterpreterNode* filter = getBatchedFilter(node->getChild(0));
+                size_t partition;
+                while (!newCtxt.isBudgetExhausted() && loop.next(partition)) {
+                    if (filter != nullptr) {
+                        executeBatched(filter, cur.getTupleId(), pStream[partition], newCtxt);
+                        continue;
+                    }
+                    for (const TupleRef& val : pStream[partition]) {
                         newCtxt[cur.getTupleId()] = val.getBase();
-                        if (!execute(node->getChild(0), newCtxt)) {
+                        if (!newCtxt.tick() || !execute(node->getChild(0), newCtxt)) {
                             break;
                         }
                     }
                 }
+                newCtxt.flushTuples();
+                InterpreterInsertBuffer::collect(insertBuffer, insertBuffers);
             PARALLEL_END;
+            InterpreterInsertBuffer::flush(insertBuffers, ctxt.getEnvironment());
+            reportBusyTime(loop);
             return true;
         ESAC(ParallelScan)
 
@@ -817,9 +923,14 @@ RamDomain InterpreterEngine::execute(const InterpreterNode* node, InterpreterCon
             size_t viewId = node->getData(0);
             auto& view = ctxt.getView(viewId);
             // conduct range query
-            for (auto data : view->range(TupleRef(low, arity), TupleRef(hig, arity))) {
+            Stream stream = view->range(TupleRef(low, arity), TupleRef(hig, arity));
+            if (const InterpreterNode* filter = getBatchedFilter(node->getChild(arity))) {
+                executeBatched(filter, cur.getTupleId(), stream, ctxt);
+                return true;
+            }
+            for (auto data : stream) {
                 ctxt[cur.getTupleId()] = &data[0];
-                if (!execute(node->getChild(arity), ctxt)) {
+                if (!ctxt.tick() || !execute(node->getChild(arity), ctxt)) {
                     break;
                 }
             }
@@ -828,7 +939,7 @@ RamDomain InterpreterEngine::execute(const InterpreterNode* node, InterpreterCon
 
         CASE(ParallelIndexScan)
             auto preamble = node->getPreamble();
-            auto& rel = *node->getRelation();
+            auto& rel = *getRelation(node, ctxt);
 
             // create pattern tuple for range query
             size_t arity = rel.getArity();
@@ -845,32 +956,49 @@ RamDomain InterpreterEngine::execute(const InterpreterNode* node, InterpreterCon
             }
 
             size_t indexPos = node->getData(0);
-            auto pStream =
-                    rel.partitionRange(indexPos, TupleRef(low, arity), TupleRef(hig, arity), numOfThreads);
+            auto pStream = rel.partitionRange(indexPos, TupleRef(low, arity), TupleRef(hig, arity),
+                    MAX_THREADS * PARTITIONS_PER_THREAD);
 
+            std::vector<InterpreterInsertBuffer> insertBuffers;
+            WorkStealingLoop loop(pStream.size());
+            ctxt.reserveThreadContexts(MAX_THREADS);
             PARALLEL_START
                 ;
-                InterpreterContext newCtxt(ctxt);
-                auto viewInfo = preamble->getViewInfoForNested();
+                InterpreterContext& newCtxt = ctxt.getThreadContext(THREAD_NUM);
+                InterpreterInsertBuffer insertBuffer;
+                if (useInsertBuffers) {
+                    newCtxt.setInsertBuffer(&insertBuffer);
+                }
+                const auto& viewInfo = preamble->getViewInfoForNested();
                 for (const auto& info : viewInfo) {
-                    newCtxt.createView(*getRelationHandle(info[0]), info[1], info[2]);
+                    newCtxt.createView(*ctxt.getEnvironment().getRelationHandle(info[0]), info[1], info[2]);
                 }
-                pfor(auto it = pStream.begin(); it < pStream.end(); it++) {
-                    for (const TupleRef& val : *it) {
+                const InterpreterNode* filter = getBatchedFilter(node->getChild(arity));
+                size_t partition;
+                while (!newCtxt.isBudgetExhausted() && loop.next(partition)) {
+                    if (filter != nullptr) {
+                        executeBatched(filter, cur.getTupleId(), pStream[partition], newCtxt);
+                        continue;
+                    }
+                    for (const TupleRef& val : pStream[partition]) {
                         newCtxt[cur.getTupleId()] = val.getBase();
-                        if (!execute(node->getChild(arity), newCtxt)) {
+                        if (!newCtxt.tick() || !execute(node->getChild(arity), newCtxt)) {
                             break;
                         }
                     }
                 }
+                newCtxt.flushTuples();
+                InterpreterInsertBuffer::collect(insertBuffer, insertBuffers);
             PARALLEL_END;
+            InterpreterInsertBuffer::flush(insertBuffers, ctxt.getEnvironment());
+            reportBusyTime(loop);
 
             return true;
         ESAC(ParallelIndexScan)
 
         CASE(Choice)
             // get the targeted relation
-            auto& rel = *node->getRelation();
+            auto& rel = *getRelation(node, ctxt);
 
             // use simple iterator
             for (const RamDomain* tuple : rel) {
@@ -885,18 +1013,26 @@ RamDomain InterpreterEngine::execute(const InterpreterNode* node, InterpreterCon
 
         CASE(ParallelChoice)
             auto preamble = node->getPreamble();
-            auto& rel = *node->getRelation();
+            auto& rel = *getRelation(node, ctxt);
 
-            auto pStream = rel.partitionScan(numOfThreads);
-            auto viewInfo = preamble->getViewInfoForNested();
+            auto pStream = rel.partitionScan(getPartitionCount(rel.size(), MAX_THREADS));
+            const auto& viewInfo = preamble->getViewInfoForNested();
+            std::vector<InterpreterInsertBuffer> insertBuffers;
+            WorkStealingLoop loop(pStream.size());
+            ctxt.reserveThreadContexts(MAX_THREADS);
             PARALLEL_START
                 ;
-                InterpreterContext newCtxt(ctxt);
+                InterpreterContext& newCtxt = ctxt.getThreadContext(THREAD_NUM);
+                InterpreterInsertBuffer insertBuffer;
+                if (useInsertBuffers) {
+                    newCtxt.setInsertBuffer(&insertBuffer);
+                }
                 for (const auto& info : viewInfo) {
-                    newCtxt.createView(*getRelationHandle(info[0]), info[1], info[2]);
+                    newCtxt.createView(*ctxt.getEnvironment().getRelationHandle(info[0]), info[1], info[2]);
                 }
-                pfor(auto it = pStream.begin(); it < pStream.end(); it++) {
-                    for (const TupleRef& val : *it) {
+                size_t partition;
+                while (loop.next(partition)) {
+                    for (const TupleRef& val : pStream[partition]) {
                         newCtxt[cur.getTupleId()] = val.getBase();
                         if (execute(node->getChild(0), newCtxt)) {
                             execute(node->getChild(1), newCtxt);
@@ -904,7 +1040,10 @@ RamDomain InterpreterEngine::execute(const InterpreterNode* node, InterpreterCon
                         }
                     }
                 }
+                InterpreterInsertBuffer::collect(insertBuffer, insertBuffers);
             PARALLEL_END;
+            InterpreterInsertBuffer::flush(insertBuffers, ctxt.getEnvironment());
+            reportBusyTime(loop);
             return true;
         ESAC(ParallelChoice)
 
@@ -939,9 +1078,9 @@ RamDomain InterpreterEngine::execute(const InterpreterNode* node, InterpreterCon
 
         CASE(ParallelIndexChoice)
             auto preamble = node->getPreamble();
-            auto& rel = *node->getRelation();
+            auto& rel = *getRelation(node, ctxt);
 
-            auto viewInfo = preamble->getViewInfoForNested();
+            const auto& viewInfo = preamble->getViewInfoForNested();
 
             // create pattern tuple for range query
             size_t arity = rel.getArity();
@@ -958,17 +1097,25 @@ RamDomain InterpreterEngine::execute(const InterpreterNode* node, InterpreterCon
             }
 
             size_t indexPos = node->getData(0);
-            auto pStream =
-                    rel.partitionRange(indexPos, TupleRef(low, arity), TupleRef(hig, arity), numOfThreads);
+            auto pStream = rel.partitionRange(indexPos, TupleRef(low, arity), TupleRef(hig, arity),
+                    MAX_THREADS * PARTITIONS_PER_THREAD);
 
+            std::vector<InterpreterInsertBuffer> insertBuffers;
+            WorkStealingLoop loop(pStream.size());
+            ctxt.reserveThreadContexts(MAX_THREADS);
             PARALLEL_START
                 ;
-                InterpreterContext newCtxt(ctxt);
+                InterpreterContext& newCtxt = ctxt.getThreadContext(THREAD_NUM);
+                InterpreterInsertBuffer insertBuffer;
+                if (useInsertBuffers) {
+                    newCtxt.setInsertBuffer(&insertBuffer);
+                }
                 for (const auto& info : viewInfo) {
-                    newCtxt.createView(*getRelationHandle(info[0]), info[1], info[2]);
+                    newCtxt.createView(*ctxt.getEnvironment().getRelationHandle(info[0]), info[1], info[2]);
                 }
-                pfor(auto it = pStream.begin(); it < pStream.end(); it++) {
-                    for (const TupleRef& val : *it) {
+                size_t partition;
+                while (loop.next(partition)) {
+                    for (const TupleRef& val : pStream[partition]) {
                         newCtxt[cur.getTupleId()] = val.getBase();
                         if (execute(node->getChild(arity), newCtxt)) {
                             execute(node->getChild(arity + 1), newCtxt);
@@ -976,7 +1123,10 @@ RamDomain InterpreterEngine::execute(const InterpreterNode* node, InterpreterCon
                         }
                     }
                 }
+                InterpreterInsertBuffer::collect(insertBuffer, insertBuffers);
             PARALLEL_END;
+            InterpreterInsertBuffer::flush(insertBuffers, ctxt.getEnvironment());
+            reportBusyTime(loop);
 
             return true;
         ESAC(ParallelIndexChoice)
@@ -991,7 +1141,7 @@ RamDomain InterpreterEngine::execute(const InterpreterNode* node, InterpreterCon
 
             // update environment variable
             size_t arity = cur.getArity();
-            const RamDomain* tuple = getRecordTable().unpack(ref, arity);
+            const RamDomain* tuple = ctxt.getEnvironment().getRecordTable().unpack(ref, arity);
 
             // save reference to temporary value
             ctxt[cur.getTupleId()] = tuple;
@@ -1001,8 +1151,13 @@ RamDomain InterpreterEngine::execute(const InterpreterNode* node, InterpreterCon
         ESAC(UnpackRecord)
 
         CASE(Aggregate)
-            return executeAggregate(ctxt, cur, *node->getChild(0), *node->getChild(1), *node->getChild(2),
-                    node->getRelation()->scan());
+            auto& rel = *getRelation(node, ctxt);
+            if (isParallelAggregate(*node, rel.size())) {
+                return executeParallelAggregate(ctxt, *node, cur, *node->getChild(0), *node->getChild(1),
+                        *node->getChild(2), rel.partitionScan(getPartitionCount(rel.size(), MAX_THREADS)));
+            }
+            return executeAggregate(
+                    ctxt, cur, *node->getChild(0), *node->getChild(1), *node->getChild(2), rel.scan());
         ESAC(Aggregate)
 
         CASE(IndexAggregate)
@@ -1023,6 +1178,16 @@ RamDomain InterpreterEngine::execute(const InterpreterNode* node, InterpreterCon
                 }
             }
 
+            // the size of the relation bounds the size of the range
+            auto& rel = *getRelation(node, ctxt);
+            if (isParallelAggregate(*node, rel.size())) {
+                size_t indexPos = node->getData(1);
+                return executeParallelAggregate(ctxt, *node, cur, *node->getChild(arity),
+                        *node->getChild(arity + 1), *node->getChild(arity + 2),
+                        rel.partitionRange(indexPos, TupleRef(low, arity), TupleRef(hig, arity),
+                                MAX_THREADS * PARTITIONS_PER_THREAD));
+            }
+
             size_t viewId = node->getData(0);
             auto& view = ctxt.getView(viewId);
 
@@ -1038,7 +1203,7 @@ RamDomain InterpreterEngine::execute(const InterpreterNode* node, InterpreterCon
             return execute(node->getChild(1), ctxt);
         ESAC(Break)
 
-        CASE(Filter)
+        CASE_NO_CAST(Filter)
             bool result = true;
             // check condition
             if (execute(node->getChild(0), ctxt)) {
@@ -1046,12 +1211,8 @@ RamDomain InterpreterEngine::execute(const InterpreterNode* node, InterpreterCon
                 result = execute(node->getChild(1), ctxt);
             }
 
-            if (profileEnabled && !cur.getProfileText().empty()) {
-                auto& currentFrequencies = frequencies[cur.getProfileText()];
-                while (currentFrequencies.size() <= getIterationNumber()) {
-                    currentFrequencies.emplace_back(0);
-                }
-                frequencies[cur.getProfileText()][getIterationNumber()]++;
+            if (profileEnabled && node->getData(0) != InterpreterProfile::NO_COUNTER) {
+                profile.inc(node->getData(0), ctxt.getEnvironment().getIterationNumber());
             }
             return result;
         ESAC(Filter)
@@ -1062,15 +1223,23 @@ RamDomain InterpreterEngine::execute(const InterpreterNode* node, InterpreterCon
             for (size_t i = 0; i < arity; i++) {
                 tuple[i] = execute(node->getChild(i), ctxt);
             }
+            ctxt.countTuple();
+
+            // buffer the tuple if this thread defers its inserts
+            InterpreterInsertBuffer* buffer = ctxt.getInsertBuffer();
+            if (buffer != nullptr && arity > 0) {
+                buffer->insert(node->getRelationId(), tuple, arity);
+                return true;
+            }
 
             // insert in target relation
-            InterpreterRelation& rel = *node->getRelation();
+            InterpreterRelation& rel = *getRelation(node, ctxt);
             rel.insert(tuple);
             return true;
         ESAC(Project)
 
-        CASE(SubroutineReturnValue)
-            for (size_t i = 0; i < cur.getValues().size(); ++i) {
+        CASE_NO_CAST(SubroutineReturnValue)
+            for (size_t i = 0; i < node->getChildren().size(); ++i) {
                 if (node->getChild(i) == nullptr) {
                     ctxt.addReturnValue(0);
                 } else {
@@ -1090,7 +1259,34 @@ RamDomain InterpreterEngine::execute(const InterpreterNode* node, InterpreterCon
         ESAC(Sequence)
 
         CASE_NO_CAST(Parallel)
-            for (const auto& child : node->getChildren()) {
+            const auto& children = node->getChildren();
+#ifdef _OPENMP
+            // Children are independent; run them concurrently if there are spare threads and
+            // another level of parallel regions is permitted. Profile counters tell threads apart
+            // by their number in one team only, so profiled evaluations run the children in turn.
+            const size_t numThreads = omp_get_max_threads();
+            if (!profileEnabled && children.size() > 1 && numThreads > 1 &&
+                    omp_get_active_level() < omp_get_max_active_levels()) {
+                const size_t teamSize = std::min(children.size(), numThreads);
+                // The threads of the team share the remaining threads for their nested operations
+                const int nestedThreads = std::max<size_t>(1, numThreads / teamSize);
+                std::atomic<bool> result(true);
+#pragma omp parallel for num_threads(teamSize) schedule(dynamic)
+                for (size_t i = 0; i < children.size(); ++i) {
+                    // as in the sequential loop, the remaining children are skipped once one fails
+                    if (!result.load()) {
+                        continue;
+                    }
+                    omp_set_num_threads(nestedThreads);
+                    InterpreterContext newCtxt(ctxt);
+                    if (!execute(children[i].get(), newCtxt)) {
+                        result = false;
+                    }
+                }
+                return result.load();
+            }
+#endif
+            for (const auto& child : children) {
                 if (!execute(child.get(), ctxt)) {
                     return false;
                 }
@@ -1099,11 +1295,13 @@ RamDomain InterpreterEngine::execute(const InterpreterNode* node, InterpreterCon
         ESAC(Parallel)
 
         CASE_NO_CAST(Loop)
-            resetIterationNumber();
-            while (execute(node->getChild(0), ctxt)) {
-                incIterationNumber();
+            InterpreterEnvironment& env = ctxt.getEnvironment();
+            env.resetIterationNumber();
+            // the loop stops early once the budget of the evaluation is exhausted
+            while (execute(node->getChild(0), ctxt) && !ctxt.isBudgetExhausted()) {
+                env.incIterationNumber();
             }
-            resetIterationNumber();
+            env.resetIterationNumber();
             return true;
         ESAC(Loop)
 
@@ -1112,13 +1310,13 @@ RamDomain InterpreterEngine::execute(const InterpreterNode* node, InterpreterCon
         ESAC(Exit)
 
         CASE(LogRelationTimer)
-            Logger logger(cur.getMessage(), getIterationNumber(),
-                    std::bind(&InterpreterRelation::size, node->getRelation()));
+            Logger logger(cur.getMessage(), ctxt.getEnvironment().getIterationNumber(),
+                    std::bind(&InterpreterRelation::size, getRelation(node, ctxt)));
             return execute(node->getChild(0), ctxt);
         ESAC(LogRelationTimer)
 
         CASE(LogTimer)
-            Logger logger(cur.getMessage(), getIterationNumber());
+            Logger logger(cur.getMessage(), ctxt.getEnvironment().getIterationNumber());
             return execute(node->getChild(0), ctxt);
         ESAC(LogTimer)
 
@@ -1128,14 +1326,14 @@ RamDomain InterpreterEngine::execute(const InterpreterNode* node, InterpreterCon
         ESAC(DebugInfo)
 
         CASE_NO_CAST(Clear)
-            node->getRelation()->purge();
+            getRelation(node, ctxt)->purge();
             return true;
         ESAC(Clear)
 
         CASE(LogSize)
-            const InterpreterRelation& rel = *node->getRelation();
+            const InterpreterRelation& rel = *getRelation(node, ctxt);
             ProfileEventSingleton::instance().makeQuantityEvent(
-                    cur.getMessage(), rel.size(), getIterationNumber());
+                    cur.getMessage(), rel.size(), ctxt.getEnvironment().getIterationNumber());
             return true;
         ESAC(LogSize)
 
@@ -1143,28 +1341,37 @@ RamDomain InterpreterEngine::execute(const InterpreterNode* node, InterpreterCon
 
             const auto& directive = cur.getDirectives();
             const std::string& op = cur.get("operation");
+            InterpreterEnvironment& env = ctxt.getEnvironment();
 
             if (op == "input") {
+                if (env.isInputLoaded(getRelation(node, ctxt)->getName())) {
+                    return true;
+                }
                 try {
-                    InterpreterRelation& relation = *node->getRelation();
+                    InterpreterRelation& relation = *getRelation(node, ctxt);
                     IOSystem::getInstance()
-                            .getReader(RWOperation(directive), getSymbolTable(), getRecordTable())
+                            .getReader(RWOperation(directive), getSymbolTable(), env.getRecordTable())
                             ->readAll(relation);
+                    relation.seal();
                 } catch (std::exception& e) {
                     std::cerr << "Error loading data: " << e.what() << "\n";
                 }
                 return true;
             } else if (op == "output" || op == "printsize") {
+                if (!stringOutput) {
+                    return true;
+                }
                 try {
                     std::cout << "trying output" << std::endl;
                     // IOSystem::getInstance()
                     //         .getWriter(RWOperation(directive), getSymbolTable(), getRecordTable())
-                    //         ->writeAll(*node->getRelation());
+                    //         ->writeAll(*getRelation(node, ctxt));
                     
-                    WriteStringCSV writer = WriteStringCSV(RWOperation(directive), getSymbolTable(), getRecordTable());
-                    writer.writeAll(*node->getRelation());
+                    WriteStringCSV writer =
+                            WriteStringCSV(RWOperation(directive), getSymbolTable(), env.getRecordTable());
+                    writer.writeAll(*getRelation(node, ctxt));
                     std::vector<std::string> result = writer.getResult();
-                    this->execute_result[result[0]] = splitString(result[2], '\n');
+                    env.getResult()[result[0]] = splitString(result[2], '\n');
                     
                     std::cout << "end output: " << std::endl;
                 } catch (std::exception& e) {
@@ -1181,58 +1388,59 @@ RamDomain InterpreterEngine::execute(const InterpreterNode* node, InterpreterCon
         ESAC(IO)
 
         CASE_NO_CAST(Query)
-            InterpreterPreamble* preamble = node->getPreamble();
-
-            // Execute view-free operations in outer filter if any.
-            auto& viewFreeOps = preamble->getOuterFilterViewFreeOps();
-            for (auto& op : viewFreeOps) {
-                if (!execute(op.get(), ctxt)) {
-                    return true;
-                }
+            // queries are skipped once the budget of the evaluation is exhausted
+            if (ctxt.isBudgetExhausted()) {
+                return true;
             }
-
-            // Create Views for outer filter operation if any.
-            auto& viewsForOuter = preamble->getViewInfoForFilter();
-            for (auto& info : viewsForOuter) {
-                ctxt.createView(*getRelationHandle(info[0]), info[1], info[2]);
+            // native bodies neither poll the budget nor count tuples; limited evaluations interpret
+            const auto& jitQuery = node->getJitQuery();
+            if (jitQuery == nullptr || ctxt.hasBudget()) {
+                executeQuery(node, ctxt);
+                return true;
             }
 
-            // Execute outer filter operation.
-            auto& viewOps = preamble->getOuterFilterViewOps();
-            for (auto& op : viewOps) {
-                if (!execute(op.get(), ctxt)) {
-                    return true;
-                }
+            // run the native body once it is loaded; until then, time the interpretation
+            if (InterpreterJitQueryBody body = jitQuery->getBody()) {
+                executeNativeQuery(body, *jitQuery, ctxt);
+                return true;
             }
-
-            if (preamble->isParallel) {
-                // If Parallel is true, holds views creation unitl parallel instructions.
-            } else {
-                // Issue views for nested operation.
-                auto& viewsForNested = preamble->getViewInfoForNested();
-                for (auto& info : viewsForNested) {
-                    ctxt.createView(*getRelationHandle(info[0]), info[1], info[2]);
-                }
+            auto start = std::chrono::steady_clock::now();
+            executeQuery(node, ctxt);
+            if (jitQuery->addTime(std::chrono::steady_clock::now() - start, jit->getThreshold())) {
+                jit->submit(jitQuery);
             }
-            execute(node->getChild(0), ctxt);
             return true;
         ESAC(Query)
 
+        CASE_NO_CAST(Merge)
+            // merges are skipped once the budget of the evaluation is exhausted, like other queries
+            if (ctxt.isBudgetExhausted()) {
+                return true;
+            }
+            const InterpreterRelation& src = *ctxt.getEnvironment().getRelationHandle(node->getData(0));
+            InterpreterRelation& trg = *ctxt.getEnvironment().getRelationHandle(node->getData(1));
+            ctxt.countTuple(src.size());
+            trg.insert(src);
+            return true;
+        ESAC(Merge)
+
         CASE_NO_CAST(Extend)
-            InterpreterRelation& src = *getRelationHandle(node->getData(0));
-            InterpreterRelation& trg = *getRelationHandle(node->getData(1));
+            InterpreterRelation& src = *ctxt.getEnvironment().getRelationHandle(node->getData(0));
+            InterpreterRelation& trg = *ctxt.getEnvironment().getRelationHandle(node->getData(1));
             src.extend(trg);
             trg.insert(src);
             return true;
         ESAC(Extend)
 
         CASE_NO_CAST(Swap)
-            swapRelation(node->getData(0), node->getData(1));
+            ctxt.getEnvironment().swapRelation(node->getData(0), node->getData(1));
             return true;
         ESAC(Swap)
 
+#ifndef SOUFFLE_COMPUTED_GOTO
         default:
             assert(false && "Unhandled\n");
+#endif
     }
 }
 
@@ -1240,58 +1448,326 @@ template <typename Aggregate>
 RamDomain InterpreterEngine::executeAggregate(InterpreterContext& ctxt, const Aggregate& aggregate,
         const InterpreterNode& filter, const InterpreterNode& expression,
         const InterpreterNode& nestedOperation, Stream stream) {
-    bool shouldRunNested = false;
+    AggregateState state = initAggregate(aggregate.getFunction());
+    accumulateAggregate(ctxt, aggregate, filter, expression, stream, state);
+    return finishAggregate(ctxt, aggregate, nestedOperation, state);
+}
+
+namespace {
+/** Minimal size of a relation for aggregates over it to be evaluated in parallel */
+constexpr size_t PARALLEL_AGGREGATE_THRESHOLD = 1 << 16;
+}  // namespace
+
+template <typename Aggregate>
+RamDomain InterpreterEngine::executeParallelAggregate(InterpreterContext& ctxt, const InterpreterNode& node,
+        const Aggregate& aggregate, const InterpreterNode& filter, const InterpreterNode& expression,
+        const InterpreterNode& nestedOperation, PartitionedStream stream) {
+    const AggregateOp op = aggregate.getFunction();
+    AggregateState state = initAggregate(op);
+
+    WorkStealingLoop loop(stream.size());
+    ctxt.reserveThreadContexts(MAX_THREADS);
+    PARALLEL_START
+        ;
+        // each thread folds its partitions into a partial result, using views of its own
+        InterpreterContext& newCtxt = ctxt.getThreadContext(THREAD_NUM);
+        for (const auto& info : node.getPreamble()->getViewInfoForNested()) {
+            newCtxt.createView(*ctxt.getEnvironment().getRelationHandle(info[0]), info[1], info[2]);
+        }
+        AggregateState partial = initAggregate(op);
+        size_t partition;
+        while (loop.next(partition)) {
+            accumulateAggregate(newCtxt, aggregate, filter, expression, stream[partition], partial);
+        }
+        PARALLEL_CRITICAL
+        combineAggregate(op, state, partial);
+    PARALLEL_END
+    reportBusyTime(loop);
+
+    return finishAggregate(ctxt, aggregate, nestedOperation, state);
+}
+
+const InterpreterNode* InterpreterEngine::getBatchedFilter(const InterpreterNode* tupleOperation) const {
+    // profile counters are incremented per tuple, hence profiled evaluations are not batched
+    const InterpreterNode* nested = tupleOperation->getChild(0);
+    if (profileEnabled || nested->getType() != I_Filter || nested->getData(1) == 0) {
+        return nullptr;
+    }
+    return nested;
+}
+
+void InterpreterEngine::executeBatched(
+        const InterpreterNode* filter, int tupleId, Stream& stream, InterpreterContext& ctxt) {
+    const TupleRef* batch;
+    size_t selection[Stream::BUFFER_SIZE];
+    while (size_t size = stream.nextBatch(batch)) {
+        if (!ctxt.tick(size)) {
+            return;
+        }
+        std::iota(selection, selection + size, 0);
+        size_t count = filterBatch(filter->getChild(0), ctxt, tupleId, batch, selection, size);
+        for (size_t i = 0; i < count; ++i) {
+            ctxt[tupleId] = batch[selection[i]].getBase();
+            if (!execute(filter->getChild(1), ctxt)) {
+                return;
+            }
+        }
+    }
+}
+
+size_t InterpreterEngine::filterBatch(const InterpreterNode* condition, InterpreterContext& ctxt,
+        int tupleId, const TupleRef* batch, size_t* selection, size_t count) {
+    switch (condition->getType()) {
+        case I_True:
+            return count;
+        case I_False:
+            return 0;
+        case I_Conjunction:
+            count = filterBatch(condition->getChild(0), ctxt, tupleId, batch, selection, count);
+            return filterBatch(condition->getChild(1), ctxt, tupleId, batch, selection, count);
+        case I_Constraint:
+            break;
+        default:
+            assert(false && "condition cannot be evaluated in batches");
+            return 0;
+    }
+
+    RamDomain lhs[Stream::BUFFER_SIZE];
+    RamDomain rhs[Stream::BUFFER_SIZE];
+    evaluateBatch(condition->getChild(0), ctxt, tupleId, batch, selection, count, lhs);
+    evaluateBatch(condition->getChild(1), ctxt, tupleId, batch, selection, count, rhs);
+
+    // the comparisons are independent of each other and free of branches, hence they vectorise
+    bool keep[Stream::BUFFER_SIZE];
+    // clang-format off
+#define COMPARE_BATCH(ty, op)                                                 \
+    for (size_t i = 0; i < count; ++i) {                                      \
+        keep[i] = ramBitCast<ty>(lhs[i]) op ramBitCast<ty>(rhs[i]);           \
+    }                                                                         \
+    break;
+#define COMPARE_BATCH_EQ_NE(opCode, op)                                       \
+    case BinaryConstraintOp::   opCode: COMPARE_BATCH(RamDomain  , op)        \
+    case BinaryConstraintOp::F##opCode: COMPARE_BATCH(RamFloat   , op)
+#define COMPARE_BATCH_NUMERIC(opCode, op)                                     \
+    case BinaryConstraintOp::   opCode: COMPARE_BATCH(RamSigned  , op)        \
+    case BinaryConstraintOp::U##opCode: COMPARE_BATCH(RamUnsigned, op)        \
+    case BinaryConstraintOp::F##opCode: COMPARE_BATCH(RamFloat   , op)
+    // clang-format on
+
+    const auto& constraint = static_cast<const RamConstraint&>(*condition->getShadow());
+    switch (constraint.getOperator()) {
+        COMPARE_BATCH_EQ_NE(EQ, ==)
+        COMPARE_BATCH_EQ_NE(NE, !=)
+
+        COMPARE_BATCH_NUMERIC(LT, <)
+        COMPARE_BATCH_NUMERIC(LE, <=)
+        COMPARE_BATCH_NUMERIC(GT, >)
+        COMPARE_BATCH_NUMERIC(GE, >=)
+
+        default:
+            assert(false && "constraint cannot be evaluated in batches");
+            return 0;
+    }
 
-    // initialize result
-    RamDomain res = 0;
+#undef COMPARE_BATCH
+#undef COMPARE_BATCH_EQ_NE
+#undef COMPARE_BATCH_NUMERIC
+
+    // compact the selection to the tuples satisfying the constraint
+    size_t kept = 0;
+    for (size_t i = 0; i < count; ++i) {
+        selection[kept] = selection[i];
+        kept += keep[i];
+    }
+    return kept;
+}
+
+void InterpreterEngine::evaluateBatch(const InterpreterNode* expression, InterpreterContext& ctxt,
+        int tupleId, const TupleRef* batch, const size_t* selection, size_t count, RamDomain* result) {
+    switch (expression->getType()) {
+        case I_Constant: {
+            const auto& constant = static_cast<const RamConstant&>(*expression->getShadow());
+            std::fill(result, result + count, constant.getConstant());
+            return;
+        }
+        case I_TupleElement: {
+            const auto& access = static_cast<const RamTupleElement&>(*expression->getShadow());
+            const size_t element = access.getElement();
+            if (access.getTupleId() != tupleId) {
+                // bound by an outer operation, hence the same for the whole batch
+                std::fill(result, result + count, ctxt[access.getTupleId()][element]);
+                return;
+            }
+            for (size_t i = 0; i < count; ++i) {
+                result[i] = batch[selection[i]].getBase()[element];
+            }
+            return;
+        }
+        case I_IntrinsicOperator:
+            break;
+        default:
+            assert(false && "expression cannot be evaluated in batches");
+            return;
+    }
+
+    const auto& op = static_cast<const RamIntrinsicOperator&>(*expression->getShadow());
+    evaluateBatch(expression->getChild(0), ctxt, tupleId, batch, selection, count, result);
+    if (op.getOperator() == FunctorOp::NEG) {
+        for (size_t i = 0; i < count; ++i) {
+            result[i] = -result[i];
+        }
+        return;
+    } else if (op.getOperator() == FunctorOp::FNEG) {
+        for (size_t i = 0; i < count; ++i) {
+            result[i] = ramBitCast(-ramBitCast<RamFloat>(result[i]));
+        }
+        return;
+    }
 
-    // Use for calculating mean.
-    std::pair<RamFloat, RamFloat> accumulateMean;
+    RamDomain rhs[Stream::BUFFER_SIZE];
+    evaluateBatch(expression->getChild(1), ctxt, tupleId, batch, selection, count, rhs);
+    // clang-format off
+#define BINARY_BATCH(ty, op)                                                  \
+    for (size_t i = 0; i < count; ++i) {                                      \
+        result[i] = ramBitCast(ramBitCast<ty>(result[i]) op ramBitCast<ty>(rhs[i])); \
+    }                                                                         \
+    return;
+#define BINARY_BATCH_NUMERIC(opCode, op)                                      \
+    case FunctorOp::   opCode: BINARY_BATCH(RamSigned  , op)                  \
+    case FunctorOp::U##opCode: BINARY_BATCH(RamUnsigned, op)                  \
+    case FunctorOp::F##opCode: BINARY_BATCH(RamFloat   , op)
+    // clang-format on
+
+    switch (op.getOperator()) {
+        BINARY_BATCH_NUMERIC(ADD, +)
+        BINARY_BATCH_NUMERIC(SUB, -)
+        BINARY_BATCH_NUMERIC(MUL, *)
 
-    switch (aggregate.getFunction()) {
+        default:
+            assert(false && "operator cannot be evaluated in batches");
+            return;
+    }
+
+#undef BINARY_BATCH
+#undef BINARY_BATCH_NUMERIC
+}
+
+void InterpreterEngine::executeQuery(const InterpreterNode* node, InterpreterContext& ctxt) {
+    InterpreterPreamble* preamble = node->getPreamble();
+
+    // Execute view-free operations in outer filter if any.
+    auto& viewFreeOps = preamble->getOuterFilterViewFreeOps();
+    for (auto& op : viewFreeOps) {
+        if (!execute(op.get(), ctxt)) {
+            return;
+        }
+    }
+
+    // Create Views for outer filter operation if any.
+    auto& viewsForOuter = preamble->getViewInfoForFilter();
+    for (auto& info : viewsForOuter) {
+        ctxt.createView(*ctxt.getEnvironment().getRelationHandle(info[0]), info[1], info[2]);
+    }
+
+    // Execute outer filter operation.
+    auto& viewOps = preamble->getOuterFilterViewOps();
+    for (auto& op : viewOps) {
+        if (!execute(op.get(), ctxt)) {
+            return;
+        }
+    }
+
+    if (preamble->isParallel) {
+        // If Parallel is true, holds views creation unitl parallel instructions.
+    } else {
+        // Issue views for nested operation.
+        auto& viewsForNested = preamble->getViewInfoForNested();
+        for (auto& info : viewsForNested) {
+            ctxt.createView(*ctxt.getEnvironment().getRelationHandle(info[0]), info[1], info[2]);
+        }
+    }
+    execute(node->getChild(0), ctxt);
+    // scratch tuples do not outlive the query
+    ctxt.resetArena();
+}
+
+void InterpreterEngine::executeNativeQuery(
+        InterpreterJitQueryBody body, const InterpreterJitQuery& query, InterpreterContext& ctxt) {
+    const std::vector<size_t>& relIds = query.getRelationIds();
+    std::vector<InterpreterRelation*> rels(relIds.size());
+    for (size_t i = 0; i < relIds.size(); ++i) {
+        rels[i] = ctxt.getEnvironment().getRelationHandle(relIds[i]).get();
+    }
+    body(jit->getRuntime(), rels.data());
+}
+
+void InterpreterEngine::reportBusyTime(const WorkStealingLoop& loop) {
+    if (!profileEnabled) {
+        return;
+    }
+    for (size_t thread = 0; thread < loop.getNumThreads(); ++thread) {
+        ProfileEventSingleton::instance().addBusyTime(thread, loop.getBusyTime(thread));
+    }
+}
+
+bool InterpreterEngine::isParallelAggregate(const InterpreterNode& node, size_t size) const {
+    // Only outer-most aggregates have a preamble; small ones are not worth a parallel region
+    return node.getPreamble() != nullptr && size >= PARALLEL_AGGREGATE_THRESHOLD && numOfThreads != 1;
+}
+
+InterpreterEngine::AggregateState InterpreterEngine::initAggregate(AggregateOp op) {
+    AggregateState state;
+    switch (op) {
         case AggregateOp::MIN:
-            res = ramBitCast(MAX_RAM_SIGNED);
+            state.result = ramBitCast(MAX_RAM_SIGNED);
             break;
         case AggregateOp::UMIN:
-            res = ramBitCast(MAX_RAM_UNSIGNED);
+            state.result = ramBitCast(MAX_RAM_UNSIGNED);
             break;
         case AggregateOp::FMIN:
-            res = ramBitCast(MAX_RAM_FLOAT);
+            state.result = ramBitCast(MAX_RAM_FLOAT);
             break;
 
         case AggregateOp::MAX:
-            res = ramBitCast(MIN_RAM_SIGNED);
+            state.result = ramBitCast(MIN_RAM_SIGNED);
             break;
         case AggregateOp::UMAX:
-            res = ramBitCast(MIN_RAM_UNSIGNED);
+            state.result = ramBitCast(MIN_RAM_UNSIGNED);
             break;
         case AggregateOp::FMAX:
-            res = ramBitCast(MIN_RAM_FLOAT);
+            state.result = ramBitCast(MIN_RAM_FLOAT);
             break;
 
         case AggregateOp::SUM:
-            res = ramBitCast(static_cast<RamSigned>(0));
-            shouldRunNested = true;
+            state.result = ramBitCast(static_cast<RamSigned>(0));
+            state.shouldRunNested = true;
             break;
         case AggregateOp::USUM:
-            res = ramBitCast(static_cast<RamUnsigned>(0));
-            shouldRunNested = true;
+            state.result = ramBitCast(static_cast<RamUnsigned>(0));
+            state.shouldRunNested = true;
             break;
         case AggregateOp::FSUM:
-            res = ramBitCast(static_cast<RamFloat>(0));
-            shouldRunNested = true;
+            state.result = ramBitCast(static_cast<RamFloat>(0));
+            state.shouldRunNested = true;
             break;
 
         case AggregateOp::MEAN:
-            res = 0;
-            accumulateMean = {0, 0};
+            state.result = 0;
             break;
 
         case AggregateOp::COUNT:
-            res = 0;
-            shouldRunNested = true;
+            state.result = 0;
+            state.shouldRunNested = true;
             break;
     }
+    return state;
+}
+
+template <typename Aggregate>
+void InterpreterEngine::accumulateAggregate(InterpreterContext& ctxt, const Aggregate& aggregate,
+        const InterpreterNode& filter, const InterpreterNode& expression, Stream& stream,
+        AggregateState& state) {
+    RamDomain& res = state.result;
 
     for (auto ip : stream) {
         const RamDomain* data = &ip[0];
@@ -1301,7 +1777,7 @@ RamDomain InterpreterEngine::executeAggregate(InterpreterContext& ctxt, const Ag
             continue;
         }
 
-        shouldRunNested = true;
+        state.shouldRunNested = true;
 
         // count is a special case.
         if (aggregate.getFunction() == AggregateOp::COUNT) {
@@ -1344,8 +1820,8 @@ RamDomain InterpreterEngine::executeAggregate(InterpreterContext& ctxt, const Ag
                 break;
 
             case AggregateOp::MEAN:
-                accumulateMean.first += ramBitCast<RamFloat>(val);
-                accumulateMean.second++;
+                state.mean.first += ramBitCast<RamFloat>(val);
+                state.mean.second++;
                 break;
 
             case AggregateOp::COUNT:
@@ -1353,17 +1829,64 @@ RamDomain InterpreterEngine::executeAggregate(InterpreterContext& ctxt, const Ag
                 break;
         }
     }
+}
+
+void InterpreterEngine::combineAggregate(AggregateOp op, AggregateState& state, const AggregateState& other) {
+    RamDomain& res = state.result;
+    const RamDomain val = other.result;
+    switch (op) {
+        case AggregateOp::MIN:
+            res = std::min(res, val);
+            break;
+        case AggregateOp::FMIN:
+            res = ramBitCast(std::min(ramBitCast<RamFloat>(res), ramBitCast<RamFloat>(val)));
+            break;
+        case AggregateOp::UMIN:
+            res = ramBitCast(std::min(ramBitCast<RamUnsigned>(res), ramBitCast<RamUnsigned>(val)));
+            break;
+
+        case AggregateOp::MAX:
+            res = std::max(res, val);
+            break;
+        case AggregateOp::FMAX:
+            res = ramBitCast(std::max(ramBitCast<RamFloat>(res), ramBitCast<RamFloat>(val)));
+            break;
+        case AggregateOp::UMAX:
+            res = ramBitCast(std::max(ramBitCast<RamUnsigned>(res), ramBitCast<RamUnsigned>(val)));
+            break;
+
+        case AggregateOp::SUM:
+        case AggregateOp::COUNT:
+            res += val;
+            break;
+        case AggregateOp::FSUM:
+            res = ramBitCast(ramBitCast<RamFloat>(res) + ramBitCast<RamFloat>(val));
+            break;
+        case AggregateOp::USUM:
+            res = ramBitCast(ramBitCast<RamUnsigned>(res) + ramBitCast<RamUnsigned>(val));
+            break;
+
+        case AggregateOp::MEAN:
+            state.mean.first += other.mean.first;
+            state.mean.second += other.mean.second;
+            break;
+    }
+    state.shouldRunNested = state.shouldRunNested || other.shouldRunNested;
+}
 
-    if (aggregate.getFunction() == AggregateOp::MEAN && accumulateMean.second != 0) {
-        res = ramBitCast(accumulateMean.first / accumulateMean.second);
+template <typename Aggregate>
+RamDomain InterpreterEngine::finishAggregate(InterpreterContext& ctxt, const Aggregate& aggregate,
+        const InterpreterNode& nestedOperation, AggregateState& state) {
+    if (aggregate.getFunction() == AggregateOp::MEAN && state.mean.second != 0) {
+        state.result = ramBitCast(state.mean.first / state.mean.second);
     }
 
     // write result to environment
     RamDomain tuple[1];
-    tuple[0] = res;
+    tuple[0] = state.result;
     ctxt[aggregate.getTupleId()] = tuple;
 
-    if (!shouldRunNested) {
+    if (!state.shouldRunNested) {
         return true;
     } else {
         return execute(&nestedOperation, ctxt);
@@ -16,17 +16,25 @@
 
 #pragma once
 
+#include "EvaluationBudget.h"
 #include "InterpreterContext.h"
+#include "InterpreterEnvironment.h"
 #include "InterpreterGenerator.h"
+#include "InterpreterJit.h"
 #include "InterpreterNode.h"
 #include "InterpreterPreamble.h"
+#include "InterpreterProfile.h"
 #include "InterpreterRelation.h"
 #include "RamTranslationUnit.h"
 #include "RamVisitor.h"
 #include "RecordTable.h"
-#include <deque>
+#include "RegexCache.h"
+#include "WorkStealing.h"
+#include <chrono>
 #include <map>
 #include <memory>
+#include <mutex>
+#include <set>
 #include <string>
 #include <vector>
 #include <dlfcn.h>
@@ -46,30 +54,77 @@ class InterpreterEngine {
 public:
     InterpreterEngine(RamTranslationUnit& tUnit)
             : profileEnabled(Global::config().has("profile")),
-              numOfThreads(std::stoi(Global::config().get("jobs"))), tUnit(tUnit),
-              isa(tUnit.getAnalysis<RamIndexAnalysis>()), generator(isa) {
+              numOfThreads(std::stoi(Global::config().get("jobs"))),
+              useInsertBuffers(Global::config().has("insert-buffers") && !Global::config().has("provenance")),
+              tUnit(tUnit),
+              isa(tUnit.getAnalysis<RamIndexAnalysis>()),
+              generator(isa, tUnit.getSymbolTable(), mainEnv.getRelationMap(), profile,
+                      [this](const std::string& name) { return getMethodHandle(name); }),
+              jit(Global::config().has("jit") ? std::make_unique<InterpreterJit>(std::chrono::milliseconds(
+                                                        std::stoll(Global::config().get("jit"))))
+                                              : nullptr) {
 #ifdef _OPENMP
         if (numOfThreads > 0) {
             omp_set_num_threads(numOfThreads);
         }
 #endif
+        EvaluationBudget& budget = mainEnv.getBudget();
+        if (Global::config().has("time-limit")) {
+            budget.setTimeLimit(std::chrono::milliseconds(std::stoll(Global::config().get("time-limit"))));
+        }
+        if (Global::config().has("tuple-limit")) {
+            budget.setTupleLimit(std::stoull(Global::config().get("tuple-limit")));
+        }
+        if (Global::config().has("memory-limit")) {
+            budget.setMemoryLimit(std::stoull(Global::config().get("memory-limit")) << 20);
+        }
     }
 
+    /** @brief Generate the executable trees of the main program and subroutines (once) */
+    void generateMain();
     /** @brief Execute the main program */
     void executeMain();
-    /** @brief Execute the subroutine program */
+    /**
+     * @brief Create an environment with a fresh, empty instance of every relation of the main program.
+     * The environment takes over the limits of the main environment.
+     */
+    std::unique_ptr<InterpreterEnvironment> createEnvironment();
+    /** @brief Execute the main program on each environment; environments are evaluated concurrently */
+    void executeBatch(const std::vector<InterpreterEnvironment*>& envs);
+    /** @brief Return the environment of the main program, which holds the budget of executeMain */
+    InterpreterEnvironment& getEnvironment() {
+        return mainEnv;
+    }
+    /** @brief Reset relations and run-time state so that the main program can be executed again */
+    void reset();
+    /** @brief Return the relation with the given name, or nullptr if the program does not use it */
+    InterpreterRelation* getRelation(const std::string& name);
+    /** @brief Mark an input relation as loaded by the caller; its input directive is skipped */
+    void setInputLoaded(const std::string& name);
+    /** @brief Return the names of all relations with an output directive */
+    std::vector<std::string> getOutputRelationNames() const;
+    /** @brief Copy a relation into one contiguous array of raw values per attribute */
+    std::vector<std::vector<RamDomain>> getColumns(const std::string& name);
+    /** @brief Copy a relation of the given environment into one array per attribute */
+    static std::vector<std::vector<RamDomain>> getColumns(
+            InterpreterEnvironment& env, const std::string& name);
+    /** @brief Enable or disable rendering output relations to strings (see get_execute_result) */
+    void setStringOutput(bool enable) {
+        stringOutput = enable;
+    }
+    /** @brief Execute the subroutine program; independent calls may run concurrently */
     void executeSubroutine(
             const std::string& name, const std::vector<RamDomain>& args, std::vector<RamDomain>& ret);
-    std::map<std::string, std::vector<std::string>> get_execute_result();
+    /** @brief Return the output relations rendered to strings by the last execution */
+    const std::map<std::string, std::vector<std::string>>& get_execute_result();
 
 private:
-    std::map<std::string, std::vector<std::string>> execute_result;
-    /** @brief Remove a relation from the environment */
-    void dropRelation(const size_t relId);
-    /** @brief Swap the content of two relations */
-    void swapRelation(const size_t ramRel1, const size_t ramRel2);
-    /** @brief Return a reference to the relation on the given index */
-    RelationHandle& getRelationHandle(const size_t idx);
+    /** @brief Return the relation the node operates on in the environment of the context */
+    InterpreterRelation* getRelation(const InterpreterNode* node, const InterpreterContext& ctxt) {
+        return ctxt.getEnvironment().getRelationHandle(node->getRelationId()).get();
+    }
+    /** @brief Execute the main program tree on the given environment */
+    void executeMain(InterpreterEnvironment& env);
     /** @brief Return the string symbol table */
     SymbolTable& getSymbolTable();
     /** @brief Return the record table */
@@ -78,23 +133,70 @@ private:
     RamTranslationUnit& getTranslationUnit();
     /** @brief Execute the program */
     RamDomain execute(const InterpreterNode*, InterpreterContext&);
+    /** Partial result of an aggregate over a part of its tuples */
+    struct AggregateState {
+        RamDomain result = 0;
+        /** Sum and number of the values of a mean */
+        std::pair<RamFloat, RamFloat> mean{0, 0};
+        /** If the nested operation is executed */
+        bool shouldRunNested = false;
+    };
     /** Execute helper. Common part of Aggregate & AggregateIndex. */
     template <typename Aggregate>
     RamDomain executeAggregate(InterpreterContext& ctxt, const Aggregate& aggregate,
             const InterpreterNode& filter, const InterpreterNode& expression,
             const InterpreterNode& nestedOperation, Stream stream);
+    /** Execute helper. Aggregate the partitions of a stream in parallel and reduce the partial results. */
+    template <typename Aggregate>
+    RamDomain executeParallelAggregate(InterpreterContext& ctxt, const InterpreterNode& node,
+            const Aggregate& aggregate, const InterpreterNode& filter, const InterpreterNode& expression,
+            const InterpreterNode& nestedOperation, PartitionedStream stream);
+    /** @brief Execute the views, outer filter and operation of a query by interpretation */
+    void executeQuery(const InterpreterNode* node, InterpreterContext& ctxt);
+    /** @brief Execute the native body of a compiled query on the relations of the context */
+    void executeNativeQuery(
+            InterpreterJitQueryBody body, const InterpreterJitQuery& query, InterpreterContext& ctxt);
+    /**
+     * @brief Return the filter nested in a tuple operation if it is evaluated in batches,
+     *        otherwise nullptr
+     */
+    const InterpreterNode* getBatchedFilter(const InterpreterNode* tupleOperation) const;
+    /**
+     * @brief Bind the tuples of a stream to the given tuple id and execute the nested operation of a
+     *        tuple operation, evaluating the condition of its batched filter a chunk at a time
+     */
+    void executeBatched(
+            const InterpreterNode* filter, int tupleId, Stream& stream, InterpreterContext& ctxt);
+    /**
+     * @brief Evaluate a condition over the selected tuples of a batch.
+     * The selection is narrowed down to the tuples satisfying the condition; return their number.
+     */
+    size_t filterBatch(const InterpreterNode* condition, InterpreterContext& ctxt, int tupleId,
+            const TupleRef* batch, size_t* selection, size_t count);
+    /** @brief Evaluate an expression over the selected tuples of a batch */
+    void evaluateBatch(const InterpreterNode* expression, InterpreterContext& ctxt, int tupleId,
+            const TupleRef* batch, const size_t* selection, size_t count, RamDomain* result);
+    /** @brief Add the busy time of the threads of a parallel loop to the profile */
+    void reportBusyTime(const WorkStealingLoop& loop);
+    /** @brief Check whether an aggregate over a relation of the given size is evaluated in parallel */
+    bool isParallelAggregate(const InterpreterNode& node, size_t size) const;
+    /** @brief Return the state of an aggregate before the first tuple */
+    static AggregateState initAggregate(AggregateOp op);
+    /** @brief Add the tuples of a stream which satisfy the filter to the state of an aggregate */
+    template <typename Aggregate>
+    void accumulateAggregate(InterpreterContext& ctxt, const Aggregate& aggregate,
+            const InterpreterNode& filter, const InterpreterNode& expression, Stream& stream,
+            AggregateState& state);
+    /** @brief Merge the partial result of an aggregate into another one */
+    static void combineAggregate(AggregateOp op, AggregateState& state, const AggregateState& other);
+    /** @brief Bind the result of an aggregate and execute the nested operation */
+    template <typename Aggregate>
+    RamDomain finishAggregate(InterpreterContext& ctxt, const Aggregate& aggregate,
+            const InterpreterNode& nestedOperation, AggregateState& state);
     /** @brief Return method handler */
     void* getMethodHandle(const std::string& method);
     /** @brief Load DLL */
     const std::vector<void*>& loadDLL();
-    /** @brief Return current iteration number for loop operation */
-    size_t getIterationNumber() const;
-    /** @brief Increase iteration number by one */
-    void incIterationNumber();
-    /** @brief Reset iteration number */
-    void resetIterationNumber();
-    /** @brief Increment the counter */
-    int incCounter();
     /** @brief Return the relation map. */
     std::vector<std::unique_ptr<RelationHandle>>& getRelationMap();
 
@@ -102,24 +204,32 @@ private:
     const bool profileEnabled;
     /** Number of threads enabled for this program */
     size_t numOfThreads;
-    /** Profile counter */
-    std::atomic<RamDomain> counter{0};
-    /** Loop iteration counter */
-    size_t iteration = 0;
-    /** Profile for rule frequencies */
-    std::map<std::string, std::deque<std::atomic<size_t>>> frequencies;
-    /** Profile for relation reads */
-    std::map<std::string, std::atomic<size_t>> reads;
+    /** If parallel loops buffer their projected tuples per thread and insert them in bulk */
+    const bool useInsertBuffers;
+    /** Profile for rule frequencies and relation reads */
+    InterpreterProfile profile;
+    /** Compiled patterns of match constraints whose pattern is not a constant */
+    RegexCache regexCache;
     /** DLL */
     std::vector<void*> dll;
     /** Program */
     RamTranslationUnit& tUnit;
+    /** Environment of the main program */
+    InterpreterEnvironment mainEnv;
     /** RamIndexAnalysis */
     RamIndexAnalysis* isa;
     /** Interpreter program generator */
     NodeGenerator generator;
-    /** Record Table*/
-    RecordTable recordTable;
+    /** Executable tree of the main program, generated once */
+    std::unique_ptr<InterpreterNode> mainProgram;
+    /** Executable trees of the subroutines, generated along with the main program */
+    std::map<std::string, std::unique_ptr<InterpreterNode>> subroutines;
+    /** Serializes the generation of executable trees */
+    std::mutex generatorLock;
+    /** If output relations are rendered to strings during execution */
+    bool stringOutput = true;
+    /** Compiler of hot queries, if the tiered compilation is enabled */
+    std::unique_ptr<InterpreterJit> jit;
 };
 
 }  // namespace souffle
@@ -0,0 +1,146 @@
+/*
+ * Souffle - A Datalog Compiler
+ * Copyright (c) 2019, The Souffle Developers. All rights reserved.
+ * Licensed under the Universal Permissive License v 1.0 as shown at:
+ * - https://opensource.org/licenses/UPL
+ * - <souffle root>/licenses/SOUFFLE-UPL.txt
+ */
+
+/************************************************************************
+ *
+ * @file InterpreterEnvironment.h
+ *
+ * Declares the InterpreterEnvironment class.
+ * An environment holds the mutable state of one evaluation of a program.
+ * The executable tree refers to relations by id only, hence independent
+ * environments can evaluate the same tree at the same time.
+ ***********************************************************************/
+
+#pragma once
+
+#include "EvaluationBudget.h"
+#include "InterpreterRelation.h"
+#include "RecordTable.h"
+#include <atomic>
+#include <map>
+#include <memory>
+#include <set>
+#include <string>
+#include <vector>
+
+namespace souffle {
+
+/**
+ * @class InterpreterEnvironment
+ * @brief Relations, records, loop state and budget of one evaluation of a program.
+ */
+class InterpreterEnvironment {
+    using RelationHandle = std::unique_ptr<InterpreterRelation>;
+
+public:
+    InterpreterEnvironment() = default;
+    explicit InterpreterEnvironment(std::vector<std::unique_ptr<RelationHandle>> relations)
+            : relations(std::move(relations)) {}
+
+    /** @brief Return the relation map, indexed by relation id */
+    std::vector<std::unique_ptr<RelationHandle>>& getRelationMap() {
+        return relations;
+    }
+
+    /** @brief Return a reference to the relation on the given index */
+    RelationHandle& getRelationHandle(const size_t idx) {
+        return *relations[idx];
+    }
+
+    /** @brief Return the relation with the given name, or nullptr if there is none */
+    InterpreterRelation* getRelation(const std::string& name) {
+        for (auto& relHandle : relations) {
+            if (relHandle != nullptr && *relHandle != nullptr && (*relHandle)->getName() == name) {
+                return relHandle->get();
+            }
+        }
+        return nullptr;
+    }
+
+    /** @brief Swap the content of two relations */
+    void swapRelation(const size_t ramRel1, const size_t ramRel2) {
+        std::swap(getRelationHandle(ramRel1), getRelationHandle(ramRel2));
+    }
+
+    /** @brief Return the record table */
+    RecordTable& getRecordTable() {
+        return recordTable;
+    }
+
+    /** @brief Return current iteration number for loop operation */
+    size_t getIterationNumber() const {
+        return iteration;
+    }
+
+    /** @brief Increase iteration number by one */
+    void incIterationNumber() {
+        ++iteration;
+    }
+
+    /** @brief Reset iteration number */
+    void resetIterationNumber() {
+        iteration = 0;
+    }
+
+    /** @brief Return the current value of the auto-increment counter and increment it */
+    RamDomain incCounter() {
+        return counter++;
+    }
+
+    /** @brief Mark an input relation as loaded by the caller */
+    void setInputLoaded(const std::string& name) {
+        loadedInputs.insert(name);
+    }
+
+    /** @brief Check whether an input relation has been loaded by the caller */
+    bool isInputLoaded(const std::string& name) const {
+        return loadedInputs.count(name) != 0;
+    }
+
+    /** @brief Return the output relations rendered to strings */
+    std::map<std::string, std::vector<std::string>>& getResult() {
+        return result;
+    }
+
+    /** @brief Return the budget of the evaluation */
+    EvaluationBudget& getBudget() {
+        return budget;
+    }
+
+    /** @brief Purge all relations and forget the state of the previous evaluation */
+    void reset() {
+        for (auto& relHandle : relations) {
+            if (relHandle != nullptr && *relHandle != nullptr) {
+                (*relHandle)->purge();
+            }
+        }
+        result.clear();
+        loadedInputs.clear();
+        recordTable.clear();
+        resetIterationNumber();
+        counter = 0;
+    }
+
+private:
+    /** Relations, indexed by relation id */
+    std::vector<std::unique_ptr<RelationHandle>> relations;
+    /** Record table */
+    RecordTable recordTable;
+    /** Loop iteration counter */
+    size_t iteration = 0;
+    /** Counter of the auto-increment functor */
+    std::atomic<RamDomain> counter{0};
+    /** Input relations whose content has been provided by the caller */
+    std::set<std::string> loadedInputs;
+    /** Output relations rendered to strings */
+    std::map<std::string, std::vector<std::string>> result;
+    /** Limits of the evaluation; they are kept when the environment is reset */
+    EvaluationBudget budget;
+};
+
+}  // namespace souffle
@@ -0,0 +1,144 @@
+/*
+ * Souffle - A Datalog Compiler
+ * Copyright (c) 2019, The Souffle Developers. All rights reserved.
+ * Licensed under the Universal Permissive License v 1.0 as shown at:
+ * - https://opensource.org/licenses/UPL
+ * - <souffle root>/licenses/SOUFFLE-UPL.txt
+ */
+
+/************************************************************************
+ *
+ * @file InterpreterFunctor.h
+ *
+ * Declares the InterpreterFunctor class.
+ * Each UserDefinedOperator node has an InterpreterFunctor associated with it.
+ * It holds the resolved symbol and the prepared call interface of the functor.
+ ***********************************************************************/
+
+#pragma once
+
+#include "RamTypes.h"
+#include <cassert>
+#include <cstddef>
+#include <vector>
+#include <ffi.h>
+
+namespace souffle {
+
+// Aliases for foreign function interface.
+#if RAM_DOMAIN_SIZE == 64
+#define FFI_RamSigned ffi_type_sint64
+#define FFI_RamUnsigned ffi_type_uint64
+#define FFI_RamFloat ffi_type_double
+#else
+#define FFI_RamSigned ffi_type_sint32
+#define FFI_RamUnsigned ffi_type_uint32
+#define FFI_RamFloat ffi_type_float
+#endif
+
+#define FFI_Symbol ffi_type_pointer
+
+/**
+ * @class InterpreterFunctor
+ * @brief A user-defined operator whose symbol and call interface are resolved once,
+ *        before the evaluation, rather than on each application.
+ */
+class InterpreterFunctor {
+public:
+    /** Maximum arity of functors which are called directly, i.e., without libffi */
+    static constexpr size_t MAX_DIRECT_ARITY = 4;
+
+    InterpreterFunctor(void* handle, const std::vector<TypeAttribute>& argTypes, TypeAttribute returnType)
+            : handle(handle), types(argTypes.size()) {
+        if (handle == nullptr) {
+            return;
+        }
+
+        // Functors on numbers only are called through a typed function pointer
+        direct = returnType == TypeAttribute::Signed && argTypes.size() <= MAX_DIRECT_ARITY;
+        ffi_type* codomain = getFFIType(returnType);
+        bool supported = codomain != nullptr;
+        for (size_t i = 0; i < argTypes.size(); ++i) {
+            direct = direct && argTypes[i] == TypeAttribute::Signed;
+            types[i] = getFFIType(argTypes[i]);
+            supported = supported && types[i] != nullptr;
+        }
+
+        prepared = supported &&
+                   ffi_prep_cif(&cif, FFI_DEFAULT_ABI, types.size(), codomain, types.data()) == FFI_OK;
+    }
+
+    InterpreterFunctor(const InterpreterFunctor&) = delete;
+    InterpreterFunctor& operator=(const InterpreterFunctor&) = delete;
+
+    /** @brief Return the symbol of the functor, or nullptr if no library defines it */
+    void* getHandle() const {
+        return handle;
+    }
+
+    /** @brief Check whether the call interface for libffi could be prepared */
+    bool isPrepared() const {
+        return prepared;
+    }
+
+    /** @brief Return the call interface for libffi */
+    ffi_cif* getCif() {
+        return &cif;
+    }
+
+    /** @brief Check whether the functor can be applied with callDirect */
+    bool isDirect() const {
+        return direct;
+    }
+
+    /** @brief Apply a functor on numbers without libffi */
+    RamDomain callDirect(const RamDomain* args) const {
+        switch (types.size()) {
+            case 0:
+                return reinterpret_cast<RamDomain (*)()>(handle)();
+            case 1:
+                return reinterpret_cast<RamDomain (*)(RamDomain)>(handle)(args[0]);
+            case 2:
+                return reinterpret_cast<RamDomain (*)(RamDomain, RamDomain)>(handle)(args[0], args[1]);
+            case 3:
+                return reinterpret_cast<RamDomain (*)(RamDomain, RamDomain, RamDomain)>(handle)(
+                        args[0], args[1], args[2]);
+            case 4:
+                return reinterpret_cast<RamDomain (*)(RamDomain, RamDomain, RamDomain, RamDomain)>(handle)(
+                        args[0], args[1], args[2], args[3]);
+            default:
+                assert(false && "arity exceeds MAX_DIRECT_ARITY");
+                return 0;
+        }
+    }
+
+private:
+    /** @brief Return the libffi type of an attribute, or nullptr if it is not supported */
+    static ffi_type* getFFIType(TypeAttribute type) {
+        switch (type) {
+            case TypeAttribute::Symbol:
+                return &FFI_Symbol;
+            case TypeAttribute::Signed:
+                return &FFI_RamSigned;
+            case TypeAttribute::Unsigned:
+                return &FFI_RamUnsigned;
+            case TypeAttribute::Float:
+                return &FFI_RamFloat;
+            default:
+                return nullptr;
+        }
+    }
+
+    /** Symbol of the functor */
+    void* handle;
+    /** Argument types; they must outlive the call interface */
+    std::vector<ffi_type*> types;
+    /** Call interface for libffi */
+    ffi_cif cif;
+    /** Whether the call interface has been prepared */
+    bool prepared = false;
+    /** Whether the functor is applied through a typed function pointer */
+    bool direct = false;
+};
+
+}  // namespace souffle
@@ -18,13 +18,20 @@
 #pragma once
 
 #include "Global.h"
+#include "InterpreterJit.h"
 #include "InterpreterNode.h"
 #include "InterpreterPreamble.h"
+#include "InterpreterProfile.h"
 #include "RamIndexAnalysis.h"
 #include "RamVisitor.h"
+#include "RegexCache.h"
+#include "SymbolTable.h"
+#include <algorithm>
 #include <cassert>
+#include <functional>
 #include <memory>
 #include <queue>
+#include <string>
 
 namespace souffle {
 
@@ -39,7 +46,12 @@ class NodeGenerator : public RamVisitor<std::unique_ptr<InterpreterNode>> {
     using RelationHandle = std::unique_ptr<InterpreterRelation>;
 
 public:
-    NodeGenerator(RamIndexAnalysis* isa) : isa(isa), isProvenance(Global::config().has("provenance")) {}
+    NodeGenerator(RamIndexAnalysis* isa, const SymbolTable& symbolTable,
+            std::vector<std::unique_ptr<RelationHandle>>& relations, InterpreterProfile& profile,
+            std::function<void*(const std::string&)> resolveFunctor)
+            : isa(isa), symbolTable(symbolTable), relations(relations), profile(profile),
+              resolveFunctor(std::move(resolveFunctor)), isProvenance(Global::config().has("provenance")),
+              isJit(Global::config().has("jit") && !Global::config().has("profile") && !isProvenance) {}
 
     /**
      * @brief Generate the tree based on given entry.
@@ -51,6 +63,9 @@ public:
             if (dynamic_cast<const RamQuery*>(&node) != nullptr) {
                 newQueryBlock();
             }
+            if (const auto* tupleOperation = dynamic_cast<const RamTupleOperation*>(&node)) {
+                numTupleSlots = std::max<size_t>(numTupleSlots, tupleOperation->getTupleId() + 1);
+            }
             if (const auto* indexSearch = dynamic_cast<const RamIndexOperation*>(&node)) {
                 encodeIndexPos(*indexSearch);
                 encodeView(indexSearch);
@@ -66,6 +81,16 @@ public:
         return visit(root);
     }
 
+    /** @brief Return the number of tuple slots an evaluation of the generated trees needs */
+    size_t getNumTupleSlots() const {
+        return numTupleSlots;
+    }
+
+    /** @brief Return the number of views a query of the generated trees needs at most */
+    size_t getNumViews() const {
+        return numViews;
+    }
+
     NodePtr visitConstant(const RamConstant& num) override {
         return std::make_unique<InterpreterNode>(I_Constant, &num);
     }
@@ -91,7 +116,10 @@ public:
         for (const auto& arg : op.getArguments()) {
             children.push_back(visit(arg));
         }
-        return std::make_unique<InterpreterNode>(I_UserDefinedOperator, &op, std::move(children));
+        auto res = std::make_unique<InterpreterNode>(I_UserDefinedOperator, &op, std::move(children));
+        res->setFunctor(std::make_unique<InterpreterFunctor>(
+                resolveFunctor(op.getName()), op.getArgsTypes(), op.getReturnType()));
+        return res;
     }
 
     NodePtr visitPackRecord(const RamPackRecord& pr) override {
@@ -130,8 +158,7 @@ public:
 
     NodePtr visitEmptinessCheck(const RamEmptinessCheck& emptiness) override {
         size_t relId = encodeRelation(emptiness.getRelation());
-        auto rel = relations[relId].get();
-        return std::make_unique<InterpreterNode>(I_EmptinessCheck, &emptiness, NodePtrVec{}, rel);
+        return std::make_unique<InterpreterNode>(I_EmptinessCheck, &emptiness, NodePtrVec{}, relId);
     }
 
     NodePtr visitExistenceCheck(const RamExistenceCheck& exists) override {
@@ -141,8 +168,12 @@ public:
         }
         std::vector<size_t> data;
         data.push_back(encodeView(&exists));
+        data.push_back(exists.getRelation().isTemp()
+                               ? InterpreterProfile::NO_COUNTER
+                               : profile.encodeCounter("@relation-reads;" + exists.getRelation().getName()));
         return std::make_unique<InterpreterNode>(
-                I_ExistenceCheck, &exists, std::move(children), nullptr, std::move(data));
+                I_ExistenceCheck, &exists, std::move(children), InterpreterNode::NO_RELATION,
+                std::move(data));
     }
 
     NodePtr visitProvenanceExistenceCheck(const RamProvenanceExistenceCheck& provExists) override {
@@ -153,7 +184,8 @@ public:
         std::vector<size_t> data;
         data.push_back(encodeView(&provExists));
         return std::make_unique<InterpreterNode>(
-                I_ProvenanceExistenceCheck, &provExists, std::move(children), nullptr, std::move(data));
+                I_ProvenanceExistenceCheck, &provExists, std::move(children),
+                InterpreterNode::NO_RELATION, std::move(data));
     }
 
     // -- comparison operators --
@@ -161,7 +193,15 @@ public:
         NodePtrVec children;
         children.push_back(visit(relOp.getLHS()));
         children.push_back(visit(relOp.getRHS()));
-        return std::make_unique<InterpreterNode>(I_Constraint, &relOp, std::move(children));
+        auto res = std::make_unique<InterpreterNode>(I_Constraint, &relOp, std::move(children));
+        // compile constant patterns once; dynamic patterns go through the cache of the engine
+        BinaryConstraintOp op = relOp.getOperator();
+        if (op == BinaryConstraintOp::MATCH || op == BinaryConstraintOp::NOT_MATCH) {
+            if (const auto* pattern = dynamic_cast<const RamSignedConstant*>(&relOp.getLHS())) {
+                res->setRegex(RegexCache::compile(symbolTable.resolve(pattern->getConstant())));
+            }
+        }
+        return res;
     }
 
     NodePtr visitNestedOperation(const RamNestedOperation& nested) override {
@@ -171,23 +211,24 @@ public:
     NodePtr visitTupleOperation(const RamTupleOperation& search) override {
         NodePtrVec children;
         children.push_back(visit(search.getOperation()));
-        return std::make_unique<InterpreterNode>(I_TupleOperation, &search, std::move(children));
+        std::vector<size_t> data;
+        data.push_back(encodeCounter(search.getProfileText()));
+        return std::make_unique<InterpreterNode>(I_TupleOperation, &search, std::move(children),
+                InterpreterNode::NO_RELATION, std::move(data));
     }
 
     NodePtr visitScan(const RamScan& scan) override {
         size_t relId = encodeRelation(scan.getRelation());
-        auto rel = relations[relId].get();
         NodePtrVec children;
         children.push_back(visitTupleOperation(scan));
-        return std::make_unique<InterpreterNode>(I_Scan, &scan, std::move(children), rel);
+        return std::make_unique<InterpreterNode>(I_Scan, &scan, std::move(children), relId);
     }
 
     NodePtr visitParallelScan(const RamParallelScan& pScan) override {
         size_t relId = encodeRelation(pScan.getRelation());
-        auto rel = relations[relId].get();
         NodePtrVec children;
         children.push_back(visitTupleOperation(pScan));
-        auto res = std::make_unique<InterpreterNode>(I_ParallelScan, &pScan, std::move(children), rel);
+        auto res = std::make_unique<InterpreterNode>(I_ParallelScan, &pScan, std::move(children), relId);
         res->setPreamble(parentQueryPreamble);
         return res;
     }
@@ -201,12 +242,11 @@ public:
         std::vector<size_t> data;
         data.push_back((encodeView(&scan)));
         return std::make_unique<InterpreterNode>(
-                I_IndexScan, &scan, std::move(children), nullptr, std::move(data));
+                I_IndexScan, &scan, std::move(children), InterpreterNode::NO_RELATION, std::move(data));
     }
 
     NodePtr visitParallelIndexScan(const RamParallelIndexScan& piscan) override {
         size_t relId = encodeRelation(piscan.getRelation());
-        auto rel = relations[relId].get();
         NodePtrVec children;
         for (const auto& value : piscan.getRangePattern()) {
             children.push_back(visit(value));
@@ -215,27 +255,25 @@ public:
         std::vector<size_t> data;
         data.push_back((encodeIndexPos(piscan)));
         auto res = std::make_unique<InterpreterNode>(
-                I_ParallelIndexScan, &piscan, std::move(children), rel, std::move(data));
+                I_ParallelIndexScan, &piscan, std::move(children), relId, std::move(data));
         res->setPreamble(parentQueryPreamble);
         return res;
     }
 
     NodePtr visitChoice(const RamChoice& choice) override {
         size_t relId = encodeRelation(choice.getRelation());
-        auto rel = relations[relId].get();
         NodePtrVec children;
         children.push_back(visit(choice.getCondition()));
         children.push_back(visitTupleOperation(choice));
-        return std::make_unique<InterpreterNode>(I_Choice, &choice, std::move(children), rel);
+        return std::make_unique<InterpreterNode>(I_Choice, &choice, std::move(children), relId);
     }
 
     NodePtr visitParallelChoice(const RamParallelChoice& pchoice) override {
         size_t relId = encodeRelation(pchoice.getRelation());
-        auto rel = relations[relId].get();
         NodePtrVec children;
         children.push_back(visit(pchoice.getCondition()));
         children.push_back(visitTupleOperation(pchoice));
-        auto res = std::make_unique<InterpreterNode>(I_ParallelChoice, &pchoice, std::move(children), rel);
+        auto res = std::make_unique<InterpreterNode>(I_ParallelChoice, &pchoice, std::move(children), relId);
         res->setPreamble(parentQueryPreamble);
         return res;
     }
@@ -250,12 +288,11 @@ public:
         std::vector<size_t> data;
         data.push_back((encodeView(&choice)));
         return std::make_unique<InterpreterNode>(
-                I_IndexChoice, &choice, std::move(children), nullptr, std::move(data));
+                I_IndexChoice, &choice, std::move(children), InterpreterNode::NO_RELATION, std::move(data));
     }
 
     NodePtr visitParallelIndexChoice(const RamParallelIndexChoice& ichoice) override {
         size_t relId = encodeRelation(ichoice.getRelation());
-        auto rel = relations[relId].get();
         NodePtrVec children;
         for (const auto& value : ichoice.getRangePattern()) {
             children.push_back(visit(value));
@@ -265,7 +302,7 @@ public:
         std::vector<size_t> data;
         data.push_back((encodeIndexPos(ichoice)));
         auto res = std::make_unique<InterpreterNode>(
-                I_ParallelIndexChoice, &ichoice, std::move(children), rel, std::move(data));
+                I_ParallelIndexChoice, &ichoice, std::move(children), relId, std::move(data));
         res->setPreamble(parentQueryPreamble);
         return res;
     }
@@ -279,17 +316,20 @@ public:
 
     NodePtr visitAggregate(const RamAggregate& aggregate) override {
         size_t relId = encodeRelation(aggregate.getRelation());
-        auto rel = relations[relId].get();
         NodePtrVec children;
         children.push_back(visit(aggregate.getCondition()));
         children.push_back(visit(aggregate.getExpression()));
         children.push_back(visitTupleOperation(aggregate));
-        return std::make_unique<InterpreterNode>(I_Aggregate, &aggregate, std::move(children), rel);
+        auto res = std::make_unique<InterpreterNode>(I_Aggregate, &aggregate, std::move(children), relId);
+        // outer-most aggregates may be evaluated in parallel, which requires the views of the query
+        if (aggregate.getTupleId() == 0) {
+            res->setPreamble(parentQueryPreamble);
+        }
+        return res;
     }
 
     NodePtr visitIndexAggregate(const RamIndexAggregate& aggregate) override {
         size_t relId = encodeRelation(aggregate.getRelation());
-        auto rel = relations[relId].get();
         NodePtrVec children;
         for (const auto& value : aggregate.getRangePattern()) {
             children.push_back(visit(value));
@@ -299,8 +339,14 @@ public:
         children.push_back(visitTupleOperation(aggregate));
         std::vector<size_t> data;
         data.push_back((encodeView(&aggregate)));
-        return std::make_unique<InterpreterNode>(
-                I_IndexAggregate, &aggregate, std::move(children), rel, std::move(data));
+        data.push_back((encodeIndexPos(aggregate)));
+        auto res = std::make_unique<InterpreterNode>(
+                I_IndexAggregate, &aggregate, std::move(children), relId, std::move(data));
+        // outer-most aggregates may be evaluated in parallel, which requires the views of the query
+        if (aggregate.getTupleId() == 0) {
+            res->setPreamble(parentQueryPreamble);
+        }
+        return res;
     }
 
     NodePtr visitBreak(const RamBreak& breakOp) override {
@@ -314,17 +360,20 @@ public:
         NodePtrVec children;
         children.push_back(visit(filter.getCondition()));
         children.push_back(visit(filter.getOperation()));
-        return std::make_unique<InterpreterNode>(I_Filter, &filter, std::move(children));
+        std::vector<size_t> data;
+        data.push_back(encodeCounter(filter.getProfileText()));
+        data.push_back(isBatchable(filter.getCondition()));
+        return std::make_unique<InterpreterNode>(
+                I_Filter, &filter, std::move(children), InterpreterNode::NO_RELATION, std::move(data));
     }
 
     NodePtr visitProject(const RamProject& project) override {
         size_t relId = encodeRelation(project.getRelation());
-        auto rel = relations[relId].get();
         NodePtrVec children;
         for (const auto& value : project.getValues()) {
             children.push_back(visit(value));
         }
-        return std::make_unique<InterpreterNode>(I_Project, &project, std::move(children), rel);
+        return std::make_unique<InterpreterNode>(I_Project, &project, std::move(children), relId);
     }
 
     // -- return from subroutine --
@@ -367,10 +416,9 @@ public:
 
     NodePtr visitLogRelationTimer(const RamLogRelationTimer& timer) override {
         size_t relId = encodeRelation(timer.getRelation());
-        auto rel = relations[relId].get();
         NodePtrVec children;
         children.push_back(visit(timer.getStatement()));
-        return std::make_unique<InterpreterNode>(I_LogRelationTimer, &timer, std::move(children), rel);
+        return std::make_unique<InterpreterNode>(I_LogRelationTimer, &timer, std::move(children), relId);
     }
 
     NodePtr visitLogTimer(const RamLogTimer& timer) override {
@@ -387,23 +435,31 @@ public:
 
     NodePtr visitClear(const RamClear& clear) override {
         size_t relId = encodeRelation(clear.getRelation());
-        auto rel = relations[relId].get();
-        return std::make_unique<InterpreterNode>(I_Clear, &clear, NodePtrVec{}, rel);
+        return std::make_unique<InterpreterNode>(I_Clear, &clear, NodePtrVec{}, relId);
     }
 
     NodePtr visitLogSize(const RamLogSize& size) override {
         size_t relId = encodeRelation(size.getRelation());
-        auto rel = relations[relId].get();
-        return std::make_unique<InterpreterNode>(I_LogSize, &size, NodePtrVec{}, rel);
+        return std::make_unique<InterpreterNode>(I_LogSize, &size, NodePtrVec{}, relId);
     }
 
     NodePtr visitIO(const RamIO& io) override {
         size_t relId = encodeRelation(io.getRelation());
-        auto rel = relations[relId].get();
-        return std::make_unique<InterpreterNode>(I_IO, &io, NodePtrVec{}, rel);
+        return std::make_unique<InterpreterNode>(I_IO, &io, NodePtrVec{}, relId);
     }
 
     NodePtr visitQuery(const RamQuery& query) override {
+        // merges insert all tuples of a relation in bulk
+        if (const RamRelation* source = query.getMergeSource()) {
+            const auto& scan = static_cast<const RamScan&>(query.getOperation());
+            const auto& project = static_cast<const RamProject&>(scan.getOperation());
+            std::vector<size_t> data;
+            data.push_back(encodeRelation(*source));
+            data.push_back(encodeRelation(project.getRelation()));
+            return std::make_unique<InterpreterNode>(
+                    I_Merge, &query, NodePtrVec{}, InterpreterNode::NO_RELATION, std::move(data));
+        }
+
         std::shared_ptr<InterpreterPreamble> preamble = std::make_shared<InterpreterPreamble>();
         parentQueryPreamble = preamble;
         // split terms of conditions of outer-most filter operation
@@ -449,6 +505,19 @@ public:
 
         auto res = std::make_unique<InterpreterNode>(I_Query, &query, std::move(children));
         res->setPreamble(parentQueryPreamble);
+
+        // generate the native body, which is compiled once the query turns out to be hot
+        if (isJit) {
+            InterpreterJitGenerator jitGenerator(isa, indexTable);
+            if (jitGenerator.generate(query)) {
+                std::vector<size_t> relIds;
+                for (const RamRelation* rel : jitGenerator.getRelations()) {
+                    relIds.push_back(encodeRelation(*rel));
+                }
+                res->setJitQuery(
+                        std::make_shared<InterpreterJitQuery>(jitGenerator.getSource(), std::move(relIds)));
+            }
+        }
         return res;
     }
 
@@ -456,14 +525,16 @@ public:
         std::vector<size_t> data;
         data.push_back((encodeRelation(extend.getFirstRelation())));
         data.push_back(encodeRelation(extend.getSecondRelation()));
-        return std::make_unique<InterpreterNode>(I_Extend, &extend, NodePtrVec{}, nullptr, std::move(data));
+        return std::make_unique<InterpreterNode>(
+                I_Extend, &extend, NodePtrVec{}, InterpreterNode::NO_RELATION, std::move(data));
     }
 
     NodePtr visitSwap(const RamSwap& swap) override {
         std::vector<size_t> data;
         data.push_back((encodeRelation(swap.getFirstRelation())));
         data.push_back((encodeRelation(swap.getSecondRelation())));
-        return std::make_unique<InterpreterNode>(I_Swap, &swap, NodePtrVec{}, nullptr, std::move(data));
+        return std::make_unique<InterpreterNode>(
+                I_Swap, &swap, NodePtrVec{}, InterpreterNode::NO_RELATION, std::move(data));
     }
 
     NodePtr visitUndefValue(const RamUndefValue&) override {
@@ -477,14 +548,14 @@ public:
     }
 
 public:
-    /** @brief Move relation map */
-    std::vector<std::unique_ptr<RelationHandle>>& getRelations() {
-        return relations;
-    }
-
-    /** @brief Return relation handle from given index */
-    RelationHandle& getRelationHandle(const size_t idx) {
-        return *relations[idx];
+    /** @brief Create a fresh, empty instance of every relation encoded so far */
+    std::vector<std::unique_ptr<RelationHandle>> createRelations() {
+        std::vector<std::unique_ptr<RelationHandle>> res(relations.size());
+        for (const auto& cur : relTable) {
+            res[cur.second] = std::make_unique<RelationHandle>(
+                    createRelation(*cur.first, isa->getIndexes(*cur.first)));
+        }
+        return res;
     }
 
 private:
@@ -492,6 +563,8 @@ private:
     std::unordered_map<const RamNode*, size_t> indexTable;
     /** Used by index encoding */
     RamIndexAnalysis* isa;
+    /** Used to compile constant patterns */
+    const SymbolTable& symbolTable;
     /** Points to the current preamble during the generation.  It is used to passing preamble between parent
      * query and its nested parallel operation. */
     std::shared_ptr<InterpreterPreamble> parentQueryPreamble = nullptr;
@@ -499,14 +572,24 @@ private:
     size_t viewId = 0;
     /** Next available location to encode a relation */
     size_t relId = 0;
+    /** Largest tuple id of the generated trees plus one */
+    size_t numTupleSlots = 0;
+    /** Largest number of views of a query of the generated trees */
+    size_t numViews = 0;
     /** Environment encoding, store a mapping from RamNode to its View id. */
     std::unordered_map<const RamNode*, size_t> viewTable;
     /** Environment encoding, store a mapping from RamRelation to its id */
     std::unordered_map<const RamRelation*, size_t> relTable;
-    /** Symbol table for relations */
-    std::vector<std::unique_ptr<RelationHandle>> relations;
+    /** Relations of the main environment, indexed by relation id */
+    std::vector<std::unique_ptr<RelationHandle>>& relations;
+    /** Counters of the profile */
+    InterpreterProfile& profile;
+    /** Look up the symbol of a user-defined operator in the functor libraries */
+    std::function<void*(const std::string&)> resolveFunctor;
     /** If generating a provenance program */
     const bool isProvenance;
+    /** If generating native bodies of queries for the tiered compilation */
+    const bool isJit;
 
     /** @brief Reset view allocation system, since view's life time is within each query. */
     void newQueryBlock() {
@@ -521,6 +604,7 @@ private:
 
     /** @brief Get a valid view id for encoding */
     size_t getNextViewId() {
+        numViews = std::max(numViews, viewId + 1);
         return viewId++;
     }
 
@@ -549,6 +633,14 @@ private:
         return id;
     }
 
+    /** @brief Return the profile counter of an operation, or NO_COUNTER if it has no profile text */
+    size_t encodeCounter(const std::string& profileText) {
+        if (profileText.empty()) {
+            return InterpreterProfile::NO_COUNTER;
+        }
+        return profile.encodeCounter(profileText);
+    }
+
     /** @brief Encode and create the relation, return the relation id */
     size_t encodeRelation(const RamRelation& rel) {
         auto pos = relTable.find(&rel);
@@ -557,7 +649,10 @@ private:
         }
         size_t id = getNewRelId();
         relTable[&rel] = id;
-        createRelation(rel, isa->getIndexes(rel), id);
+        if (relations.size() < id + 1) {
+            relations.resize(id + 1);
+        }
+        relations[id] = std::make_unique<RelationHandle>(createRelation(rel, isa->getIndexes(rel)));
         return id;
     }
 
@@ -600,6 +695,77 @@ private:
         assert(false && "The RamNode does not require a view.");
     }
 
+    /**
+     * @brief Check whether a condition can be evaluated over a batch of tuples at once,
+     *        i.e., it is a conjunction of numeric comparisons of batchable expressions.
+     */
+    bool isBatchable(const RamCondition& condition) {
+        if (dynamic_cast<const RamTrue*>(&condition) != nullptr ||
+                dynamic_cast<const RamFalse*>(&condition) != nullptr) {
+            return true;
+        } else if (const auto* conj = dynamic_cast<const RamConjunction*>(&condition)) {
+            return isBatchable(conj->getLHS()) && isBatchable(conj->getRHS());
+        } else if (const auto* constraint = dynamic_cast<const RamConstraint*>(&condition)) {
+            switch (constraint->getOperator()) {
+                case BinaryConstraintOp::EQ:
+                case BinaryConstraintOp::FEQ:
+                case BinaryConstraintOp::NE:
+                case BinaryConstraintOp::FNE:
+                case BinaryConstraintOp::LT:
+                case BinaryConstraintOp::ULT:
+                case BinaryConstraintOp::FLT:
+                case BinaryConstraintOp::LE:
+                case BinaryConstraintOp::ULE:
+                case BinaryConstraintOp::FLE:
+                case BinaryConstraintOp::GT:
+                case BinaryConstraintOp::UGT:
+                case BinaryConstraintOp::FGT:
+                case BinaryConstraintOp::GE:
+                case BinaryConstraintOp::UGE:
+                case BinaryConstraintOp::FGE:
+                    return isBatchable(constraint->getLHS()) && isBatchable(constraint->getRHS());
+                default:
+                    return false;
+            }
+        }
+        return false;
+    }
+
+    /**
+     * @brief Check whether an expression can be evaluated over a batch of tuples at once,
+     *        i.e., it consists of constants, tuple elements and arithmetic which cannot fail.
+     */
+    bool isBatchable(const RamExpression& expression) {
+        if (dynamic_cast<const RamConstant*>(&expression) != nullptr ||
+                dynamic_cast<const RamTupleElement*>(&expression) != nullptr) {
+            return true;
+        } else if (const auto* op = dynamic_cast<const RamIntrinsicOperator*>(&expression)) {
+            switch (op->getOperator()) {
+                case FunctorOp::NEG:
+                case FunctorOp::FNEG:
+                case FunctorOp::ADD:
+                case FunctorOp::UADD:
+                case FunctorOp::FADD:
+                case FunctorOp::SUB:
+                case FunctorOp::USUB:
+                case FunctorOp::FSUB:
+                case FunctorOp::MUL:
+                case FunctorOp::UMUL:
+                case FunctorOp::FMUL:
+                    break;
+                default:
+                    return false;
+            }
+            for (const auto& arg : op->getArguments()) {
+                if (!isBatchable(*arg)) {
+                    return false;
+                }
+            }
+            return true;
+        }
+        return false;
+    }
+
     /**
      * @brief Convert terms of a conjunction to a list
      *
@@ -625,11 +791,9 @@ private:
         return conditionList;
     }
 
-    void createRelation(const RamRelation& id, const MinIndexSelection& orderSet, const size_t idx) {
+    /** @brief Create an empty relation */
+    RelationHandle createRelation(const RamRelation& id, const MinIndexSelection& orderSet) {
         RelationHandle res;
-        if (relations.size() < idx + 1) {
-            relations.resize(idx + 1);
-        }
         if (id.getRepresentation() == RelationRepresentation::EQREL) {
             res = std::make_unique<InterpreterEqRelation>(id.getArity(), id.getAuxiliaryArity(), id.getName(),
                     std::vector<std::string>(), orderSet);
@@ -637,12 +801,15 @@ private:
             if (isProvenance) {
                 res = std::make_unique<InterpreterRelation>(id.getArity(), id.getAuxiliaryArity(),
                         id.getName(), std::vector<std::string>(), orderSet, createBTreeProvenanceIndex);
+            } else if (id.getRepresentation() == RelationRepresentation::SORTED) {
+                res = std::make_unique<InterpreterRelation>(id.getArity(), id.getAuxiliaryArity(),
+                        id.getName(), std::vector<std::string>(), orderSet, createSortedArrayIndex);
             } else {
                 res = std::make_unique<InterpreterRelation>(id.getArity(), id.getAuxiliaryArity(),
                         id.getName(), std::vector<std::string>(), orderSet);
             }
         }
-        relations[idx] = std::make_unique<RelationHandle>(std::move(res));
+        return res;
     }
 };
 }  // namespace souffle
@@ -17,9 +17,15 @@
 #include "InterpreterIndex.h"
 #include "Brie.h"
 #include "CompiledIndexUtils.h"
+#include "DynBTree.h"
 #include "EquivalenceRelation.h"
+#include "HashSet.h"
+#include "SortedArray.h"
 #include "Util.h"
+#include <algorithm>
 #include <atomic>
+#include <mutex>
+#include <numeric>
 
 namespace souffle {
 
@@ -582,8 +588,46 @@ struct InterpreterProvenanceUpdater {
  */
 template <std::size_t Arity>
 class BTreeIndex : public GenericIndex<btree_set<t_tuple<Arity>, comparator<Arity>>> {
+    using Base = GenericIndex<btree_set<t_tuple<Arity>, comparator<Arity>>>;
+
 public:
-    using GenericIndex<btree_set<t_tuple<Arity>, comparator<Arity>>>::GenericIndex;
+    using Base::Base;
+
+    void insert(const InterpreterIndex& src) override {
+        // trees of the same order are merged in bulk
+        auto other = dynamic_cast<const BTreeIndex*>(&src);
+        if (other != nullptr && other->order == this->order) {
+            this->data.insertAll(other->data);
+        } else {
+            Base::insert(src);
+        }
+    }
+
+    void insertAll(const RamDomain* tuples, std::size_t count) override {
+        // the sorted sequence is merged in bulk, an empty tree is built bottom-up from it
+        std::vector<t_tuple<Arity>> entries = encode(tuples, count);
+        this->data.insertAll(entries.begin(), entries.end());
+    }
+
+    void merge(const RamDomain* tuples, std::size_t count) override {
+        // inserting in order lets the operation hints skip most of the descents
+        std::vector<t_tuple<Arity>> entries = encode(tuples, count);
+        this->data.insert(entries.begin(), entries.end());
+    }
+
+private:
+    /** Encode tuples into the order of this index, sorted and without duplicates */
+    std::vector<t_tuple<Arity>> encode(const RamDomain* tuples, std::size_t count) const {
+        std::vector<t_tuple<Arity>> entries(count);
+        for (std::size_t i = 0; i < count; ++i) {
+            entries[i] = this->order.encode(TupleRef(tuples + i * Arity, Arity).template asTuple<Arity>());
+        }
+        if (!std::is_sorted(entries.begin(), entries.end())) {
+            std::sort(entries.begin(), entries.end());
+        }
+        entries.erase(std::unique(entries.begin(), entries.end()), entries.end());
+        return entries;
+    }
 };
 
 /**
@@ -594,10 +638,22 @@ class BTreeProvenanceIndex
         : public GenericIndex<btree_set<t_tuple<Arity>, comparator<Arity>, std::allocator<t_tuple<Arity>>,
                   256, typename detail::default_strategy<t_tuple<Arity>>::type, comparator<Arity - 2>,
                   InterpreterProvenanceUpdater<Arity>>> {
+    using Base = GenericIndex<btree_set<t_tuple<Arity>, comparator<Arity>, std::allocator<t_tuple<Arity>>,
+            256, typename detail::default_strategy<t_tuple<Arity>>::type, comparator<Arity - 2>,
+            InterpreterProvenanceUpdater<Arity>>>;
+
 public:
-    using GenericIndex<btree_set<t_tuple<Arity>, comparator<Arity>, std::allocator<t_tuple<Arity>>, 256,
-            typename detail::default_strategy<t_tuple<Arity>>::type, comparator<Arity - 2>,
-            InterpreterProvenanceUpdater<Arity>>>::GenericIndex;
+    using Base::Base;
+
+    void insert(const InterpreterIndex& src) override {
+        // trees of the same order are merged in bulk, keeping the smaller provenance annotations
+        auto other = dynamic_cast<const BTreeProvenanceIndex*>(&src);
+        if (other != nullptr && other->order == this->order) {
+            this->data.insertAll(other->data);
+        } else {
+            Base::insert(src);
+        }
+    }
 };
 
 /**
@@ -609,6 +665,39 @@ public:
     using GenericIndex<Trie<Arity>>::GenericIndex;
 };
 
+/**
+ * A sorted array index, using the generic index adapter. Inserted tuples are
+ * sorted into the array when the index is sealed or first read.
+ */
+template <std::size_t Arity>
+class SortedArrayIndex : public GenericIndex<sorted_array<t_tuple<Arity>, comparator<Arity>>> {
+    using Base = GenericIndex<sorted_array<t_tuple<Arity>, comparator<Arity>>>;
+
+public:
+    using Base::Base;
+
+    void insert(const InterpreterIndex& src) override {
+        std::vector<t_tuple<Arity>> entries;
+        entries.reserve(src.size());
+        for (const auto& cur : src.scan()) {
+            entries.push_back(this->order.encode(cur.template asTuple<Arity>()));
+        }
+        this->data.insertAll(entries.begin(), entries.end());
+    }
+
+    void insertAll(const RamDomain* tuples, std::size_t count) override {
+        std::vector<t_tuple<Arity>> entries(count);
+        for (std::size_t i = 0; i < count; ++i) {
+            entries[i] = this->order.encode(TupleRef(tuples + i * Arity, Arity).template asTuple<Arity>());
+        }
+        this->data.insertAll(entries.begin(), entries.end());
+    }
+
+    void seal() override {
+        this->data.seal();
+    }
+};
+
 /**
  * A index adapter for EquivalenceRelation, using the generic index adapter.
  */
@@ -623,6 +712,455 @@ public:
     }
 };
 
+/**
+ * An index adapter for hash sets, keyed on the first attributes of the index order.
+ * Ranges are answered for bounds agreeing on all key attributes and leaving the
+ * other attributes unbound, i.e., for the searches the key has been chosen for.
+ */
+template <std::size_t Arity>
+class HashIndex : public InterpreterIndex {
+    using Entry = t_tuple<Arity>;
+
+    // hashes the key of an entry
+    struct KeyHash {
+        std::size_t keyLength;
+
+        std::size_t operator()(const Entry& entry) const {
+            std::hash<RamDomain> hash;
+            std::size_t res = 0;
+            for (std::size_t i = 0; i < keyLength; ++i) {
+                // from boost hash combine
+                res ^= hash(entry[i]) + 0x9e3779b9 + (res << 6) + (res >> 2);
+            }
+            return res;
+        }
+    };
+
+    // compares the keys of entries
+    struct KeyEqual {
+        std::size_t keyLength;
+
+        bool equal(const Entry& a, const Entry& b) const {
+            for (std::size_t i = 0; i < keyLength; ++i) {
+                if (a[i] != b[i]) {
+                    return false;
+                }
+            }
+            return true;
+        }
+    };
+
+    using Structure = hash_set<Entry, KeyHash, KeyEqual>;
+    using Hints = typename Structure::operation_hints;
+    using iter = typename Structure::iterator;
+
+    // a source adapter for streaming through data
+    class Source : public Stream::Source {
+        const Order& order;
+
+        // the begin and end of the stream
+        iter cur;
+        iter end;
+
+        // an internal buffer for re-ordered elements
+        std::array<Entry, Stream::BUFFER_SIZE> buffer;
+
+    public:
+        Source(const Order& order, iter begin, iter end)
+                : order(order), cur(std::move(begin)), end(std::move(end)) {}
+
+        int load(TupleRef* out, int max) override {
+            int c = 0;
+            while (cur != end && c < max) {
+                buffer[c] = order.decode(*cur);
+                out[c] = buffer[c];
+                ++cur;
+                ++c;
+            }
+            return c;
+        }
+
+        int reload(TupleRef* out, int max) override {
+            int c = 0;
+            max = std::min(max, Stream::BUFFER_SIZE);
+            while (c < max) {
+                out[c] = buffer[c];
+                ++c;
+            }
+            return c;
+        }
+
+        std::unique_ptr<Stream::Source> clone() override {
+            auto source = std::make_unique<Source>(order, cur, end);
+            source->buffer = this->buffer;
+            return source;
+        }
+    };
+
+    // The index view associated to this index type; hash sets take no hints.
+    struct HashIndexView : public IndexView {
+        const HashIndex& index;
+
+        HashIndexView(const HashIndex& index) : index(index) {}
+
+        bool contains(const TupleRef& tuple) const override {
+            return index.contains(tuple);
+        }
+
+        bool contains(const TupleRef& low, const TupleRef& high) const override {
+            return index.contains(low, high);
+        }
+
+        Stream range(const TupleRef& low, const TupleRef& high) const override {
+            return index.range(low, high);
+        }
+
+        size_t getArity() const override {
+            return Arity;
+        }
+    };
+
+    souffle::range<iter> bounds(const TupleRef& low, const TupleRef& high) const {
+        Entry a = order.encode(low.asTuple<Arity>());
+        assert(KeyEqual{keyLength}.equal(a, order.encode(high.asTuple<Arity>())) &&
+                "hash index searched without its key");
+        return data.equal_range(a);
+    }
+
+    // the order to be simulated
+    Order order;
+
+    // the number of leading attributes of the order forming the key
+    std::size_t keyLength;
+
+    // the internal data structure
+    Structure data;
+
+public:
+    HashIndex(Order order, std::size_t keyLength)
+            : order(std::move(order)), keyLength(keyLength), data(KeyHash{keyLength}, KeyEqual{keyLength}) {}
+
+    IndexViewPtr createView() const override {
+        return std::make_unique<HashIndexView>(*this);
+    }
+
+    size_t getArity() const override {
+        return Arity;
+    }
+
+    bool empty() const override {
+        return data.empty();
+    }
+
+    std::size_t size() const override {
+        return data.size();
+    }
+
+    bool insert(const TupleRef& tuple) override {
+        return data.insert(order.encode(tuple.asTuple<Arity>()));
+    }
+
+    void insert(const InterpreterIndex& src) override {
+        data.reserve(size() + src.size());
+        for (const auto& cur : src.scan()) {
+            insert(cur);
+        }
+    }
+
+    void insertAll(const RamDomain* tuples, std::size_t count) override {
+        data.reserve(size() + count);
+        InterpreterIndex::insertAll(tuples, count);
+    }
+
+    bool contains(const TupleRef& tuple) const override {
+        return data.contains(order.encode(tuple.asTuple<Arity>()));
+    }
+
+    bool contains(const TupleRef& low, const TupleRef& high) const override {
+        return !bounds(low, high).empty();
+    }
+
+    Stream scan() const override {
+        return std::make_unique<Source>(order, data.begin(), data.end());
+    }
+
+    PartitionedStream partitionScan(int partitionCount) const override {
+        auto chunks = data.partition(partitionCount);
+        std::vector<Stream> res;
+        res.reserve(chunks.size());
+        for (const auto& cur : chunks) {
+            res.push_back(std::make_unique<Source>(order, cur.begin(), cur.end()));
+        }
+        return res;
+    }
+
+    Stream range(const TupleRef& low, const TupleRef& high) const override {
+        auto range = bounds(low, high);
+        return std::make_unique<Source>(order, range.begin(), range.end());
+    }
+
+    PartitionedStream partitionRange(
+            const TupleRef& low, const TupleRef& high, int partitionCount) const override {
+        auto range = bounds(low, high);
+        std::vector<Stream> res;
+        res.reserve(partitionCount);
+        for (const auto& cur : range.partition(partitionCount)) {
+            res.push_back(std::make_unique<Source>(order, cur.begin(), cur.end()));
+        }
+        return res;
+    }
+
+    void clear() override {
+        data.clear();
+    }
+};
+
+/**
+ * An index adapter for B-trees whose arity is a runtime parameter, serving
+ * relations wider than the arities the templated indexes are instantiated for.
+ * If the given key is shorter than the order, the remaining attributes are
+ * updated as by provenance B-trees.
+ */
+class DynBTreeIndex : public InterpreterIndex {
+    using Hints = DynBTree::operation_hints;
+    using iter = DynBTree::iterator;
+
+    // a source adapter for streaming through data
+    class Source : public Stream::Source {
+        const DynBTreeIndex& index;
+
+        // the begin and end of the stream
+        iter cur;
+        iter end;
+
+        // an internal buffer for re-ordered elements, of BUFFER_SIZE tuples; not initialized
+        std::unique_ptr<RamDomain[]> buffer;
+
+    public:
+        Source(const DynBTreeIndex& index, iter begin, iter end)
+                : index(index), cur(std::move(begin)), end(std::move(end)),
+                  buffer(new RamDomain[Stream::BUFFER_SIZE * index.arity]) {}
+
+        int load(TupleRef* out, int max) override {
+            const std::size_t arity = index.arity;
+            int c = 0;
+            while (cur != end && c < max) {
+                RamDomain* tuple = &buffer[c * arity];
+                index.decode(*cur, tuple);
+                out[c] = TupleRef(tuple, arity);
+                ++cur;
+                ++c;
+            }
+            return c;
+        }
+
+        int reload(TupleRef* out, int max) override {
+            int c = 0;
+            max = std::min(max, Stream::BUFFER_SIZE);
+            while (c < max) {
+                out[c] = TupleRef(&buffer[c * index.arity], index.arity);
+                ++c;
+            }
+            return c;
+        }
+
+        std::unique_ptr<Stream::Source> clone() override {
+            auto source = std::make_unique<Source>(index, cur, end);
+            std::copy(buffer.get(), buffer.get() + Stream::BUFFER_SIZE * index.arity, source->buffer.get());
+            return source;
+        }
+    };
+
+    // The index view associated to this index type.
+    struct DynBTreeIndexView : public IndexView {
+        const DynBTreeIndex& index;
+        mutable Hints hints;
+
+        DynBTreeIndexView(const DynBTreeIndex& index) : index(index) {}
+
+        bool contains(const TupleRef& tuple) const override {
+            RamDomain entry[index.arity];
+            index.encode(tuple, entry);
+            return index.data.contains(entry, hints);
+        }
+
+        bool contains(const TupleRef& low, const TupleRef& high) const override {
+            return !index.bounds(low, high, hints).empty();
+        }
+
+        Stream range(const TupleRef& low, const TupleRef& high) const override {
+            auto range = index.bounds(low, high, hints);
+            return std::make_unique<Source>(index, range.begin(), range.end());
+        }
+
+        size_t getArity() const override {
+            return index.arity;
+        }
+    };
+
+    void encode(const TupleRef& tuple, RamDomain* entry) const {
+        assert(tuple.size() == arity);
+        for (std::size_t i = 0; i < arity; ++i) {
+            entry[i] = tuple[order[i]];
+        }
+    }
+
+    void decode(const RamDomain* entry, RamDomain* tuple) const {
+        for (std::size_t i = 0; i < arity; ++i) {
+            tuple[order[i]] = entry[i];
+        }
+    }
+
+    souffle::range<iter> bounds(const TupleRef& low, const TupleRef& high, Hints& hints) const {
+        RamDomain a[arity];
+        RamDomain b[arity];
+        encode(low, a);
+        encode(high, b);
+        return {data.lower_bound(a, hints), data.upper_bound(b, hints)};
+    }
+
+    /** Encode tuples into the order of this index, sorted and without duplicate keys */
+    std::vector<RamDomain> encode(const RamDomain* tuples, std::size_t count) const {
+        std::vector<RamDomain> entries(count * arity);
+        for (std::size_t i = 0; i < count; ++i) {
+            encode(TupleRef(tuples + i * arity, arity), &entries[i * arity]);
+        }
+        auto less = [&](std::size_t x, std::size_t y) {
+            return std::lexicographical_compare(&entries[x * arity], &entries[x * arity] + arity,
+                    &entries[y * arity], &entries[y * arity] + arity);
+        };
+        std::vector<std::size_t> positions(count);
+        std::iota(positions.begin(), positions.end(), 0);
+        if (!std::is_sorted(positions.begin(), positions.end(), less)) {
+            std::sort(positions.begin(), positions.end(), less);
+        }
+
+        // of tuples sharing a key, the smallest one is kept
+        std::vector<RamDomain> res;
+        res.reserve(entries.size());
+        for (std::size_t pos : positions) {
+            const RamDomain* entry = &entries[pos * arity];
+            if (res.empty() || !std::equal(entry, entry + keyArity, res.end() - arity)) {
+                res.insert(res.end(), entry, entry + arity);
+            }
+        }
+        return res;
+    }
+
+    // the order to be simulated
+    const std::vector<int> order;
+
+    const std::size_t arity;
+    const std::size_t keyArity;
+
+    // the internal data structure
+    DynBTree data;
+
+    // inserts are serialized, they may come from several threads; this lock is the limit on
+    // parallel inserts into wide relations, hence bulk inserts take it once per batch
+    std::mutex insertLock;
+
+    // the leaf of the last insert
+    Hints insertHints;
+
+public:
+    DynBTreeIndex(const Order& order, std::size_t keyArity)
+            : order(order.getOrder()), arity(order.size()), keyArity(keyArity), data(arity, keyArity) {}
+
+    IndexViewPtr createView() const override {
+        return std::make_unique<DynBTreeIndexView>(*this);
+    }
+
+    size_t getArity() const override {
+        return arity;
+    }
+
+    bool empty() const override {
+        return data.empty();
+    }
+
+    std::size_t size() const override {
+        return data.size();
+    }
+
+    bool insert(const TupleRef& tuple) override {
+        RamDomain entry[arity];
+        encode(tuple, entry);
+        std::lock_guard<std::mutex> guard(insertLock);
+        return data.insert(entry, insertHints);
+    }
+
+    void insert(const InterpreterIndex& src) override {
+        // the entries of a tree of the same layout are sorted already
+        auto other = dynamic_cast<const DynBTreeIndex*>(&src);
+        if (other == nullptr || other->order != order || other->keyArity != keyArity) {
+            for (const auto& cur : src.scan()) {
+                insert(cur);
+            }
+            return;
+        }
+        std::vector<RamDomain> entries;
+        entries.reserve(other->data.size() * arity);
+        for (const RamDomain* entry : other->data) {
+            entries.insert(entries.end(), entry, entry + arity);
+        }
+        std::lock_guard<std::mutex> guard(insertLock);
+        data.insertSorted(entries.data(), entries.size() / arity);
+    }
+
+    void insertAll(const RamDomain* tuples, std::size_t count) override {
+        // an empty tree is built bottom-up from the sorted sequence
+        std::vector<RamDomain> entries = encode(tuples, count);
+        std::lock_guard<std::mutex> guard(insertLock);
+        data.insertSorted(entries.data(), entries.size() / arity);
+    }
+
+    void merge(const RamDomain* tuples, std::size_t count) override {
+        insertAll(tuples, count);
+    }
+
+    bool contains(const TupleRef& tuple) const override {
+        return DynBTreeIndexView(*this).contains(tuple);
+    }
+
+    bool contains(const TupleRef& low, const TupleRef& high) const override {
+        return DynBTreeIndexView(*this).contains(low, high);
+    }
+
+    Stream scan() const override {
+        return std::make_unique<Source>(*this, data.begin(), data.end());
+    }
+
+    PartitionedStream partitionScan(int partitionCount) const override {
+        std::vector<Stream> res;
+        for (const auto& cur : data.getChunks(partitionCount)) {
+            res.push_back(std::make_unique<Source>(*this, cur.begin(), cur.end()));
+        }
+        return res;
+    }
+
+    Stream range(const TupleRef& low, const TupleRef& high) const override {
+        return DynBTreeIndexView(*this).range(low, high);
+    }
+
+    PartitionedStream partitionRange(
+            const TupleRef& low, const TupleRef& high, int partitionCount) const override {
+        Hints hints;
+        auto range = bounds(low, high, hints);
+        std::vector<Stream> res;
+        for (const auto& cur : data.getChunks(range.begin(), range.end(), partitionCount)) {
+            res.push_back(std::make_unique<Source>(*this, cur.begin(), cur.end()));
+        }
+        return res;
+    }
+
+    void clear() override {
+        std::lock_guard<std::mutex> guard(insertLock);
+        data.clear();
+        insertHints = Hints();
+    }
+};
+
 std::unique_ptr<InterpreterIndex> createBTreeIndex(const Order& order) {
     switch (order.size()) {
         case 0:
@@ -652,8 +1190,8 @@ std::unique_ptr<InterpreterIndex> createBTreeIndex(const Order& order) {
         case 12:
             return std::make_unique<BTreeIndex<12>>(order);
     }
-    assert(false && "Requested arity not yet supported. Feel free to add it.");
-    return {};
+    // wider relations are stored with a runtime arity
+    return createDynBTreeIndex(order);
 }
 
 std::unique_ptr<InterpreterIndex> createBTreeProvenanceIndex(const Order& order) {
@@ -688,8 +1226,8 @@ std::unique_ptr<InterpreterIndex> createBTreeProvenanceIndex(const Order& order)
         case 14:
             return std::make_unique<BTreeProvenanceIndex<14>>(order);
     }
-    assert(false && "Requested arity not yet supported. Feel free to add it.");
-    return {};
+    // wider relations are stored with a runtime arity, keyed on all but the provenance attributes
+    return std::make_unique<DynBTreeIndex>(order, order.size() - 2);
 }
 
 std::unique_ptr<InterpreterIndex> createBrieIndex(const Order& order) {
@@ -721,10 +1259,80 @@ std::unique_ptr<InterpreterIndex> createBrieIndex(const Order& order) {
         case 12:
             return std::make_unique<BrieIndex<12>>(order);
     }
+    // there is no trie of runtime arity; a B-tree serves the same searches
+    return createDynBTreeIndex(order);
+}
+
+std::unique_ptr<InterpreterIndex> createSortedArrayIndex(const Order& order) {
+    switch (order.size()) {
+        case 0:
+            return std::make_unique<NullaryIndex>();
+        case 1:
+            return std::make_unique<SortedArrayIndex<1>>(order);
+        case 2:
+            return std::make_unique<SortedArrayIndex<2>>(order);
+        case 3:
+            return std::make_unique<SortedArrayIndex<3>>(order);
+        case 4:
+            return std::make_unique<SortedArrayIndex<4>>(order);
+        case 5:
+            return std::make_unique<SortedArrayIndex<5>>(order);
+        case 6:
+            return std::make_unique<SortedArrayIndex<6>>(order);
+        case 7:
+            return std::make_unique<SortedArrayIndex<7>>(order);
+        case 8:
+            return std::make_unique<SortedArrayIndex<8>>(order);
+        case 9:
+            return std::make_unique<SortedArrayIndex<9>>(order);
+        case 10:
+            return std::make_unique<SortedArrayIndex<10>>(order);
+        case 11:
+            return std::make_unique<SortedArrayIndex<11>>(order);
+        case 12:
+            return std::make_unique<SortedArrayIndex<12>>(order);
+    }
+    // wider relations are stored with a runtime arity
+    return createDynBTreeIndex(order);
+}
+
+std::unique_ptr<InterpreterIndex> createHashIndex(const Order& order, std::size_t keyLength) {
+    assert(keyLength > 0 && keyLength <= order.size() && "Invalid key of hash index");
+    switch (order.size()) {
+        case 1:
+            return std::make_unique<HashIndex<1>>(order, keyLength);
+        case 2:
+            return std::make_unique<HashIndex<2>>(order, keyLength);
+        case 3:
+            return std::make_unique<HashIndex<3>>(order, keyLength);
+        case 4:
+            return std::make_unique<HashIndex<4>>(order, keyLength);
+        case 5:
+            return std::make_unique<HashIndex<5>>(order, keyLength);
+        case 6:
+            return std::make_unique<HashIndex<6>>(order, keyLength);
+        case 7:
+            return std::make_unique<HashIndex<7>>(order, keyLength);
+        case 8:
+            return std::make_unique<HashIndex<8>>(order, keyLength);
+        case 9:
+            return std::make_unique<HashIndex<9>>(order, keyLength);
+        case 10:
+            return std::make_unique<HashIndex<10>>(order, keyLength);
+        case 11:
+            return std::make_unique<HashIndex<11>>(order, keyLength);
+        case 12:
+            return std::make_unique<HashIndex<12>>(order, keyLength);
+    }
     assert(false && "Requested arity not yet supported. Feel free to add it.");
     return {};
 }
 
+std::unique_ptr<InterpreterIndex> createDynBTreeIndex(const Order& order) {
+    assert(order.size() != 0 && "DynBTreeIndex does not work with nullary relation\n");
+    return std::make_unique<DynBTreeIndex>(order, order.size());
+}
+
 std::unique_ptr<InterpreterIndex> createIndirectIndex(const Order& order) {
     assert(order.size() != 0 && "IndirectIndex does not work with nullary relation\n");
     return std::make_unique<IndirectIndex>(order.getOrder());
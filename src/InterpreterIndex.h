@@ -318,6 +318,26 @@ public:
         return Iterator();
     }
 
+    /**
+     * Consumes the remaining elements of the current chunk, retrieving
+     * the next chunk from the source if the current one is exhausted.
+     * Batched evaluation processes a stream this way rather than by iterators.
+     *
+     * @return the number of elements addressed by the first parameter, 0 if end has reached.
+     */
+    int nextBatch(const TupleRef*& batch) {
+        if (cur >= limit) {
+            if (source == nullptr) {
+                return 0;
+            }
+            loadNext();
+        }
+        batch = &buffer[cur];
+        int count = limit - cur;
+        cur = limit;
+        return count;
+    }
+
 private:
     /**
      * Retrieves the next chunk of elements from the source.
@@ -351,6 +371,14 @@ public:
     iterator end() {
         return streams.end();
     }
+
+    std::size_t size() const {
+        return streams.size();
+    }
+
+    Stream& operator[](std::size_t i) {
+        return streams[i];
+    }
 };
 
 /**
@@ -419,10 +447,40 @@ public:
     virtual bool insert(const TupleRef& tuple) = 0;
 
     /**
-     * Inserts all elements of the given index.
+     * Inserts all elements of the given index. Indexes of the same kind and
+     * order may be merged in bulk; not to be called concurrently with other
+     * operations on this index.
      */
     virtual void insert(const InterpreterIndex& src) = 0;
 
+    /**
+     * Inserts a row-major buffer of the given number of tuples.
+     * Indexes may be rebuilt in bulk from the sorted buffer.
+     */
+    virtual void insertAll(const RamDomain* tuples, std::size_t count) {
+        const std::size_t arity = getArity();
+        for (std::size_t i = 0; i < count; ++i) {
+            insert(TupleRef(tuples + i * arity, arity));
+        }
+    }
+
+    /**
+     * Inserts a row-major buffer of the given number of tuples while other
+     * threads may access this index. Sorted buffers are inserted fastest.
+     */
+    virtual void merge(const RamDomain* tuples, std::size_t count) {
+        const std::size_t arity = getArity();
+        for (std::size_t i = 0; i < count; ++i) {
+            insert(TupleRef(tuples + i * arity, arity));
+        }
+    }
+
+    /**
+     * Completes the insertions so far. Indexes deferring the organisation of
+     * inserted tuples until they are read do so now; other indexes ignore it.
+     */
+    virtual void seal() {}
+
     /**
      * Tests whether the given tuple is present in this index or not.
      */
@@ -483,6 +541,19 @@ std::unique_ptr<InterpreterIndex> createBTreeProvenanceIndex(const Order&);
 // A factory for Brie based index.
 std::unique_ptr<InterpreterIndex> createBrieIndex(const Order&);
 
+// The largest arity of relations hash indexes are available for.
+constexpr std::size_t MAX_HASH_INDEX_ARITY = 12;
+
+// A factory for hash index, keyed on the given number of leading attributes of the order.
+std::unique_ptr<InterpreterIndex> createHashIndex(const Order&, std::size_t keyLength);
+
+// A factory for BTree based index of any arity, with tuples of runtime arity.
+// Unlike the B-trees of fixed arity, its inserts are serialized by a single lock.
+std::unique_ptr<InterpreterIndex> createDynBTreeIndex(const Order&);
+
+// A factory for sorted array based index, for relations which are read-only after loading.
+std::unique_ptr<InterpreterIndex> createSortedArrayIndex(const Order&);
+
 // A factory for indirect index.
 std::unique_ptr<InterpreterIndex> createIndirectIndex(const Order&);
 
@@ -0,0 +1,173 @@
+/*
+ * Souffle - A Datalog Compiler
+ * Copyright (c) 2019, The Souffle Developers. All rights reserved.
+ * Licensed under the Universal Permissive License v 1.0 as shown at:
+ * - https://opensource.org/licenses/UPL
+ * - <souffle root>/licenses/SOUFFLE-UPL.txt
+ */
+
+/************************************************************************
+ *
+ * @file InterpreterInsertBuffer.h
+ *
+ * Declares the InterpreterInsertBuffer class.
+ * Threads of a parallel loop collect the tuples they project in their own
+ * buffer instead of inserting them into the shared relations one by one.
+ * At the end of the loop the sorted runs of all threads are merged and
+ * inserted in bulk.
+ ***********************************************************************/
+
+#pragma once
+
+#include "InterpreterEnvironment.h"
+#include "ParallelUtils.h"
+#include "RamTypes.h"
+#include <algorithm>
+#include <cstddef>
+#include <map>
+#include <numeric>
+#include <queue>
+#include <utility>
+#include <vector>
+
+namespace souffle {
+
+/**
+ * @class InterpreterInsertBuffer
+ * @brief Tuples projected by one thread, grouped by target relation
+ */
+class InterpreterInsertBuffer {
+public:
+    /** @brief Append a tuple for the relation with the given id */
+    void insert(size_t relId, const RamDomain* tuple, size_t arity) {
+        Run& run = runs[relId];
+        run.arity = arity;
+        run.tuples.insert(run.tuples.end(), tuple, tuple + arity);
+    }
+
+    /** @brief Check whether no tuple has been buffered */
+    bool empty() const {
+        return runs.empty();
+    }
+
+    /** @brief Sort the tuples of each relation and remove duplicates */
+    void sort() {
+        for (auto& cur : runs) {
+            Run& run = cur.second;
+            const size_t arity = run.arity;
+            const RamDomain* tuples = run.tuples.data();
+
+            std::vector<size_t> positions(run.size());
+            std::iota(positions.begin(), positions.end(), 0);
+            std::sort(positions.begin(), positions.end(),
+                    [&](size_t a, size_t b) { return run.less(tuples + a * arity, tuples + b * arity); });
+
+            std::vector<RamDomain> sorted;
+            sorted.reserve(run.tuples.size());
+            for (size_t pos : positions) {
+                const RamDomain* tuple = tuples + pos * arity;
+                if (sorted.empty() || !std::equal(tuple, tuple + arity, sorted.end() - arity)) {
+                    sorted.insert(sorted.end(), tuple, tuple + arity);
+                }
+            }
+            run.tuples.swap(sorted);
+        }
+    }
+
+    /** @brief Sort a buffer of a thread and hand it over to the buffers of the loop */
+    static void collect(InterpreterInsertBuffer& buffer, std::vector<InterpreterInsertBuffer>& buffers) {
+        if (buffer.empty()) {
+            return;
+        }
+        buffer.sort();
+        PARALLEL_CRITICAL
+        buffers.push_back(std::move(buffer));
+    }
+
+    /**
+     * @brief Merge the sorted runs of the given buffers per relation and insert the result
+     *        into the relations of the environment. The buffers are emptied.
+     */
+    static void flush(std::vector<InterpreterInsertBuffer>& buffers, InterpreterEnvironment& env) {
+        if (buffers.empty()) {
+            return;
+        }
+
+        // the runs of each relation
+        std::map<size_t, std::vector<const Run*>> relations;
+        for (const auto& buffer : buffers) {
+            for (const auto& cur : buffer.runs) {
+                relations[cur.first].push_back(&cur.second);
+            }
+        }
+
+        std::vector<RamDomain> merged;
+        for (const auto& cur : relations) {
+            const size_t arity = cur.second.front()->arity;
+            merge(cur.second, merged);
+            env.getRelationHandle(cur.first)->merge(merged.data(), merged.size() / arity);
+        }
+
+        buffers.clear();
+    }
+
+private:
+    /** Sorted, duplicate-free tuples of one relation in row-major order */
+    struct Run {
+        size_t arity = 0;
+        std::vector<RamDomain> tuples;
+
+        size_t size() const {
+            return tuples.size() / arity;
+        }
+
+        const RamDomain* get(size_t i) const {
+            return tuples.data() + i * arity;
+        }
+
+        bool less(const RamDomain* a, const RamDomain* b) const {
+            return std::lexicographical_compare(a, a + arity, b, b + arity);
+        }
+    };
+
+    /** @brief K-way merge of sorted runs, dropping the tuples found in more than one run */
+    static void merge(const std::vector<const Run*>& sources, std::vector<RamDomain>& out) {
+        out.clear();
+        const Run& first = *sources.front();
+        const size_t arity = first.arity;
+        if (sources.size() == 1) {
+            out = first.tuples;
+            return;
+        }
+
+        // the heads of the runs, smallest first
+        using Head = std::pair<size_t, size_t>;  // (run, position)
+        auto greater = [&](const Head& a, const Head& b) {
+            return first.less(sources[b.first]->get(b.second), sources[a.first]->get(a.second));
+        };
+        std::priority_queue<Head, std::vector<Head>, decltype(greater)> heads(greater);
+        size_t total = 0;
+        for (size_t i = 0; i < sources.size(); ++i) {
+            heads.emplace(i, 0);
+            total += sources[i]->tuples.size();
+        }
+
+        out.reserve(total);
+        while (!heads.empty()) {
+            Head head = heads.top();
+            heads.pop();
+            const RamDomain* tuple = sources[head.first]->get(head.second);
+            if (out.empty() || !std::equal(tuple, tuple + arity, out.end() - arity)) {
+                out.insert(out.end(), tuple, tuple + arity);
+            }
+            if (++head.second < sources[head.first]->size()) {
+                heads.push(head);
+            }
+        }
+    }
+
+    /** Buffered tuples, indexed by relation id */
+    std::map<size_t, Run> runs;
+};
+
+}  // namespace souffle
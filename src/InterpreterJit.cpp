@@ -0,0 +1,564 @@
+/*
+ * Souffle - A Datalog Compiler
+ * Copyright (c) 2020, The Souffle Developers. All rights reserved.
+ * Licensed under the Universal Permissive License v 1.0 as shown at:
+ * - https://opensource.org/licenses/UPL
+ * - <souffle root>/licenses/SOUFFLE-UPL.txt
+ */
+
+/************************************************************************
+ *
+ * @file InterpreterJit.cpp
+ *
+ * Implements the tiered compilation of the interpreter.
+ *
+ ***********************************************************************/
+
+#include "InterpreterJit.h"
+#include "BinaryConstraintOps.h"
+#include "FunctorOps.h"
+#include "Global.h"
+#include "InterpreterRelation.h"
+#include "RamIndexAnalysis.h"
+#include "Util.h"
+#include <algorithm>
+#include <cassert>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <utility>
+#include <dlfcn.h>
+
+namespace souffle {
+
+namespace {
+
+/** @brief Return the relation operations of the interpreter as a table for native bodies */
+InterpreterJitRuntime createRuntime() {
+    InterpreterJitRuntime runtime;
+    runtime.size = [](const InterpreterRelation* rel) { return rel->size(); };
+    runtime.empty = [](const InterpreterRelation* rel) { return rel->empty(); };
+    runtime.scan = [](const InterpreterRelation* rel) { return rel->scan(); };
+    runtime.partitionScan = [](const InterpreterRelation* rel, std::size_t partitionCount) {
+        return rel->partitionScan(partitionCount);
+    };
+    runtime.partitionRange = [](const InterpreterRelation* rel, std::size_t indexPos, const RamDomain* low,
+                                     const RamDomain* high, std::size_t partitionCount) {
+        const size_t arity = rel->getArity();
+        return rel->partitionRange(indexPos, TupleRef(low, arity), TupleRef(high, arity), partitionCount);
+    };
+    runtime.createView = [](const InterpreterRelation* rel, std::size_t indexPos) {
+        return rel->getView(indexPos);
+    };
+    runtime.insert = [](InterpreterRelation* rel, const RamDomain* tuple) { return rel->insert(tuple); };
+    return runtime;
+}
+
+/** @brief Return the command compiling a query to a shared object, without the files */
+std::string createCompileCommand() {
+    const char* cxx = std::getenv("CXX");
+    std::string cmd = cxx != nullptr ? cxx : "c++";
+    cmd += " -std=c++17 -O2 -fPIC -shared";
+#ifdef _OPENMP
+    cmd += " -fopenmp";
+#endif
+    cmd += " -DRAM_DOMAIN_SIZE=" + std::to_string(RAM_DOMAIN_SIZE);
+    if (const char* flags = std::getenv("CXXFLAGS")) {
+        cmd += " " + std::string(flags);
+    }
+    if (Global::config().has("jit-include-dir")) {
+        cmd += " -I" + Global::config().get("jit-include-dir");
+    }
+    return cmd;
+}
+
+/** @brief Return the type of the arguments of a functor, or nullptr if the functor is not compiled */
+const char* getOperandType(FunctorOp op) {
+    switch (op) {
+        case FunctorOp::NEG:
+        case FunctorOp::BNOT:
+        case FunctorOp::ADD:
+        case FunctorOp::SUB:
+        case FunctorOp::MUL:
+        case FunctorOp::BAND:
+        case FunctorOp::BOR:
+        case FunctorOp::BXOR:
+        case FunctorOp::MAX:
+        case FunctorOp::MIN:
+            return "RamSigned";
+        case FunctorOp::UBNOT:
+        case FunctorOp::UADD:
+        case FunctorOp::USUB:
+        case FunctorOp::UMUL:
+        case FunctorOp::UBAND:
+        case FunctorOp::UBOR:
+        case FunctorOp::UBXOR:
+        case FunctorOp::UMAX:
+        case FunctorOp::UMIN:
+            return "RamUnsigned";
+        case FunctorOp::FNEG:
+        case FunctorOp::FADD:
+        case FunctorOp::FSUB:
+        case FunctorOp::FMUL:
+        case FunctorOp::FMAX:
+        case FunctorOp::FMIN:
+            return "RamFloat";
+        default:
+            return nullptr;
+    }
+}
+
+/** @brief Return the C++ operator of a functor; std::max and std::min are returned as "max" and "min" */
+const char* getOperatorSymbol(FunctorOp op) {
+    switch (op) {
+        case FunctorOp::NEG:
+        case FunctorOp::FNEG:
+            return "-";
+        case FunctorOp::BNOT:
+        case FunctorOp::UBNOT:
+            return "~";
+        case FunctorOp::ADD:
+        case FunctorOp::UADD:
+        case FunctorOp::FADD:
+            return "+";
+        case FunctorOp::SUB:
+        case FunctorOp::USUB:
+        case FunctorOp::FSUB:
+            return "-";
+        case FunctorOp::MUL:
+        case FunctorOp::UMUL:
+        case FunctorOp::FMUL:
+            return "*";
+        case FunctorOp::BAND:
+        case FunctorOp::UBAND:
+            return "&";
+        case FunctorOp::BOR:
+        case FunctorOp::UBOR:
+            return "|";
+        case FunctorOp::BXOR:
+        case FunctorOp::UBXOR:
+            return "^";
+        case FunctorOp::MAX:
+        case FunctorOp::UMAX:
+        case FunctorOp::FMAX:
+            return "max";
+        case FunctorOp::MIN:
+        case FunctorOp::UMIN:
+        case FunctorOp::FMIN:
+            return "min";
+        default:
+            return nullptr;
+    }
+}
+
+/** @brief Return the type and C++ operator of a numeric constraint, or nullptr if it is not compiled */
+std::pair<const char*, const char*> getComparison(BinaryConstraintOp op) {
+    switch (op) {
+        // clang-format off
+        case BinaryConstraintOp::EQ:  return {"RamDomain", "=="};
+        case BinaryConstraintOp::FEQ: return {"RamFloat", "=="};
+        case BinaryConstraintOp::NE:  return {"RamDomain", "!="};
+        case BinaryConstraintOp::FNE: return {"RamFloat", "!="};
+        case BinaryConstraintOp::LT:  return {"RamSigned", "<"};
+        case BinaryConstraintOp::ULT: return {"RamUnsigned", "<"};
+        case BinaryConstraintOp::FLT: return {"RamFloat", "<"};
+        case BinaryConstraintOp::LE:  return {"RamSigned", "<="};
+        case BinaryConstraintOp::ULE: return {"RamUnsigned", "<="};
+        case BinaryConstraintOp::FLE: return {"RamFloat", "<="};
+        case BinaryConstraintOp::GT:  return {"RamSigned", ">"};
+        case BinaryConstraintOp::UGT: return {"RamUnsigned", ">"};
+        case BinaryConstraintOp::FGT: return {"RamFloat", ">"};
+        case BinaryConstraintOp::GE:  return {"RamSigned", ">="};
+        case BinaryConstraintOp::UGE: return {"RamUnsigned", ">="};
+        case BinaryConstraintOp::FGE: return {"RamFloat", ">="};
+        // clang-format on
+        default:
+            return {nullptr, nullptr};
+    }
+}
+
+}  // namespace
+
+bool InterpreterJitGenerator::generate(const RamQuery& query) {
+    source.clear();
+    relations.clear();
+    numViews = 0;
+    loopDepth = 0;
+
+    std::vector<std::string> bodyViews;
+    views = &bodyViews;
+    std::stringstream body;
+    bool supported = emit(query.getOperation(), body);
+    views = nullptr;
+    if (!supported) {
+        return false;
+    }
+
+    std::stringstream out;
+    out << "#include \"InterpreterJitRuntime.h\"\n";
+    out << "#include \"WorkStealing.h\"\n";
+    out << "#include <algorithm>\n\n";
+    out << "using namespace souffle;\n\n";
+    out << "extern \"C\" void " << JIT_QUERY_SYMBOL
+        << "(const InterpreterJitRuntime& rt, InterpreterRelation* const* rel) {\n";
+    for (const auto& view : bodyViews) {
+        out << view;
+    }
+    out << body.str();
+    out << "}\n";
+    source = out.str();
+    return true;
+}
+
+bool InterpreterJitGenerator::emit(const RamOperation& op, std::ostream& out) {
+    if (const auto* scan = dynamic_cast<const RamParallelScan*>(&op)) {
+        return emitScan(*scan, true, out);
+    } else if (const auto* scan = dynamic_cast<const RamScan*>(&op)) {
+        return emitScan(*scan, false, out);
+    } else if (const auto* scan = dynamic_cast<const RamParallelIndexScan*>(&op)) {
+        return emitScan(*scan, true, out);
+    } else if (const auto* scan = dynamic_cast<const RamIndexScan*>(&op)) {
+        return emitScan(*scan, false, out);
+    } else if (const auto* filter = dynamic_cast<const RamFilter*>(&op)) {
+        out << "if (";
+        if (!emit(filter->getCondition(), out)) {
+            return false;
+        }
+        out << ") {\n";
+        if (!emit(filter->getOperation(), out)) {
+            return false;
+        }
+        out << "}\n";
+        return true;
+    } else if (const auto* brk = dynamic_cast<const RamBreak*>(&op)) {
+        // a break ends the inner-most loop, as it does in the interpreter
+        if (loopDepth == 0) {
+            return false;
+        }
+        out << "if (";
+        if (!emit(brk->getCondition(), out)) {
+            return false;
+        }
+        out << ") {\nbreak;\n}\n";
+        return emit(brk->getOperation(), out);
+    } else if (const auto* project = dynamic_cast<const RamProject*>(&op)) {
+        const size_t arity = project->getRelation().getArity();
+        if (arity == 0) {
+            return false;
+        }
+        out << "{\nconst RamDomain tuple[" << arity << "] = {";
+        const auto values = project->getValues();
+        for (size_t i = 0; i < arity; ++i) {
+            out << (i > 0 ? ", " : "");
+            if (!emit(*values[i], out)) {
+                return false;
+            }
+        }
+        out << "};\n";
+        out << "rt.insert(" << getRelation(project->getRelation()) << ", tuple);\n}\n";
+        return true;
+    }
+    return false;
+}
+
+bool InterpreterJitGenerator::emitScan(const RamRelationOperation& scan, bool parallel, std::ostream& out) {
+    const RamRelation& relation = scan.getRelation();
+    const std::string rel = getRelation(relation);
+    const size_t arity = relation.getArity();
+    const std::string id = std::to_string(scan.getTupleId());
+    const auto* indexScan = dynamic_cast<const RamIndexScan*>(&scan);
+
+    out << "{\n";
+    if (indexScan != nullptr && !emitBounds(id, indexScan->getRangePattern(), out)) {
+        return false;
+    }
+    const std::string bounds = "TupleRef(low" + id + ", " + std::to_string(arity) + "), TupleRef(high" + id +
+                               ", " + std::to_string(arity) + ")";
+
+    // the body of the loop, with the views of a parallel loop declared by each thread
+    std::vector<std::string> regionViews;
+    std::vector<std::string>* outerViews = views;
+    if (parallel) {
+        views = &regionViews;
+    }
+    std::stringstream nested;
+    ++loopDepth;
+    nested << "const RamDomain* env" << id << " = t" << id << ".getBase();\n";
+    bool supported = emit(scan.getOperation(), nested);
+    --loopDepth;
+    views = outerViews;
+    if (!supported) {
+        return false;
+    }
+
+    if (!parallel) {
+        out << "for (const TupleRef& t" << id << " : ";
+        if (indexScan != nullptr) {
+            out << getView(scan, relation) << "->range(" << bounds << ")";
+        } else {
+            out << "rt.scan(" << rel << ")";
+        }
+        out << ") {\n" << nested.str() << "}\n}\n";
+        return true;
+    }
+
+    out << "PartitionedStream part" << id << " = ";
+    if (indexScan != nullptr) {
+        auto pos = indexTable.find(&scan);
+        if (pos == indexTable.end()) {
+            return false;
+        }
+        out << "rt.partitionRange(" << rel << ", " << pos->second << ", low" << id << ", high" << id
+            << ", MAX_THREADS * PARTITIONS_PER_THREAD);\n";
+    } else {
+        out << "rt.partitionScan(" << rel << ", getPartitionCount(rt.size(" << rel << "), MAX_THREADS));\n";
+    }
+    out << "WorkStealingLoop loop" << id << "(part" << id << ".size());\n";
+    out << "PARALLEL_START\n";
+    for (const auto& view : regionViews) {
+        out << view;
+    }
+    out << "std::size_t partition" << id << ";\n";
+    out << "while (loop" << id << ".next(partition" << id << ")) {\n";
+    out << "for (const TupleRef& t" << id << " : part" << id << "[partition" << id << "]) {\n";
+    out << nested.str();
+    out << "}\n}\nPARALLEL_END\n}\n";
+    return true;
+}
+
+bool InterpreterJitGenerator::emitBounds(
+        const std::string& id, const std::vector<RamExpression*>& values, std::ostream& out) {
+    if (values.empty()) {
+        return false;
+    }
+    out << "RamDomain low" << id << "[" << values.size() << "];\n";
+    out << "RamDomain high" << id << "[" << values.size() << "];\n";
+    for (size_t i = 0; i < values.size(); ++i) {
+        if (dynamic_cast<const RamUndefValue*>(values[i]) != nullptr) {
+            out << "low" << id << "[" << i << "] = MIN_RAM_SIGNED;\n";
+            out << "high" << id << "[" << i << "] = MAX_RAM_SIGNED;\n";
+            continue;
+        }
+        out << "low" << id << "[" << i << "] = high" << id << "[" << i << "] = ";
+        if (!emit(*values[i], out)) {
+            return false;
+        }
+        out << ";\n";
+    }
+    return true;
+}
+
+bool InterpreterJitGenerator::emit(const RamCondition& condition, std::ostream& out) {
+    if (dynamic_cast<const RamTrue*>(&condition) != nullptr) {
+        out << "true";
+        return true;
+    } else if (dynamic_cast<const RamFalse*>(&condition) != nullptr) {
+        out << "false";
+        return true;
+    } else if (const auto* conj = dynamic_cast<const RamConjunction*>(&condition)) {
+        out << "(";
+        if (!emit(conj->getLHS(), out)) {
+            return false;
+        }
+        out << " && ";
+        if (!emit(conj->getRHS(), out)) {
+            return false;
+        }
+        out << ")";
+        return true;
+    } else if (const auto* neg = dynamic_cast<const RamNegation*>(&condition)) {
+        out << "!";
+        return emit(neg->getOperand(), out);
+    } else if (const auto* emptiness = dynamic_cast<const RamEmptinessCheck*>(&condition)) {
+        out << "rt.empty(" << getRelation(emptiness->getRelation()) << ")";
+        return true;
+    } else if (const auto* exists = dynamic_cast<const RamExistenceCheck*>(&condition)) {
+        const size_t arity = exists->getRelation().getArity();
+        const auto values = exists->getValues();
+        if (arity == 0) {
+            return false;
+        }
+        const std::string view = getView(*exists, exists->getRelation());
+
+        // for total signatures we use the exists test, otherwise we search for the boundaries
+        out << "[&]() {\n";
+        if (isa->isTotalSignature(exists)) {
+            out << "const RamDomain key[" << arity << "] = {";
+            for (size_t i = 0; i < arity; ++i) {
+                out << (i > 0 ? ", " : "");
+                if (!emit(*values[i], out)) {
+                    return false;
+                }
+            }
+            out << "};\n";
+            out << "return " << view << "->contains(TupleRef(key, " << arity << "));\n";
+        } else {
+            if (!emitBounds("", values, out)) {
+                return false;
+            }
+            out << "return " << view << "->contains(TupleRef(low, " << arity << "), TupleRef(high, "
+                << arity << "));\n";
+        }
+        out << "}()";
+        return true;
+    } else if (const auto* constraint = dynamic_cast<const RamConstraint*>(&condition)) {
+        auto comparison = getComparison(constraint->getOperator());
+        if (comparison.first == nullptr) {
+            return false;
+        }
+        out << "(ramBitCast<" << comparison.first << ">(";
+        if (!emit(constraint->getLHS(), out)) {
+            return false;
+        }
+        out << ") " << comparison.second << " ramBitCast<" << comparison.first << ">(";
+        if (!emit(constraint->getRHS(), out)) {
+            return false;
+        }
+        out << "))";
+        return true;
+    }
+    return false;
+}
+
+bool InterpreterJitGenerator::emit(const RamExpression& expression, std::ostream& out) {
+    if (const auto* constant = dynamic_cast<const RamConstant*>(&expression)) {
+        // constants are emitted by their bits, which keeps floats and the smallest integers exact
+        out << "ramBitCast<RamDomain>(RamUnsigned(" << ramBitCast<RamUnsigned>(constant->getConstant())
+            << "ull))";
+        return true;
+    } else if (const auto* element = dynamic_cast<const RamTupleElement*>(&expression)) {
+        out << "env" << element->getTupleId() << "[" << element->getElement() << "]";
+        return true;
+    } else if (const auto* op = dynamic_cast<const RamIntrinsicOperator*>(&expression)) {
+        const char* type = getOperandType(op->getOperator());
+        const char* symbol = getOperatorSymbol(op->getOperator());
+        const auto args = op->getArguments();
+        if (type == nullptr || symbol == nullptr || args.empty()) {
+            return false;
+        }
+        const std::string name(symbol);
+
+        // unary operators
+        if (args.size() == 1) {
+            out << "ramBitCast<RamDomain>(" << type << "(" << symbol << "ramBitCast<" << type << ">(";
+            if (!emit(*args[0], out)) {
+                return false;
+            }
+            out << ")))";
+            return true;
+        }
+
+        // binary operators are folded from the left, which covers the variadic max and min
+        std::stringstream acc;
+        acc << "ramBitCast<" << type << ">(";
+        if (!emit(*args[0], acc)) {
+            return false;
+        }
+        acc << ")";
+        for (size_t i = 1; i < args.size(); ++i) {
+            std::stringstream arg;
+            arg << "ramBitCast<" << type << ">(";
+            if (!emit(*args[i], arg)) {
+                return false;
+            }
+            arg << ")";
+            std::stringstream next;
+            if (name == "max" || name == "min") {
+                next << "std::" << name << "<" << type << ">(" << acc.str() << ", " << arg.str() << ")";
+            } else {
+                next << type << "(" << acc.str() << " " << name << " " << arg.str() << ")";
+            }
+            acc.str(next.str());
+        }
+        out << "ramBitCast<RamDomain>(" << acc.str() << ")";
+        return true;
+    }
+    return false;
+}
+
+std::string InterpreterJitGenerator::getRelation(const RamRelation& rel) {
+    auto pos = std::find(relations.begin(), relations.end(), &rel);
+    if (pos == relations.end()) {
+        relations.push_back(&rel);
+        pos = relations.end() - 1;
+    }
+    return "rel[" + std::to_string(pos - relations.begin()) + "]";
+}
+
+std::string InterpreterJitGenerator::getView(const RamNode& node, const RamRelation& rel) {
+    auto pos = indexTable.find(&node);
+    assert(pos != indexTable.end() && "index operation without index");
+    std::string name = "view" + std::to_string(numViews++);
+    views->push_back(
+            "IndexViewPtr " + name + " = rt.createView(" + getRelation(rel) + ", " +
+            std::to_string(pos->second) + ");\n");
+    return name;
+}
+
+InterpreterJit::InterpreterJit(std::chrono::nanoseconds threshold)
+        : threshold(threshold), runtime(createRuntime()), compileCommand(createCompileCommand()) {}
+
+InterpreterJit::~InterpreterJit() {
+    wait();
+    for (void* handle : handles) {
+        dlclose(handle);
+    }
+}
+
+void InterpreterJit::wait() {
+    std::vector<std::thread> running;
+    {
+        std::lock_guard<std::mutex> guard(lock);
+        running.swap(threads);
+    }
+    for (auto& thread : running) {
+        thread.join();
+    }
+}
+
+void InterpreterJit::submit(const std::shared_ptr<InterpreterJitQuery>& query) {
+    std::lock_guard<std::mutex> guard(lock);
+    threads.emplace_back([this, query]() { compile(*query); });
+}
+
+void InterpreterJit::compile(InterpreterJitQuery& query) {
+    const bool verbose = Global::config().has("verbose");
+    const std::string base = tempFile();
+    const std::string sourceFile = base + ".cpp";
+    const std::string libraryFile = base + ".so";
+    {
+        std::ofstream os(sourceFile);
+        os << query.getSource();
+    }
+
+    std::string cmd = compileCommand + " -o " + libraryFile + " " + sourceFile;
+    if (!verbose) {
+        cmd += " >/dev/null 2>&1";
+    }
+    const bool compiled = std::system(cmd.c_str()) == 0;
+    std::remove(sourceFile.c_str());
+    std::remove(base.c_str());
+
+    void* handle = compiled ? dlopen(libraryFile.c_str(), RTLD_NOW | RTLD_LOCAL) : nullptr;
+    std::remove(libraryFile.c_str());
+    void* body = handle != nullptr ? dlsym(handle, JIT_QUERY_SYMBOL) : nullptr;
+    if (body == nullptr) {
+        if (handle != nullptr) {
+            dlclose(handle);
+        }
+        if (verbose) {
+            std::cerr << "warning: failed to compile a query, it remains interpreted: " << cmd << "\n";
+        }
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> guard(lock);
+        handles.push_back(handle);
+    }
+    query.body.store(reinterpret_cast<InterpreterJitQueryBody>(body), std::memory_order_release);
+}
+
+}  // namespace souffle
@@ -0,0 +1,203 @@
+/*
+ * Souffle - A Datalog Compiler
+ * Copyright (c) 2020, The Souffle Developers. All rights reserved.
+ * Licensed under the Universal Permissive License v 1.0 as shown at:
+ * - https://opensource.org/licenses/UPL
+ * - <souffle root>/licenses/SOUFFLE-UPL.txt
+ */
+
+/************************************************************************
+ *
+ * @file InterpreterJit.h
+ *
+ * Declares the tiered compilation of the interpreter. The interpreter
+ * measures the time it spends in each query. Once a query passes a
+ * threshold, C++ code for its body is generated and compiled to a shared
+ * object in the background, while the interpreter keeps evaluating the
+ * query. The next execution of the query, e.g., in the next iteration of
+ * a fixpoint, runs the native body instead.
+ *
+ ***********************************************************************/
+
+#pragma once
+
+#include "InterpreterJitRuntime.h"
+#include "RamCondition.h"
+#include "RamExpression.h"
+#include "RamOperation.h"
+#include "RamStatement.h"
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+namespace souffle {
+
+class RamIndexAnalysis;
+
+/**
+ * @class InterpreterJitQuery
+ * @brief The generated code of a query and the state of its compilation
+ */
+class InterpreterJitQuery {
+public:
+    InterpreterJitQuery(std::string source, std::vector<size_t> relIds)
+            : source(std::move(source)), relIds(std::move(relIds)) {}
+
+    /** @brief Return the C++ code of the query */
+    const std::string& getSource() const {
+        return source;
+    }
+
+    /** @brief Return the ids of the relations the native body takes, in order */
+    const std::vector<size_t>& getRelationIds() const {
+        return relIds;
+    }
+
+    /** @brief Return the native body, or nullptr while the query is interpreted */
+    InterpreterJitQueryBody getBody() const {
+        return body.load(std::memory_order_acquire);
+    }
+
+    /**
+     * @brief Add the time of an interpreted execution;
+     *        return true for the one call which passes the given threshold
+     */
+    bool addTime(std::chrono::nanoseconds time, std::chrono::nanoseconds threshold) {
+        auto total = std::chrono::nanoseconds(elapsed.fetch_add(time.count()) + time.count());
+        return total >= threshold && !submitted.exchange(true);
+    }
+
+private:
+    friend class InterpreterJit;
+
+    /** C++ code of the query */
+    const std::string source;
+    /** Ids of the relations of the query in the environment of the evaluation */
+    const std::vector<size_t> relIds;
+    /** Time spent interpreting the query, in nanoseconds */
+    std::atomic<std::chrono::nanoseconds::rep> elapsed{0};
+    /** Whether the query has been handed to the compiler */
+    std::atomic<bool> submitted{false};
+    /** Native body, published once the shared object is loaded */
+    std::atomic<InterpreterJitQueryBody> body{nullptr};
+};
+
+/**
+ * @class InterpreterJitGenerator
+ * @brief Generates the C++ code of a query body, if the query only consists of supported operations.
+ *
+ * Supported are scans and index scans, their parallel versions, filters, breaks and projections,
+ * numeric constraints, existence and emptiness checks, and arithmetic which cannot fail.
+ * Queries with other operations are left to the interpreter.
+ */
+class InterpreterJitGenerator {
+public:
+    /**
+     * @param isa the index analysis of the program
+     * @param indexTable the index position of each operation searching an index
+     */
+    InterpreterJitGenerator(
+            RamIndexAnalysis* isa, const std::unordered_map<const RamNode*, size_t>& indexTable)
+            : isa(isa), indexTable(indexTable) {}
+
+    /** @brief Generate the code of a query; return false if the query has unsupported operations */
+    bool generate(const RamQuery& query);
+
+    /** @brief Return the code of the last generated query */
+    const std::string& getSource() const {
+        return source;
+    }
+
+    /** @brief Return the relations of the last generated query, in the order the native body takes them */
+    const std::vector<const RamRelation*>& getRelations() const {
+        return relations;
+    }
+
+private:
+    bool emit(const RamOperation& op, std::ostream& out);
+    bool emit(const RamCondition& condition, std::ostream& out);
+    bool emit(const RamExpression& expression, std::ostream& out);
+
+    /** @brief Emit the loop over the tuples of a scan, or the parallel loop over its partitions */
+    bool emitScan(const RamRelationOperation& scan, bool parallel, std::ostream& out);
+
+    /** @brief Emit the bounds low<id> and high<id> of the search of an index operation */
+    bool emitBounds(const std::string& id, const std::vector<RamExpression*>& values, std::ostream& out);
+
+    /** @brief Return the name of the argument holding the given relation */
+    std::string getRelation(const RamRelation& rel);
+
+    /** @brief Return the name of the view of an index operation, declaring it in the current region */
+    std::string getView(const RamNode& node, const RamRelation& rel);
+
+    RamIndexAnalysis* isa;
+    const std::unordered_map<const RamNode*, size_t>& indexTable;
+
+    /** Code of the last generated query */
+    std::string source;
+    /** Relations of the query, in order of their first use */
+    std::vector<const RamRelation*> relations;
+    /** Declarations of the views of the current region, i.e., of the body or of a parallel loop */
+    std::vector<std::string>* views = nullptr;
+    /** Number of views declared so far */
+    size_t numViews = 0;
+    /** Number of loops around the current operation */
+    size_t loopDepth = 0;
+};
+
+/**
+ * @class InterpreterJit
+ * @brief Compiles hot queries in the background and loads their native bodies
+ */
+class InterpreterJit {
+public:
+    /** @param threshold the time the interpreter spends in a query before the query is compiled */
+    explicit InterpreterJit(std::chrono::nanoseconds threshold);
+
+    /** Waits for the compilations in flight and unloads the native bodies */
+    ~InterpreterJit();
+
+    InterpreterJit(const InterpreterJit&) = delete;
+    InterpreterJit& operator=(const InterpreterJit&) = delete;
+
+    /** @brief Return the time the interpreter spends in a query before the query is compiled */
+    std::chrono::nanoseconds getThreshold() const {
+        return threshold;
+    }
+
+    /** @brief Return the relation operations native bodies call */
+    const InterpreterJitRuntime& getRuntime() const {
+        return runtime;
+    }
+
+    /** @brief Compile a query in the background; the native body is published once it is loaded */
+    void submit(const std::shared_ptr<InterpreterJitQuery>& query);
+
+    /** @brief Wait for the compilations in flight */
+    void wait();
+
+private:
+    /** @brief Compile and load a query; failures leave the query to the interpreter */
+    void compile(InterpreterJitQuery& query);
+
+    const std::chrono::nanoseconds threshold;
+    const InterpreterJitRuntime runtime;
+    /** Compiler command, without the files */
+    const std::string compileCommand;
+
+    /** Guards the threads and handles */
+    std::mutex lock;
+    /** Threads of the compilations */
+    std::vector<std::thread> threads;
+    /** Handles of the loaded shared objects */
+    std::vector<void*> handles;
+};
+
+}  // namespace souffle
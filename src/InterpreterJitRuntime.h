@@ -0,0 +1,70 @@
+/*
+ * Souffle - A Datalog Compiler
+ * Copyright (c) 2020, The Souffle Developers. All rights reserved.
+ * Licensed under the Universal Permissive License v 1.0 as shown at:
+ * - https://opensource.org/licenses/UPL
+ * - <souffle root>/licenses/SOUFFLE-UPL.txt
+ */
+
+/************************************************************************
+ *
+ * @file InterpreterJitRuntime.h
+ *
+ * The contract between the interpreter and the native code of queries
+ * compiled while the interpreter runs.
+ *
+ * A compiled query is a shared object exporting a function named by
+ * JIT_QUERY_SYMBOL of type InterpreterJitQueryBody. The interpreter passes
+ * a table of the relation operations it provides and the relations of the
+ * query, in the order the generator of the query has chosen. Relations are
+ * opaque to the native code: it only reaches them through the table, and
+ * it reads tuples through the streams and views of InterpreterIndex.h,
+ * whose layout both sides share by including the same headers.
+ *
+ ***********************************************************************/
+
+#pragma once
+
+#include "InterpreterIndex.h"
+#include "RamTypes.h"
+#include <cstddef>
+
+namespace souffle {
+
+class InterpreterRelation;
+
+/**
+ * @struct InterpreterJitRuntime
+ * @brief Relation operations of the interpreter which native query bodies may call
+ */
+struct InterpreterJitRuntime {
+    /** Number of tuples of a relation */
+    std::size_t (*size)(const InterpreterRelation* rel);
+
+    /** Check whether a relation is empty */
+    bool (*empty)(const InterpreterRelation* rel);
+
+    /** Stream over all tuples of a relation */
+    Stream (*scan)(const InterpreterRelation* rel);
+
+    /** Streams over disjoint parts of a relation */
+    PartitionedStream (*partitionScan)(const InterpreterRelation* rel, std::size_t partitionCount);
+
+    /** Streams over disjoint parts of the tuples between two bounds of an index */
+    PartitionedStream (*partitionRange)(const InterpreterRelation* rel, std::size_t indexPos,
+            const RamDomain* low, const RamDomain* high, std::size_t partitionCount);
+
+    /** View on an index of a relation, for use by a single thread */
+    IndexViewPtr (*createView)(const InterpreterRelation* rel, std::size_t indexPos);
+
+    /** Add a tuple to a relation; relations are safe to insert into from several threads */
+    bool (*insert)(InterpreterRelation* rel, const RamDomain* tuple);
+};
+
+/** Type of the native body of a query, taking the runtime and the relations of the query */
+using InterpreterJitQueryBody = void (*)(const InterpreterJitRuntime& rt, InterpreterRelation* const* rel);
+
+/** Name of the native body in the shared object of a compiled query */
+constexpr const char* JIT_QUERY_SYMBOL = "souffle_jit_query";
+
+}  // namespace souffle
@@ -23,57 +23,73 @@
 
 #pragma once
 
+#include "InterpreterFunctor.h"
+#include "InterpreterJit.h"
 #include "InterpreterPreamble.h"
 #include "InterpreterRelation.h"
 #include "RamNode.h"
+#include "RegexCache.h"
+#include <cassert>
+#include <limits>
+#include <memory>
+#include <vector>
 
 namespace souffle {
 
+// clang-format off
+/** List of all interpreter node kinds, expanded by FORWARD for each kind */
+#define FOR_EACH_INTERPRETER_NODE(FORWARD) \
+    FORWARD(Constant) \
+    FORWARD(TupleElement) \
+    FORWARD(AutoIncrement) \
+    FORWARD(IntrinsicOperator) \
+    FORWARD(UserDefinedOperator) \
+    FORWARD(PackRecord) \
+    FORWARD(SubroutineArgument) \
+    FORWARD(True) \
+    FORWARD(False) \
+    FORWARD(Conjunction) \
+    FORWARD(Negation) \
+    FORWARD(EmptinessCheck) \
+    FORWARD(ExistenceCheck) \
+    FORWARD(ProvenanceExistenceCheck) \
+    FORWARD(Constraint) \
+    FORWARD(TupleOperation) \
+    FORWARD(Scan) \
+    FORWARD(ParallelScan) \
+    FORWARD(IndexScan) \
+    FORWARD(ParallelIndexScan) \
+    FORWARD(Choice) \
+    FORWARD(ParallelChoice) \
+    FORWARD(IndexChoice) \
+    FORWARD(ParallelIndexChoice) \
+    FORWARD(UnpackRecord) \
+    FORWARD(Aggregate) \
+    FORWARD(IndexAggregate) \
+    FORWARD(Break) \
+    FORWARD(Filter) \
+    FORWARD(Project) \
+    FORWARD(SubroutineReturnValue) \
+    FORWARD(Sequence) \
+    FORWARD(Parallel) \
+    FORWARD(Loop) \
+    FORWARD(Exit) \
+    FORWARD(LogRelationTimer) \
+    FORWARD(LogTimer) \
+    FORWARD(DebugInfo) \
+    FORWARD(Clear) \
+    FORWARD(LogSize) \
+    FORWARD(IO) \
+    FORWARD(Query) \
+    FORWARD(Merge) \
+    FORWARD(Extend) \
+    FORWARD(Swap)
+// clang-format on
+
 enum InterpreterNodeType {
-    I_Constant,
-    I_TupleElement,
-    I_AutoIncrement,
-    I_IntrinsicOperator,
-    I_UserDefinedOperator,
-    I_PackRecord,
-    I_SubroutineArgument,
-    I_True,
-    I_False,
-    I_Conjunction,
-    I_Negation,
-    I_EmptinessCheck,
-    I_ExistenceCheck,
-    I_ProvenanceExistenceCheck,
-    I_Constraint,
-    I_TupleOperation,
-    I_Scan,
-    I_ParallelScan,
-    I_IndexScan,
-    I_ParallelIndexScan,
-    I_Choice,
-    I_ParallelChoice,
-    I_IndexChoice,
-    I_ParallelIndexChoice,
-    I_UnpackRecord,
-    I_Aggregate,
-    I_IndexAggregate,
-    I_Break,
-    I_Filter,
-    I_Project,
-    I_SubroutineReturnValue,
-    I_Sequence,
-    I_Parallel,
-    I_Loop,
-    I_Exit,
-    I_LogRelationTimer,
-    I_LogTimer,
-    I_DebugInfo,
-    I_Clear,
-    I_LogSize,
-    I_IO,
-    I_Query,
-    I_Extend,
-    I_Swap,
+#define DECLARE_NODE_TYPE(Kind) I_##Kind,
+    FOR_EACH_INTERPRETER_NODE(DECLARE_NODE_TYPE)
+#undef DECLARE_NODE_TYPE
 };
 
 /**
@@ -84,14 +100,14 @@ enum InterpreterNodeType {
  */
 
 class InterpreterNode {
-    using RelationHandle = std::unique_ptr<InterpreterRelation>;
-
 public:
+    /** Relation id of nodes which do not operate on a relation */
+    static constexpr size_t NO_RELATION = std::numeric_limits<size_t>::max();
+
     InterpreterNode(enum InterpreterNodeType ty, const RamNode* sdw,
-            std::vector<std::unique_ptr<InterpreterNode>> chlds = {}, RelationHandle* relHandle = nullptr,
+            std::vector<std::unique_ptr<InterpreterNode>> chlds = {}, size_t relId = NO_RELATION,
             std::vector<size_t> data = {})
-            : type(ty), shadow(sdw), children(std::move(chlds)), relHandle(relHandle), data(std::move(data)) {
-    }
+            : type(ty), shadow(sdw), children(std::move(chlds)), relId(relId), data(std::move(data)) {}
 
     /** @brief get node type */
     inline enum InterpreterNodeType getType() const {
@@ -123,25 +139,56 @@ public:
         preamble = p;
     }
 
+    /** @brief get resolved user-defined operator */
+    inline InterpreterFunctor* getFunctor() const {
+        return functor.get();
+    }
+
+    /** @brief set resolved user-defined operator */
+    inline void setFunctor(std::unique_ptr<InterpreterFunctor> f) {
+        functor = std::move(f);
+    }
+
+    /** @brief get generated code of a query, nullptr if the query is always interpreted */
+    inline const std::shared_ptr<InterpreterJitQuery>& getJitQuery() const {
+        return jitQuery;
+    }
+
+    /** @brief set generated code of a query */
+    inline void setJitQuery(std::shared_ptr<InterpreterJitQuery> q) {
+        jitQuery = std::move(q);
+    }
+
+    /** @brief get compiled constant pattern, nullptr if the pattern is not constant or not valid */
+    inline const RegexCache::RegexPtr& getRegex() const {
+        return regex;
+    }
+
+    /** @brief set compiled constant pattern */
+    inline void setRegex(RegexCache::RegexPtr r) {
+        regex = std::move(r);
+    }
+
     /** @brief get list of all children */
     const std::vector<std::unique_ptr<InterpreterNode>>& getChildren() const {
         return children;
     }
 
-    /** @brief get relation from handle */
-    inline InterpreterRelation* getRelation() const {
-        if (relHandle == nullptr) {
-            assert(false && "No relation cached\n");
-        }
-        return (*relHandle).get();
+    /** @brief get the id of the relation, which is resolved in the environment of the evaluation */
+    inline size_t getRelationId() const {
+        assert(relId != NO_RELATION && "No relation cached\n");
+        return relId;
     }
 
 protected:
     enum InterpreterNodeType type;
     const RamNode* shadow;
     std::vector<std::unique_ptr<InterpreterNode>> children;
-    RelationHandle* const relHandle;
+    const size_t relId;
     std::vector<size_t> data;
     std::shared_ptr<InterpreterPreamble> preamble = nullptr;
+    std::unique_ptr<InterpreterFunctor> functor = nullptr;
+    RegexCache::RegexPtr regex = nullptr;
+    std::shared_ptr<InterpreterJitQuery> jitQuery = nullptr;
 };
 }  // namespace souffle
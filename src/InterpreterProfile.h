@@ -0,0 +1,139 @@
+/*
+ * Souffle - A Datalog Compiler
+ * Copyright (c) 2020, The Souffle Developers. All rights reserved.
+ * Licensed under the Universal Permissive License v 1.0 as shown at:
+ * - https://opensource.org/licenses/UPL
+ * - <souffle root>/licenses/SOUFFLE-UPL.txt
+ */
+
+/************************************************************************
+ *
+ * @file InterpreterProfile.h
+ *
+ * Declares the InterpreterProfile class.
+ * Counters of the profile are assigned to the nodes of the executable tree
+ * when the tree is generated. During the evaluation each thread increments
+ * its own copy of the counters, so that a count costs an array access
+ * rather than a lookup by name and an atomic increment. The copies are
+ * added up once the evaluation is done.
+ ***********************************************************************/
+
+#pragma once
+
+#include "ParallelUtils.h"
+#include <cassert>
+#include <cstddef>
+#include <limits>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace souffle {
+
+/**
+ * @class InterpreterProfile
+ * @brief Per-thread profile counters, indexed by counter id and iteration
+ *
+ * Counters are only incremented from the outer-most parallel region, and the threads
+ * of the region are told apart by their thread number.
+ */
+class InterpreterProfile {
+public:
+    /** Counter id of nodes which are not profiled */
+    static constexpr size_t NO_COUNTER = std::numeric_limits<size_t>::max();
+
+    /** @brief Return the id of the counter with the given text, adding the counter if it is new */
+    size_t encodeCounter(const std::string& text) {
+        auto pos = ids.find(text);
+        if (pos != ids.end()) {
+            return pos->second;
+        }
+        texts.push_back(text);
+        return ids[text] = texts.size() - 1;
+    }
+
+    /** @brief Check whether there is a counter with the given text */
+    bool hasCounter(const std::string& text) const {
+        return ids.count(text) != 0;
+    }
+
+    /** @brief Return the number of counters */
+    size_t getNumCounters() const {
+        return texts.size();
+    }
+
+    /** @brief Return the text of a counter */
+    const std::string& getText(size_t counter) const {
+        return texts[counter];
+    }
+
+    /** @brief Zero all counters and allocate the copies of the given number of threads */
+    void reset(size_t numThreads) {
+        threads.reset(new ThreadCounters[numThreads]);
+        numOfThreads = numThreads;
+        for (size_t i = 0; i < numThreads; ++i) {
+            threads[i].counts.assign(texts.size(), 0);
+        }
+    }
+
+    /** @brief Increment a counter of the calling thread */
+    void inc(size_t counter, size_t iteration) {
+        const size_t thread = getThreadNum();
+        assert(thread < numOfThreads && "more threads than expected");
+        std::vector<size_t>& counts = threads[thread].counts;
+        const size_t pos = iteration * texts.size() + counter;
+        if (pos >= counts.size()) {
+            counts.resize((iteration + 1) * texts.size(), 0);
+        }
+        ++counts[pos];
+    }
+
+    /**
+     * @brief Return the counts of a counter per iteration, added up over the threads.
+     * The counts end with the last iteration in which the counter was incremented,
+     * and include at least the first iteration.
+     */
+    std::vector<size_t> getCounts(size_t counter) const {
+        std::vector<size_t> result(1, 0);
+        for (size_t i = 0; i < numOfThreads; ++i) {
+            const std::vector<size_t>& counts = threads[i].counts;
+            for (size_t pos = counter; pos < counts.size(); pos += texts.size()) {
+                if (counts[pos] == 0) {
+                    continue;
+                }
+                const size_t iteration = pos / texts.size();
+                if (result.size() <= iteration) {
+                    result.resize(iteration + 1, 0);
+                }
+                result[iteration] += counts[pos];
+            }
+        }
+        return result;
+    }
+
+private:
+    /** Counts of one thread in iteration-major order, on cache lines of their own */
+    struct alignas(64) ThreadCounters {
+        std::vector<size_t> counts;
+    };
+
+    static size_t getThreadNum() {
+#ifdef _OPENMP
+        return omp_get_thread_num();
+#else
+        return 0;
+#endif
+    }
+
+    /** Texts of the profile events, indexed by counter id */
+    std::vector<std::string> texts;
+    /** Counter ids, indexed by text */
+    std::map<std::string, size_t> ids;
+    /** Counts of each thread */
+    std::unique_ptr<ThreadCounters[]> threads;
+    /** Number of threads with counts */
+    size_t numOfThreads = 0;
+};
+
+}  // namespace souffle
@@ -19,7 +19,9 @@
 #include "BTree.h"
 #include "Brie.h"
 #include "EquivalenceRelation.h"
+#include "ParallelUtils.h"
 #include "Util.h"
+#include <algorithm>
 #include <utility>
 
 namespace souffle {
@@ -28,7 +30,9 @@ InterpreterRelation::InterpreterRelation(std::size_t arity, std::size_t auxiliar
         std::vector<std::string> attributeTypes, const MinIndexSelection& orderSet, IndexFactory factory)
         : relName(std::move(name)), arity(arity), auxiliaryArity(auxiliaryArity),
           attributeTypes(std::move(attributeTypes)) {
-    for (auto order : orderSet.getAllOrders()) {
+    const auto& allOrders = orderSet.getAllOrders();
+    for (size_t idx = 0; idx < allOrders.size(); ++idx) {
+        auto order = allOrders[idx];
         // Expand the order to a total order
         std::set<int> set;
         for (const auto& i : order) {
@@ -39,11 +43,25 @@ InterpreterRelation::InterpreterRelation(std::size_t arity, std::size_t auxiliar
                 order.push_back(i);
             }
         }
-        indexes.push_back(factory(Order(order)));
+        if (orderSet.isHashIndex(idx) && arity <= MAX_HASH_INDEX_ARITY) {
+            size_t keyLength = orderSet.getHashKeyLength(idx);
+            indexes.push_back(createHashIndex(Order(order), keyLength));
+            hashKeyLengths.push_back(keyLength);
+        } else {
+            indexes.push_back(factory(Order(order)));
+            hashKeyLengths.push_back(0);
+        }
+        orders.push_back(order);
     }
 
-    // Use the first index as default main index
+    // Use the first ordered index as default main index, such that scans are ordered
     main = indexes[0].get();
+    for (size_t idx = 0; idx < indexes.size(); ++idx) {
+        if (hashKeyLengths[idx] == 0) {
+            main = indexes[idx].get();
+            break;
+        }
+    }
 }
 
 void InterpreterRelation::removeIndex(const size_t& indexPos) {
@@ -71,9 +89,69 @@ bool InterpreterRelation::insert(const TupleRef& tuple) {
 }
 
 void InterpreterRelation::insert(const InterpreterRelation& other) {
-    // TODO: cover this in a smarter way
-    for (const auto& cur : other.scan()) {
-        insert(cur);
+    if (other.empty()) {
+        return;
+    }
+
+    // indexes are merged with an index of the other relation sharing their order
+    std::vector<const InterpreterIndex*> sources(indexes.size(), nullptr);
+    bool complete = true;
+    for (size_t i = 0; i < indexes.size(); ++i) {
+        for (size_t j = 0; j < other.indexes.size(); ++j) {
+            if (other.indexes[j] != nullptr && orders[i] == other.orders[j] &&
+                    hashKeyLengths[i] == other.hashKeyLengths[j]) {
+                sources[i] = other.indexes[j].get();
+                break;
+            }
+        }
+        complete = complete && sources[i] != nullptr;
+    }
+
+    // the remaining ones are bulk-inserted from a buffer of all tuples of the other relation
+    std::vector<RamDomain> tuples;
+    if (!complete) {
+        tuples.reserve(other.size() * arity);
+        for (const auto& cur : other.scan()) {
+            for (size_t i = 0; i < arity; ++i) {
+                tuples.push_back(cur[i]);
+            }
+        }
+    }
+    const std::size_t count = tuples.size() / std::max<std::size_t>(arity, 1);
+
+    // indexes are independent of each other
+    PARALLEL_START_IF(indexes.size() > 1)
+    pfor(size_t i = 0; i < indexes.size(); ++i) {
+        if (sources[i] != nullptr) {
+            indexes[i]->insert(*sources[i]);
+        } else {
+            indexes[i]->insertAll(tuples.data(), count);
+        }
+    }
+    PARALLEL_END
+}
+
+void InterpreterRelation::insertAll(const RamDomain* tuples, std::size_t count) {
+    PARALLEL_START_IF(indexes.size() > 1)
+    pfor(size_t i = 0; i < indexes.size(); ++i) {
+        indexes[i]->insertAll(tuples, count);
+    }
+    PARALLEL_END
+}
+
+void InterpreterRelation::seal() {
+    PARALLEL_START_IF(indexes.size() > 1)
+    pfor(size_t i = 0; i < indexes.size(); ++i) {
+        if (indexes[i] != nullptr) {
+            indexes[i]->seal();
+        }
+    }
+    PARALLEL_END
+}
+
+void InterpreterRelation::merge(const RamDomain* tuples, std::size_t count) {
+    for (const auto& cur : indexes) {
+        cur->merge(tuples, count);
     }
 }
 
@@ -104,8 +182,31 @@ PartitionedStream InterpreterRelation::partitionRange(
     return pos->partitionRange(low, high, partitionCount);
 }
 
+int InterpreterRelation::findPrefixIndex(SearchSignature attributes) const {
+    const size_t length = __builtin_popcountll(attributes);
+    for (size_t i = 0; i < indexes.size(); ++i) {
+        if (indexes[i] == nullptr) {
+            continue;
+        }
+        // hash indexes only serve searches binding exactly their key
+        if (hashKeyLengths[i] != 0 && hashKeyLengths[i] != length) {
+            continue;
+        }
+        bool covered = true;
+        for (size_t j = 0; j < length && covered; ++j) {
+            covered = ((attributes >> orders[i][j]) & 1) != 0;
+        }
+        if (covered) {
+            return static_cast<int>(i);
+        }
+    }
+    return -1;
+}
+
 void InterpreterRelation::swap(InterpreterRelation& other) {
     indexes.swap(other.indexes);
+    orders.swap(other.orders);
+    hashKeyLengths.swap(other.hashKeyLengths);
 }
 
 size_t InterpreterRelation::getLevel() const {
@@ -194,6 +295,22 @@ bool InterpreterIndirectRelation::insert(const RamDomain* tuple) {
     return this->insert(TupleRef(tuple, arity));
 }
 
+void InterpreterIndirectRelation::insert(const InterpreterRelation& other) {
+    for (const auto& cur : other.scan()) {
+        insert(cur);
+    }
+}
+
+void InterpreterIndirectRelation::insertAll(const RamDomain* tuples, std::size_t count) {
+    for (std::size_t i = 0; i < count; ++i) {
+        insert(TupleRef(tuples + i * arity, arity));
+    }
+}
+
+void InterpreterIndirectRelation::merge(const RamDomain* tuples, std::size_t count) {
+    insertAll(tuples, count);
+}
+
 void InterpreterIndirectRelation::purge() {
     blockList.clear();
     for (auto& cur : indexes) {
@@ -202,4 +319,49 @@ void InterpreterIndirectRelation::purge() {
     numTuples = 0;
 }
 
+InterpreterCursor::InterpreterCursor(const InterpreterRelation& rel)
+        : arity(rel.getArity()), stream(rel.scan()) {}
+
+InterpreterCursor::InterpreterCursor(const InterpreterRelation& rel, const std::map<size_t, RamDomain>& bound)
+        : arity(rel.getArity()) {
+    SearchSignature attributes = 0;
+    for (const auto& cur : bound) {
+        assert(cur.first < arity && "attribute out of range");
+        attributes |= SearchSignature(1) << cur.first;
+    }
+
+    int indexPos = attributes == 0 ? -1 : rel.findPrefixIndex(attributes);
+    if (indexPos < 0) {
+        // no index covers the bound attributes; scan and filter
+        stream = rel.scan();
+        filter.assign(bound.begin(), bound.end());
+        return;
+    }
+
+    std::vector<RamDomain> low(arity, MIN_RAM_SIGNED);
+    std::vector<RamDomain> high(arity, MAX_RAM_SIGNED);
+    for (const auto& cur : bound) {
+        low[cur.first] = cur.second;
+        high[cur.first] = cur.second;
+    }
+    stream = rel.range(indexPos, TupleRef(low.data(), arity), TupleRef(high.data(), arity));
+}
+
+size_t InterpreterCursor::next(std::vector<RamDomain>& buffer, size_t max) {
+    size_t count = 0;
+    for (auto it = stream.begin(); count < max && it != stream.end(); ++it) {
+        const TupleRef& tuple = *it;
+        bool matches = true;
+        for (const auto& cur : filter) {
+            matches = matches && tuple[cur.first] == cur.second;
+        }
+        if (!matches) {
+            continue;
+        }
+        buffer.insert(buffer.end(), tuple.getBase(), tuple.getBase() + arity);
+        ++count;
+    }
+    return count;
+}
+
 }  // namespace souffle
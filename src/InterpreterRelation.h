@@ -18,6 +18,10 @@
 
 #include "InterpreterIndex.h"
 #include "RamIndexAnalysis.h"
+#include "RamTypes.h"
+#include <map>
+#include <utility>
+#include <vector>
 
 namespace souffle {
 /**
@@ -26,7 +30,9 @@ namespace souffle {
 class InterpreterRelation {
 public:
     /**
-     * Creates a relation, build all necessary indexes.
+     * Creates a relation, build all necessary indexes. Orders chosen for hash
+     * indexes by the index selection are stored in hash indexes, all other
+     * orders in indexes obtained from the factory.
      */
     InterpreterRelation(std::size_t arity, std::size_t auxiliaryArity, std::string name,
             std::vector<std::string> attributeTypes, const MinIndexSelection& orderSet,
@@ -101,9 +107,30 @@ public:
     }
 
     /**
-     * Add all entries of the given relation to this relation.
+     * Add all entries of the given relation to this relation. Each index is
+     * merged in bulk with the index of the other relation sharing its order,
+     * or with the sorted tuples of the other relation; indexes are merged in
+     * parallel. Not to be called concurrently with other operations on this relation.
      */
-    void insert(const InterpreterRelation& other);
+    virtual void insert(const InterpreterRelation& other);
+
+    /**
+     * Add a row-major buffer of the given number of tuples to this relation;
+     * indexes are built in parallel.
+     */
+    virtual void insertAll(const RamDomain* tuples, std::size_t count);
+
+    /**
+     * Complete the insertions so far, e.g. after loading the relation;
+     * indexes deferring their organisation are built in parallel.
+     */
+    void seal();
+
+    /**
+     * Add a row-major buffer of the given number of tuples to this relation
+     * while other threads may insert into it as well.
+     */
+    virtual void merge(const RamDomain* tuples, std::size_t count);
 
     /**
      * Tests whether this relation contains the given tuple.
@@ -136,6 +163,12 @@ public:
     PartitionedStream partitionRange(
             const size_t& indexPos, const TupleRef& low, const TupleRef& high, size_t partitionCount) const;
 
+    /**
+     * Return the position of an index whose order starts with the given attributes,
+     * or -1 if there is no such index.
+     */
+    int findPrefixIndex(SearchSignature attributes) const;
+
     /**
      * Swaps the content of this and the given relation, including the
      * installed indexes.
@@ -220,6 +253,12 @@ protected:
     // a pointer to the main index within the managed index
     InterpreterIndex* main;
 
+    // the lexicographical orders of the managed indexes
+    std::vector<std::vector<int>> orders;
+
+    // the key lengths of the managed indexes, 0 for ordered indexes
+    std::vector<size_t> hashKeyLengths;
+
     // relation level
     size_t level = 0;
 };  // namespace souffle
@@ -248,6 +287,15 @@ public:
 
     bool insert(const RamDomain* tuple) override;
 
+    /** Insert the tuples of the given relation one by one */
+    void insert(const InterpreterRelation& other) override;
+
+    /** Insert tuples one by one; indexes only hold references into the blocks */
+    void insertAll(const RamDomain* tuples, std::size_t count) override;
+
+    /** Insert tuples one by one */
+    void merge(const RamDomain* tuples, std::size_t count) override;
+
     /** Clear all indexes */
     void purge() override;
 
@@ -259,4 +307,38 @@ private:
 
     size_t numTuples = 0;
 };
+
+/**
+ * A cursor delivering the tuples of a relation chunk by chunk, optionally
+ * restricted to the tuples with given values on some attributes. If an index
+ * starts with the bound attributes, only the matching range is visited.
+ *
+ * The relation must neither be modified nor destroyed while the cursor is in use.
+ */
+class InterpreterCursor {
+public:
+    /** Cursor over all tuples of the relation */
+    explicit InterpreterCursor(const InterpreterRelation& rel);
+
+    /** Cursor over the tuples with the given values on the bound attributes (attribute -> value) */
+    InterpreterCursor(const InterpreterRelation& rel, const std::map<size_t, RamDomain>& bound);
+
+    /**
+     * Append up to max tuples in row-major order to the buffer.
+     * Return the number of tuples appended; 0 once the cursor is exhausted.
+     */
+    size_t next(std::vector<RamDomain>& buffer, size_t max);
+
+    /** Return the arity of the delivered tuples */
+    size_t getArity() const {
+        return arity;
+    }
+
+private:
+    size_t arity;
+    Stream stream;
+    /** Bound attributes not covered by the range of the stream */
+    std::vector<std::pair<size_t, RamDomain>> filter;
+};
+
 }  // end of namespace souffle
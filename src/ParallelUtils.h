@@ -18,6 +18,7 @@
 #pragma once
 
 #include <atomic>
+#include <cstddef>
 
 #ifdef _OPENMP
 
@@ -35,6 +36,13 @@
 #define PARALLEL_START _Pragma("omp parallel") {
 #define PARALLEL_END }
 
+// support for a parallel region which is only forked if the condition holds
+#define PARALLEL_PRAGMA(DIRECTIVE) _Pragma(#DIRECTIVE)
+#define PARALLEL_START_IF(COND) PARALLEL_PRAGMA(omp parallel if(COND)) {
+
+// support for a block executed by one thread of a parallel region at a time
+#define PARALLEL_CRITICAL _Pragma("omp critical")
+
 // support for parallel loops
 #define pfor _Pragma("omp for schedule(dynamic)") for
 
@@ -63,6 +71,10 @@
 // support for a parallel region => sequential execution
 #define PARALLEL_START {
 #define PARALLEL_END }
+#define PARALLEL_START_IF(COND) {
+
+// critical blocks are executed by the only thread
+#define PARALLEL_CRITICAL
 
 // support for parallel loops => simple sequential loop
 #define pfor for
@@ -94,8 +106,10 @@
 
 #ifdef IS_PARALLEL
 #define MAX_THREADS (omp_get_max_threads())
+#define THREAD_NUM (static_cast<std::size_t>(omp_get_thread_num()))
 #else
 #define MAX_THREADS (1)
+#define THREAD_NUM (std::size_t(0))
 #endif
 
 #ifdef IS_PARALLEL
@@ -27,6 +27,7 @@
 #include <iomanip>
 #include <iostream>
 #include <list>
+#include <map>
 #include <mutex>
 #include <sstream>
 #include <string>
@@ -45,6 +46,9 @@ class ProfileEventSingleton {
     /** profile database */
     profile::ProfileDatabase database;
     std::string filename{""};
+    /** time each thread spent on the partitions of parallel loops */
+    std::map<size_t, microseconds> busyTimes;
+    std::mutex busyTimeMutex;
 
     ProfileEventSingleton() = default;
 
@@ -85,6 +89,21 @@ public:
         profile::EventProcessorSingleton::instance().process(database, txt.c_str(), number, iteration);
     }
 
+    /** add the time a thread spent on the partitions of a parallel loop */
+    void addBusyTime(size_t thread, microseconds busy) {
+        std::lock_guard<std::mutex> guard(busyTimeMutex);
+        busyTimes[thread] += busy;
+    }
+
+    /** create busy time events, one per thread */
+    void makeBusyTimeEvents() {
+        std::lock_guard<std::mutex> guard(busyTimeMutex);
+        for (const auto& cur : busyTimes) {
+            size_t busy = cur.second.count();
+            makeQuantityEvent("@parallel-busy;" + std::to_string(cur.first), busy, 0);
+        }
+    }
+
     /** create utilisation event */
     void makeUtilisationEvent(const std::string& txt) {
         /* current time */
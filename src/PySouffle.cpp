@@ -10,6 +10,7 @@
 #include "DebugReport.h"
 #include "DebugReporter.h"
 #include "ErrorReport.h"
+#include "EvaluationBudget.h"
 #include "Explain.h"
 #include "Global.h"
 #include "InterpreterEngine.h"
@@ -23,28 +24,46 @@
 #include "RamTransforms.h"
 #include "RamTranslationUnit.h"
 #include "RamTypes.h"
+#include "SouffleInterface.h"
 #include "Synthesiser.h"
 #include "Util.h"
 #include "config.h"
 #include "profile/Tui.h"
+#include <atomic>
 #include <cassert>
 #include <chrono>
+#include <condition_variable>
 #include <cstdio>
 #include <cstdlib>
+#include <deque>
 #include <fstream>
+#include <functional>
+#include <future>
 #include <iostream>
+#include <iterator>
+#include <list>
 #include <memory>
+#include <mutex>
 #include <set>
+#include <sstream>
 #include <stdexcept>
 #include <string>
 #include <thread>
+#include <unordered_map>
 #include <utility>
 #include <vector>
 #include <regex>
+#include <dlfcn.h>
+#include <unistd.h>
+#include <sys/stat.h>
 
 #include <pybind11/pybind11.h>
+#include <pybind11/numpy.h>
 #include <pybind11/stl.h>
 
+using namespace souffle;
+namespace py = pybind11;
+
 int executeBinary(const std::string& binaryFilename) {
     assert(!binaryFilename.empty() && "binary filename cannot be blank");
 
@@ -78,11 +97,13 @@ int executeBinary(const std::string& binaryFilename) {
 }
 
 /**
- * Compiles the given source file to a binary file.
+ * Compiles the given source file to a binary file. Libraries are listed after the source file,
+ * such that linkers dropping libraries not needed so far keep the ones it refers to.
  */
-void compileToBinary(std::string compileCmd, const std::string& sourceFilename) {
+void compileToBinary(
+        std::string compileCmd, const std::string& sourceFilename, const std::string& linkFlags = "") {
     // add source code
-    compileCmd += ' ';
+    compileCmd += ' ' + sourceFilename + ' ';
     for (const std::string& path : splitString(Global::config().get("library-dir"), ' ')) {
         // The first entry may be blank
         if (path.empty()) {
@@ -97,8 +118,7 @@ void compileToBinary(std::string compileCmd, const std::string& sourceFilename)
         }
         compileCmd += "-l" + library + ' ';
     }
-
-    compileCmd += sourceFilename;
+    compileCmd += linkFlags;
 
     // run executable
     if (system(compileCmd.c_str()) != 0) {
@@ -278,63 +298,872 @@ int check_ram_err(const std::unique_ptr<RamTranslationUnit> &ramTranslationUnit)
 }
 
 
-std::map<std::string, std::vector<std::string>> execute(std::string code, bool get_prov){
+/**
+ * Options of the compiled-program tier. When enabled, programs are synthesised
+ * to C++, built as shared libraries in the cache directory and loaded with dlopen.
+ */
+struct CompileOptions {
+    bool enabled = false;
+    std::string cacheDir = ".souffle_cache";
+    /** Compiler command and flags; the output and source file are appended */
+    std::string compiler;
+    std::string includeDir;
+
+    /** Return the compiler command used when none is given */
+    static std::string defaultCompiler() {
+        const char* cxx = std::getenv("CXX");
+        std::string cmd = cxx != nullptr ? cxx : "c++";
+        cmd += " -std=c++17 -O3 -fPIC -fopenmp";
+#if RAM_DOMAIN_SIZE == 64
+        cmd += " -DRAM_DOMAIN_SIZE=64";
+#endif
+        return cmd;
+    }
+};
+
+/**
+ * A synthesised program built as a shared library. Libraries are cached on disk by the hash of
+ * their source, which carries a stamp of the souffle version, the interface headers and the
+ * compile command. The source is stored next to the library and compared before the library is
+ * loaded; the sources of colliding hashes take the next free slot.
+ */
+class CompiledLibrary {
+public:
+    CompiledLibrary(RamTranslationUnit& tUnit, size_t key, const CompileOptions& options) {
+        if (!existDir(options.cacheDir) && mkdir(options.cacheDir.c_str(), 0755) != 0) {
+            throw std::runtime_error("cannot create cache directory <" + options.cacheDir + ">");
+        }
+        std::stringstream id;
+        id << "souffle_" << std::hex << key;
+
+        std::string compileCmd = options.compiler.empty() ? CompileOptions::defaultCompiler()
+                                                           : options.compiler;
+        compileCmd += " -shared -D__EMBEDDED_SOUFFLE__";
+        if (!options.includeDir.empty()) {
+            compileCmd += " -I" + options.includeDir;
+        }
+
+        bool withSharedLibrary = false;
+        std::stringstream program;
+        Synthesiser(tUnit).generateCode(program, id.str(), withSharedLibrary);
+        const std::string linkFlags = withSharedLibrary ? functorLinkFlags() : "";
+
+        std::stringstream source;
+        source << "// souffle " << PACKAGE_VERSION << ", interface " << getInterfaceStamp(options.includeDir)
+               << "\n// " << compileCmd << " -L" << Global::config().get("library-dir") << " -l"
+               << Global::config().get("libraries") << linkFlags << "\n";
+        source << program.str();
+        // the factory registry of the library is not visible to us; export an entry point
+        source << "extern \"C\" souffle::SouffleProgram* souffle_newInstance() {\n";
+        source << "return souffle::ProgramFactory::newInstance(\"" << id.str() << "\");\n";
+        source << "}\n";
+        const std::string code = source.str();
+
+        std::stringstream name;
+        name << options.cacheDir << "/souffle_" << std::hex << std::hash<std::string>()(code);
+        for (size_t slot = 0;; ++slot) {
+            const std::string baseFilename = name.str() + (slot == 0 ? "" : "_" + std::to_string(slot));
+            const std::string sourceFilename = baseFilename + ".cpp";
+            const std::string libraryFilename = baseFilename + ".so";
+            const bool cached = existFile(sourceFilename);
+            if (cached && readFile(sourceFilename) != code) {
+                continue;
+            }
+            if (!cached || !existFile(libraryFilename)) {
+                build(code, baseFilename, compileCmd, linkFlags);
+            }
+            load(libraryFilename);
+            return;
+        }
+    }
+
+    CompiledLibrary(const CompiledLibrary&) = delete;
+    CompiledLibrary& operator=(const CompiledLibrary&) = delete;
+
+    ~CompiledLibrary() {
+        dlclose(handle);
+    }
+
+    /** Create a fresh instance of the program; instances are independent of each other */
+    std::unique_ptr<SouffleProgram> newInstance() const {
+        return std::unique_ptr<SouffleProgram>(factory());
+    }
+
+private:
+    /**
+     * Compile the source into the library of the given base name. Concurrent builders work on
+     * private files and install them by renaming, the library before its source.
+     */
+    static void build(const std::string& code, const std::string& baseFilename, std::string compileCmd,
+            const std::string& linkFlags) {
+        std::string tmpFilename = baseFilename + ".XXXXXX";
+        int fd = mkstemp(&tmpFilename[0]);
+        if (fd == -1) {
+            throw std::runtime_error("cannot create a temporary file for <" + baseFilename + ">");
+        }
+        close(fd);
+        const std::string sourceFilename = tmpFilename + ".cpp";
+        const std::string libraryFilename = tmpFilename + ".so";
+        {
+            std::ofstream os(sourceFilename);
+            os << code;
+        }
+        compileCmd += " -o " + libraryFilename;
+        try {
+            compileToBinary(compileCmd, sourceFilename, linkFlags);
+            if (std::rename(libraryFilename.c_str(), (baseFilename + ".so").c_str()) != 0 ||
+                    std::rename(sourceFilename.c_str(), (baseFilename + ".cpp").c_str()) != 0) {
+                throw std::runtime_error("cannot install library <" + baseFilename + ".so>");
+            }
+        } catch (...) {
+            std::remove(sourceFilename.c_str());
+            std::remove(libraryFilename.c_str());
+            std::remove(tmpFilename.c_str());
+            throw;
+        }
+        std::remove(tmpFilename.c_str());
+    }
+
+    void load(const std::string& libraryFilename) {
+        handle = dlopen(libraryFilename.c_str(), RTLD_NOW | RTLD_LOCAL);
+        if (handle == nullptr) {
+            throw std::runtime_error("cannot load library <" + libraryFilename + ">: " + dlerror());
+        }
+        factory = reinterpret_cast<SouffleProgram* (*)()>(dlsym(handle, "souffle_newInstance"));
+        if (factory == nullptr) {
+            dlclose(handle);
+            throw std::runtime_error("library <" + libraryFilename + "> has no program");
+        }
+    }
+
+    static std::string readFile(const std::string& filename) {
+        std::ifstream in(filename);
+        return std::string(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+    }
+
+    /** Return a hash of the headers compiled programs are built against; they define their interface */
+    static std::string getInterfaceStamp(const std::string& includeDir) {
+        std::string headers;
+        for (const char* header : {"souffle/SouffleInterface.h", "souffle/CompiledSouffle.h"}) {
+            headers += readFile((includeDir.empty() ? "" : includeDir + "/") + header);
+        }
+        std::stringstream stamp;
+        stamp << std::hex << std::hash<std::string>()(headers);
+        return stamp.str();
+    }
+
+    /**
+     * Return the flags linking user-defined functors against the functor libraries. As with
+     * souffle -c, the library "functors" in the current directory is used unless configured
+     * otherwise; configured libraries are added by compileToBinary. The library directories
+     * are recorded as run paths, such that dlopen resolves the functors.
+     */
+    static std::string functorLinkFlags() {
+        std::string flags;
+        std::string libraryDirs = ".";
+        if (Global::config().has("library-dir")) {
+            libraryDirs = Global::config().get("library-dir");
+        } else {
+            flags += " -L.";
+        }
+        if (!Global::config().has("libraries")) {
+            flags += " -lfunctors";
+        }
+        for (const std::string& path : splitString(libraryDirs, ' ')) {
+            // The first entry may be blank; directories which do not exist are skipped
+            const std::string dir = path.empty() ? "" : absPath(path);
+            if (!dir.empty()) {
+                flags += " -Wl,-rpath," + dir;
+            }
+        }
+        return flags;
+    }
+
+    void* handle = nullptr;
+    SouffleProgram* (*factory)() = nullptr;
+};
+
+/**
+ * A program that has been parsed, transformed and translated once and can
+ * be executed repeatedly with fresh EDB contents.
+ */
+class Program {
+public:
+    using Tuples = std::vector<std::vector<std::string>>;
+    using Facts = std::map<std::string, Tuples>;
+
+    /**
+     * Column-wise facts of one input relation. Numeric attributes refer to a
+     * contiguous buffer of raw values, symbol attributes to a list of strings.
+     */
+    struct InputColumns {
+        size_t size = 0;
+        std::vector<const RamDomain*> values;
+        std::vector<std::vector<std::string>> symbols;
+    };
+    using Inputs = std::map<std::string, InputColumns>;
+
+    Program(const std::string& code, size_t key, const CompileOptions& options = {})
+            : code(code), key(key) {
+        astUnit = ParserDriver::parseTranslationUnit(code, errReport, debugReport);
+        get_ast_transformer()->apply(*astUnit);
+        if (check_ast_err(astUnit) != 0) {
+            throw std::invalid_argument("errors in AST phase, program rejected");
+        }
+
+        tUnit = AstTranslator().translateUnit(*astUnit);
+        get_ram_transformer()->apply(*tUnit);
+        if (check_ram_err(tUnit) != 0) {
+            throw std::invalid_argument("errors in RAM phase, program rejected");
+        }
+
+        engine = std::make_unique<InterpreterEngine>(*tUnit);
+        engine->generateMain();
+
+        if (options.enabled) {
+            try {
+                library = std::make_unique<CompiledLibrary>(*tUnit, key, options);
+            } catch (const std::exception& e) {
+                std::cerr << "Warning: falling back to the interpreter, " << e.what() << std::endl;
+            }
+        }
+    }
+
+    /** Execute the program on the given facts, returning the output relations */
+    std::map<std::string, std::vector<std::string>> run(const Facts& facts = {}, const Inputs& inputs = {}) {
+        if (library != nullptr && inputs.empty()) {
+            return runCompiled(facts);
+        }
+        return interpret(facts, inputs);
+    }
+
+    /** Execute the program on the interpreter, which keeps the relations for provenance queries */
+    std::map<std::string, std::vector<std::string>> interpret(
+            const Facts& facts = {}, const Inputs& inputs = {}) {
+        std::lock_guard<std::mutex> guard(lock);
+        prepare(facts, inputs);
+        execute();
+        return engine->get_execute_result();
+    }
+
+    /**
+     * Execute the program on the interpreter and explain the derivations of its target relation,
+     * or explore them; the engine is held until the explanation is done
+     */
+    std::map<std::string, std::vector<std::string>> explain() {
+        std::lock_guard<std::mutex> guard(lock);
+        prepare({}, {});
+        execute();
+        std::map<std::string, std::vector<std::string>> result = engine->get_execute_result();
+
+        InterpreterProgInterface interface(*engine);
+        const std::string& mode = Global::config().get("provenance");
+        auto it = result.find("target");
+        if (it != result.end()) {
+            for (const auto& target : it->second) {
+                souffle::explain(interface, false, mode == "subtreeHeights", "target(" + target + ")");
+            }
+        } else if (mode == "explore") {
+            souffle::explain(interface, true, false);
+        }
+        return result;
+    }
+
+    /**
+     * Execute the program on many independent fact sets, returning the output
+     * relations of each. Fact sets are evaluated concurrently, each in its own
+     * environment, while sharing the translated program.
+     */
+    std::vector<std::map<std::string, std::vector<std::string>>> runBatch(const std::vector<Facts>& bundles) {
+        std::lock_guard<std::mutex> guard(lock);
+        if (engine->getEnvironment().getBudget().hasMemoryLimit()) {
+            throw std::invalid_argument(
+                    "the memory limit is process-wide, it cannot limit the fact sets of a batch");
+        }
+        // environments are kept for the next batch to save re-creating the relations
+        while (batchEnvs.size() < bundles.size()) {
+            batchEnvs.push_back(engine->createEnvironment());
+        }
+        std::vector<InterpreterEnvironment*> batch;
+        for (size_t i = 0; i < bundles.size(); ++i) {
+            InterpreterEnvironment& env = *batchEnvs[i];
+            env.reset();
+            for (const auto& cur : bundles[i]) {
+                load(env, cur.first, cur.second);
+            }
+            batch.push_back(&env);
+        }
+
+        engine->executeBatch(batch);
+
+        std::vector<std::map<std::string, std::vector<std::string>>> results;
+        results.reserve(batch.size());
+        batchStatus.clear();
+        for (InterpreterEnvironment* env : batch) {
+            results.push_back(std::move(env->getResult()));
+            batchStatus.push_back(EvaluationBudget::getStatusText(env->getBudget().getStatus()));
+            env->reset();
+        }
+        return results;
+    }
+
+    /**
+     * Limit the time in milliseconds, the number of derived tuples and the resident
+     * memory in megabytes of later evaluations; zero is no limit. An evaluation which
+     * exceeds a limit stops early and returns the relations computed so far. The memory
+     * limit is on the resident memory of the whole process, shared with evaluations
+     * running at the same time; batches reject it.
+     */
+    void setLimits(size_t time, size_t tuples, size_t memory) {
+        std::lock_guard<std::mutex> guard(lock);
+        EvaluationBudget& budget = engine->getEnvironment().getBudget();
+        budget.setTimeLimit(std::chrono::milliseconds(time));
+        budget.setTupleLimit(tuples);
+        budget.setMemoryLimit(memory << 20);
+        for (auto& env : batchEnvs) {
+            env->getBudget().setLimits(budget);
+        }
+    }
+
+    /** Return the outcome of the last evaluation, e.g., whether it exceeded a limit */
+    std::string getStatus() const {
+        return EvaluationBudget::getStatusText(status.load());
+    }
+
+    /** Return the outcome of the evaluation of each fact set of the last batch */
+    std::vector<std::string> getBatchStatus() {
+        std::lock_guard<std::mutex> guard(lock);
+        return batchStatus;
+    }
+
+    /** Column-wise result of one output relation */
+    struct Columns {
+        std::vector<std::string> names;
+        std::vector<std::string> types;
+        std::vector<std::vector<RamDomain>> data;
+    };
+
+    /** Execute the program on the given facts, returning the output relations column-wise */
+    std::map<std::string, Columns> runColumnar(const Facts& facts = {}, const Inputs& inputs = {}) {
+        std::lock_guard<std::mutex> guard(lock);
+        prepare(facts, inputs);
+        engine->setStringOutput(false);
+        execute();
+        engine->setStringOutput(true);
+
+        std::map<std::string, Columns> result;
+        for (const std::string& name : engine->getOutputRelationNames()) {
+            const RamRelation& ramRel = getRamRelation(name);
+            Columns& columns = result[name];
+            columns.names = ramRel.getAttributeNames();
+            columns.types = ramRel.getAttributeTypes();
+            columns.data = engine->getColumns(name);
+        }
+        return result;
+    }
+
+    /**
+     * Evaluate the program on the given facts without rendering the output
+     * relations; they are read through cursors instead. Return the names of
+     * the output relations.
+     */
+    std::vector<std::string> evaluate(const Facts& facts = {}, const Inputs& inputs = {}) {
+        std::lock_guard<std::mutex> guard(lock);
+        prepare(facts, inputs);
+        engine->setStringOutput(false);
+        execute();
+        engine->setStringOutput(true);
+        return engine->getOutputRelationNames();
+    }
+
+    /**
+     * A cursor over a relation of the last evaluation of the interpreter. Tuples
+     * are fetched in chunks; a cursor becomes invalid once the program is run again.
+     */
+    class Cursor {
+    public:
+        /** Open a cursor; bound maps attributes to values, given as strings as for facts */
+        Cursor(std::shared_ptr<Program> prog, const std::string& name,
+                const std::map<size_t, std::string>& bound)
+                : program(std::move(prog)), types(program->getAttributeTypes(name)) {
+            std::lock_guard<std::mutex> guard(program->lock);
+            generation = program->generation;
+            InterpreterRelation* rel = program->engine->getRelation(name);
+            if (rel == nullptr) {
+                throw std::invalid_argument("unknown relation <" + name + ">");
+            }
+            std::map<size_t, RamDomain> values;
+            const SymbolTable& symTable = program->tUnit->getSymbolTable();
+            for (const auto& cur : bound) {
+                if (cur.first >= rel->getArity()) {
+                    throw std::invalid_argument("attribute out of range for relation <" + name + ">");
+                }
+                const std::string& value = cur.second;
+                switch (types[cur.first][0]) {
+                    case 's':
+                        // an unknown symbol matches no tuple
+                        if (!symTable.contains(value)) {
+                            return;
+                        }
+                        values[cur.first] = symTable.lookupExisting(value);
+                        break;
+                    case 'u':
+                        values[cur.first] = ramBitCast(RamUnsignedFromString(value));
+                        break;
+                    case 'f':
+                        values[cur.first] = ramBitCast(RamFloatFromString(value));
+                        break;
+                    default:
+                        values[cur.first] = RamSignedFromString(value);
+                }
+            }
+            cursor = std::make_unique<InterpreterCursor>(*rel, values);
+        }
+
+        /** Append up to max tuples, row-major, to the buffer; return the number of tuples */
+        size_t fetch(std::vector<RamDomain>& buffer, size_t max) {
+            std::lock_guard<std::mutex> guard(program->lock);
+            if (generation != program->generation) {
+                throw std::runtime_error("cursor invalidated by a later run of the program");
+            }
+            return cursor == nullptr ? 0 : cursor->next(buffer, max);
+        }
+
+        const std::vector<std::string>& getAttributeTypes() const {
+            return types;
+        }
+
+        Program& getProgram() {
+            return *program;
+        }
+
+        /** Take the next tuple fetched ahead for element-wise iteration; false if none is left */
+        bool popPending(std::vector<RamDomain>& tuple) {
+            const size_t arity = types.size();
+            if (pendingPos >= pending.size()) {
+                return false;
+            }
+            tuple.assign(pending.begin() + pendingPos, pending.begin() + pendingPos + arity);
+            pendingPos += arity;
+            return true;
+        }
+
+        /** Keep a fetched chunk of tuples for element-wise iteration, after those still pending */
+        void pushPending(const std::vector<RamDomain>& chunk) {
+            pending.erase(pending.begin(), pending.begin() + pendingPos);
+            pendingPos = 0;
+            pending.insert(pending.end(), chunk.begin(), chunk.end());
+        }
+
+    private:
+        std::shared_ptr<Program> program;
+        std::vector<std::string> types;
+        size_t generation = 0;
+        std::unique_ptr<InterpreterCursor> cursor;
+        /** Tuples fetched ahead for element-wise iteration; only accessed holding the GIL */
+        std::vector<RamDomain> pending;
+        size_t pendingPos = 0;
+    };
+
+    /** Resolve the id of a symbol */
+    const std::string& resolveSymbol(RamDomain id) const {
+        return tUnit->getSymbolTable().resolve(id);
+    }
+
+    /** Resolve symbol ids of a symbol column */
+    std::vector<std::string> resolveSymbols(const std::vector<RamDomain>& ids) {
+        const SymbolTable& symTable = tUnit->getSymbolTable();
+        std::vector<std::string> symbols;
+        symbols.reserve(ids.size());
+        for (RamDomain id : ids) {
+            symbols.push_back(symTable.resolve(id));
+        }
+        return symbols;
+    }
+
+    const std::string& getCode() const {
+        return code;
+    }
+
+    size_t getKey() const {
+        return key;
+    }
+
+    /** Return the attribute types of the given relation */
+    const std::vector<std::string>& getAttributeTypes(const std::string& name) const {
+        return getRamRelation(name).getAttributeTypes();
+    }
+
+    /** Check whether the program runs as a compiled library */
+    bool isCompiled() const {
+        return library != nullptr;
+    }
+
+private:
+    /** Execute the main program on the interpreter, recording the outcome */
+    void execute() {
+        engine->executeMain();
+        status = engine->getEnvironment().getBudget().getStatus();
+    }
+
+    /**
+     * Execute the compiled program on the given facts. Every execution works on
+     * its own program instance, hence no lock is needed.
+     */
+    std::map<std::string, std::vector<std::string>> runCompiled(const Facts& facts) {
+        std::unique_ptr<SouffleProgram> prog = library->newInstance();
+        {
+            std::lock_guard<std::mutex> guard(lock);
+            prog->getBudget().setLimits(engine->getEnvironment().getBudget());
+        }
+        for (const auto& cur : facts) {
+            Relation* rel = prog->getRelation(cur.first);
+            if (rel == nullptr) {
+                throw std::invalid_argument("unknown input relation <" + cur.first + ">");
+            }
+            const size_t arity = rel->getArity();
+            for (const auto& values : cur.second) {
+                if (values.size() != arity) {
+                    throw std::invalid_argument("tuple of wrong arity for relation <" + cur.first + ">");
+                }
+                souffle::tuple tuple(rel);
+                for (size_t i = 0; i < arity; ++i) {
+                    switch (rel->getAttrType(i)[0]) {
+                        case 's':
+                            tuple << values[i];
+                            break;
+                        case 'u':
+                            tuple << RamUnsignedFromString(values[i]);
+                            break;
+                        case 'f':
+                            tuple << RamFloatFromString(values[i]);
+                            break;
+                        default:
+                            tuple << RamSignedFromString(values[i]);
+                    }
+                }
+                rel->insert(tuple);
+            }
+        }
 
-    std::list<std::string> result = {};
-    setup_config();
+        prog->run();
+        status = prog->getBudget().getStatus();
+
+        // render the output relations like the string writer of the interpreter
+        std::map<std::string, std::vector<std::string>> result;
+        for (Relation* rel : prog->getOutputRelations()) {
+            const size_t arity = rel->getArity() - rel->getAuxiliaryArity();
+            std::stringstream ss;
+            for (souffle::tuple tuple : *rel) {
+                if (arity == 0) {
+                    ss << "()\n";
+                    continue;
+                }
+                for (size_t i = 0; i < arity; ++i) {
+                    if (i > 0) {
+                        ss << '\t';
+                    }
+                    switch (rel->getAttrType(i)[0]) {
+                        case 's': {
+                            std::string value;
+                            tuple >> value;
+                            ss << value;
+                            break;
+                        }
+                        case 'u': {
+                            RamUnsigned value;
+                            tuple >> value;
+                            ss << value;
+                            break;
+                        }
+                        case 'f': {
+                            RamFloat value;
+                            tuple >> value;
+                            ss << value;
+                            break;
+                        }
+                        default: {
+                            RamSigned value;
+                            tuple >> value;
+                            ss << value;
+                        }
+                    }
+                }
+                ss << '\n';
+            }
+            result[rel->getName()] = splitString(ss.str(), '\n');
+        }
+        return result;
+    }
+
+    /** Reset the engine and load the EDB for the next execution */
+    void prepare(const Facts& facts, const Inputs& inputs) {
+        engine->reset();
+        ++generation;
+        InterpreterEnvironment& env = engine->getEnvironment();
+        for (const auto& cur : facts) {
+            load(env, cur.first, cur.second);
+        }
+        for (const auto& cur : inputs) {
+            load(env, cur.first, cur.second);
+        }
+    }
+
+    /** Bulk-load column-wise facts into an input relation */
+    void load(InterpreterEnvironment& env, const std::string& name, const InputColumns& columns) {
+        InterpreterRelation* rel = env.getRelation(name);
+        if (rel == nullptr) {
+            throw std::invalid_argument("unknown input relation <" + name + ">");
+        }
+        const size_t arity = rel->getArity();
+        if (columns.values.size() != arity || columns.symbols.size() != arity) {
+            throw std::invalid_argument("wrong number of columns for relation <" + name + ">");
+        }
+
+        // transpose columns into a row-major buffer
+        const size_t count = columns.size;
+        std::vector<RamDomain> tuples(count * arity);
+        SymbolTable& symTable = tUnit->getSymbolTable();
+        for (size_t i = 0; i < arity; ++i) {
+            if (columns.values[i] != nullptr) {
+                const RamDomain* column = columns.values[i];
+                for (size_t j = 0; j < count; ++j) {
+                    tuples[j * arity + i] = column[j];
+                }
+                continue;
+            }
+
+            // intern the whole symbol column at once
+            const std::vector<std::string>& symbols = columns.symbols[i];
+            if (symbols.size() != count) {
+                throw std::invalid_argument("symbol column of wrong length for relation <" + name + ">");
+            }
+            symTable.insert(symbols);
+            auto lease = symTable.acquireLock();
+            (void)lease;
+            for (size_t j = 0; j < count; ++j) {
+                tuples[j * arity + i] = symTable.unsafeLookup(symbols[j]);
+            }
+        }
+
+        rel->insertAll(tuples.data(), count);
+        env.setInputLoaded(name);
+    }
+
+    /** Insert the given tuples into an input relation */
+    void load(InterpreterEnvironment& env, const std::string& name, const Tuples& tuples) {
+        InterpreterRelation* rel = env.getRelation(name);
+        if (rel == nullptr) {
+            throw std::invalid_argument("unknown input relation <" + name + ">");
+        }
+
+        const std::vector<std::string>& types = getRamRelation(name).getAttributeTypes();
+        const size_t arity = rel->getArity();
+        SymbolTable& symTable = tUnit->getSymbolTable();
+        std::vector<RamDomain> tuple(arity);
+        for (const auto& cur : tuples) {
+            if (cur.size() != arity) {
+                throw std::invalid_argument("tuple of wrong arity for relation <" + name + ">");
+            }
+            for (size_t i = 0; i < arity; ++i) {
+                switch (types[i][0]) {
+                    case 's':
+                        tuple[i] = symTable.lookup(cur[i]);
+                        break;
+                    case 'u':
+                        tuple[i] = ramBitCast(RamUnsignedFromString(cur[i]));
+                        break;
+                    case 'f':
+                        tuple[i] = ramBitCast(RamFloatFromString(cur[i]));
+                        break;
+                    default:
+                        tuple[i] = RamSignedFromString(cur[i]);
+                }
+            }
+            rel->insert(tuple.data());
+        }
+        rel->seal();
+        env.setInputLoaded(name);
+    }
+
+    /** Return the RAM relation of the given name */
+    const RamRelation& getRamRelation(const std::string& name) const {
+        for (const RamRelation* cur : tUnit->getProgram().getRelations()) {
+            if (cur->getName() == name) {
+                return *cur;
+            }
+        }
+        throw std::invalid_argument("unknown relation <" + name + ">");
+    }
+
+    std::string code;
+    size_t key;
+    ErrorReport errReport{true};  // no-warning
     DebugReport debugReport;
-    ErrorReport errReport(true); // no-warning
-
-    // Generate AST and do AST transformation
-    std::unique_ptr<AstTranslationUnit> astTranslationUnit = get_ast(code, debugReport, errReport);
-    auto astTransformer = get_ast_transformer();
-    astTransformer->apply(*astTranslationUnit);
-    check_ast_err(astTranslationUnit);
-    
-
-    // Translate AST to RAM 
-    // TODO: change translate unit to accept fact strings
-    
-    std::cout << "RAM: start phase: astTranslationUnit " << astTranslationUnit.get() << std::endl;
-    std::unique_ptr<RamTranslationUnit> ramTranslationUnit =
-            AstTranslator().translateUnit(*astTranslationUnit);
-
-    std::cout << "RAM: finish translate unit 0" << std::endl;
-    auto ramTransformer = get_ram_transformer();
-    ramTransformer->apply(*ramTranslationUnit);
-    std::cout << "RAM: finish transform unit 1" << std::endl;
-    std::cout << "RAM: finish transform unit 2" << std::endl;
-
-    check_ram_err(ramTranslationUnit);
-    
-    // Execute RAM
-    std::cout << "RAM: Execute" << std::endl;
-    std::unique_ptr<InterpreterEngine> interpreter(
-                    std::make_unique<InterpreterEngine>(*ramTranslationUnit));
-    interpreter->executeMain();
-
-    std::cout << "RAM: Execute Finished" << std::endl;
-    std::map<std::string, std::vector<std::string>> execution_res = interpreter->get_execute_result(); 
-
-    if (get_prov){
-        // only run explain interface if interpreted
-        InterpreterProgInterface interface(*interpreter);
-        auto it = execution_res.find("target");
-        if (it != execution_res.end()) {
-            auto target_ls = it->second;
-            std::cout << "target: " << target_ls << std::endl;
-
-            for (auto target : target_ls) {
-                std::cout << "Explaining target " << target << std::endl;
-                explain(interface, false, Global::config().get("provenance") == "subtreeHeights", "target(" + target + ")");
+    std::unique_ptr<AstTranslationUnit> astUnit;
+    std::unique_ptr<RamTranslationUnit> tUnit;
+    std::unique_ptr<InterpreterEngine> engine;
+    /** Shared library of the synthesised program, if compilation is enabled */
+    std::unique_ptr<CompiledLibrary> library;
+    /** Environments of the fact sets of a batch */
+    std::vector<std::unique_ptr<InterpreterEnvironment>> batchEnvs;
+    /** An engine evaluates one fact set (or one batch) at a time */
+    std::mutex lock;
+    /** Number of evaluations of the interpreter; cursors of older ones are invalid */
+    size_t generation = 0;
+    /** Outcome of the last evaluation */
+    std::atomic<EvaluationBudget::Status> status{EvaluationBudget::Status::Complete};
+    /** Outcomes of the evaluations of the last batch */
+    std::vector<std::string> batchStatus;
+};
+
+/**
+ * A process-wide LRU cache of compiled programs, keyed by a hash of the
+ * program text and the configuration options affecting translation.
+ */
+class ProgramCache {
+public:
+    static ProgramCache& instance() {
+        static ProgramCache cache;
+        return cache;
+    }
+
+    /**
+     * Return the program for the given code, building it on a miss. Hits only take the cache lock;
+     * concurrent misses of the same program wait for the one build in flight.
+     */
+    std::shared_ptr<Program> get(const std::string& code) {
+        CompileOptions options = getCompileOptions();
+        size_t key = computeKey(code, options);
+        std::promise<std::shared_ptr<Program>> promise;
+        {
+            std::unique_lock<std::mutex> guard(lock);
+            auto pos = index.find(key);
+            if (pos != index.end() && (*pos->second)->getCode() == code) {
+                ++hits;
+                entries.splice(entries.begin(), entries, pos->second);
+                return *pos->second;
+            }
+            ++misses;
+            auto flight = building.find(key);
+            if (flight != building.end()) {
+                std::shared_future<std::shared_ptr<Program>> pending = flight->second;
+                guard.unlock();
+                std::shared_ptr<Program> program = pending.get();
+                if (program->getCode() == code) {
+                    return program;
+                }
+                // a different program of the same key; it is built without being cached
+                std::lock_guard<std::mutex> buildGuard(buildLock);
+                return std::make_shared<Program>(code, key, options);
             }
-        } else if (Global::config().get("provenance") == "explore") {
-            explain(interface, true, false);
+            building.emplace(key, promise.get_future().share());
+        }
+
+        std::shared_ptr<Program> program;
+        try {
+            // the front-end works on global state; one build at a time
+            std::lock_guard<std::mutex> buildGuard(buildLock);
+            program = std::make_shared<Program>(code, key, options);
+        } catch (...) {
+            promise.set_exception(std::current_exception());
+            std::lock_guard<std::mutex> guard(lock);
+            building.erase(key);
+            throw;
+        }
+        promise.set_value(program);
+
+        std::lock_guard<std::mutex> guard(lock);
+        building.erase(key);
+        auto pos = index.find(key);
+        if (pos != index.end()) {
+            entries.erase(pos->second);
+        }
+        entries.push_front(program);
+        index[key] = entries.begin();
+        evict();
+        return program;
+    }
+
+    void setCapacity(size_t newCapacity) {
+        std::lock_guard<std::mutex> guard(lock);
+        capacity = newCapacity;
+        evict();
+    }
+
+    void clear() {
+        std::lock_guard<std::mutex> guard(lock);
+        entries.clear();
+        index.clear();
+    }
+
+    void setCompileOptions(const CompileOptions& options) {
+        std::lock_guard<std::mutex> guard(lock);
+        compileOptions = options;
+    }
+
+    CompileOptions getCompileOptions() {
+        std::lock_guard<std::mutex> guard(lock);
+        return compileOptions;
+    }
+
+    std::map<std::string, size_t> stats() {
+        std::lock_guard<std::mutex> guard(lock);
+        return {{"hits", hits}, {"misses", misses}, {"size", entries.size()}, {"capacity", capacity}};
+    }
+
+private:
+    /**
+     * The configuration is set up once, when the cache is first used; it is read by concurrently
+     * running evaluations and must not be rewritten afterwards.
+     */
+    ProgramCache() {
+        setup_config();
+    }
+
+    /** Hash the program text together with the options that change its translation */
+    static size_t computeKey(const std::string& code, const CompileOptions& options) {
+        std::string key = code;
+        if (options.enabled) {
+            key += '\0';
+            key += "compiler=" + options.compiler + ' ' + options.includeDir;
+        }
+        for (const char* option : {"jobs", "provenance", "magic-transform", "disable-transformers", "profile",
+                     "libraries", "library-dir", "fact-dir", "pragma"}) {
+            key += '\0';
+            key += option;
+            key += '=';
+            key += Global::config().get(option);
         }
+        return std::hash<std::string>()(key);
     }
 
-    return execution_res;
+    /** Drop least recently used programs exceeding the capacity */
+    void evict() {
+        while (entries.size() > capacity) {
+            index.erase(entries.back()->getKey());
+            entries.pop_back();
+        }
+    }
 
+    std::mutex lock;
+    /** Serializes the builds of different programs */
+    std::mutex buildLock;
+    /** Programs being built, by key; later misses of the same key wait for them */
+    std::unordered_map<size_t, std::shared_future<std::shared_ptr<Program>>> building;
+    CompileOptions compileOptions;
+    size_t capacity = 32;
+    size_t hits = 0;
+    size_t misses = 0;
+    /** Programs ordered from most to least recently used */
+    std::list<std::shared_ptr<Program>> entries;
+    std::unordered_map<size_t, std::list<std::shared_ptr<Program>>::iterator> index;
+};
+
+std::map<std::string, std::vector<std::string>> execute(std::string code, bool get_prov){
+    std::shared_ptr<Program> program = ProgramCache::instance().get(code);
+    // only the interpreter explains; it evaluates and explains under one hold of the program
+    return get_prov ? program->explain() : program->run();
 }
 
 // int main () {
@@ -342,7 +1171,343 @@ std::map<std::string, std::vector<std::string>> execute(std::string code, bool g
 //         execute(datalog_example, false);
 // }
 
+/**
+ * A fixed-size pool of worker threads evaluating programs in the background.
+ */
+class WorkerPool {
+public:
+    /** The pool is never destroyed so that workers do not outlive the interpreter state at exit */
+    static WorkerPool& instance() {
+        static auto* pool = new WorkerPool(std::max(1u, std::thread::hardware_concurrency()));
+        return *pool;
+    }
+
+    void submit(std::function<void()> task) {
+        {
+            std::lock_guard<std::mutex> guard(lock);
+            tasks.push_back(std::move(task));
+        }
+        available.notify_one();
+    }
+
+private:
+    explicit WorkerPool(size_t numThreads) {
+        for (size_t i = 0; i < numThreads; ++i) {
+            workers.emplace_back([this]() { work(); });
+            workers.back().detach();
+        }
+    }
+
+    void work() {
+        while (true) {
+            std::function<void()> task;
+            {
+                std::unique_lock<std::mutex> guard(lock);
+                available.wait(guard, [this]() { return !tasks.empty(); });
+                task = std::move(tasks.front());
+                tasks.pop_front();
+            }
+            task();
+        }
+    }
+
+    std::mutex lock;
+    std::condition_variable available;
+    std::deque<std::function<void()>> tasks;
+    std::vector<std::thread> workers;
+};
+
+/**
+ * Run the given evaluation on the worker pool and return a
+ * concurrent.futures.Future receiving its result; wrap it with
+ * asyncio.wrap_future to await it. Must be called with the GIL held.
+ */
+template <typename Result>
+py::object submit_async(std::function<Result()> evaluation) {
+    py::object future = py::module_::import("concurrent.futures").attr("Future")();
+    // the reference is only touched while holding the GIL
+    auto* handle = new py::object(future);
+    WorkerPool::instance().submit([evaluation, handle]() {
+        {
+            // skip evaluations cancelled while queued; the future cannot be cancelled once running
+            py::gil_scoped_acquire acquire;
+            if (!handle->attr("set_running_or_notify_cancel")().cast<bool>()) {
+                delete handle;
+                return;
+            }
+        }
+        try {
+            Result result = evaluation();
+            py::gil_scoped_acquire acquire;
+            try {
+                handle->attr("set_result")(result);
+            } catch (py::error_already_set&) {
+                // the future has been settled already; nothing may escape the worker
+            }
+        } catch (const std::exception& e) {
+            py::gil_scoped_acquire acquire;
+            try {
+                handle->attr("set_exception")(
+                        py::module_::import("builtins").attr("RuntimeError")(e.what()));
+            } catch (py::error_already_set&) {
+                // the future has been settled already; nothing may escape the worker
+            }
+        }
+        py::gil_scoped_acquire acquire;
+        delete handle;
+    });
+    return future;
+}
+
+/**
+ * Convert row-major raw tuples to Python tuples, decoding values by attribute type.
+ */
+py::list to_tuples(Program::Cursor& cursor, const std::vector<RamDomain>& buffer) {
+    const std::vector<std::string>& types = cursor.getAttributeTypes();
+    const size_t arity = types.size();
+    py::list tuples;
+    for (size_t pos = 0; pos + arity <= buffer.size() && arity > 0; pos += arity) {
+        py::tuple tuple(arity);
+        for (size_t i = 0; i < arity; ++i) {
+            RamDomain value = buffer[pos + i];
+            switch (types[i][0]) {
+                case 's':
+                    tuple[i] = py::str(cursor.getProgram().resolveSymbol(value));
+                    break;
+                case 'u':
+                    tuple[i] = py::int_(ramBitCast<RamUnsigned>(value));
+                    break;
+                case 'f':
+                    tuple[i] = py::float_(ramBitCast<RamFloat>(value));
+                    break;
+                default:
+                    tuple[i] = py::int_(value);
+            }
+        }
+        tuples.append(tuple);
+    }
+    return tuples;
+}
+
+/**
+ * Hand a column over to NumPy without copying; the array owns the storage.
+ */
+template <typename T>
+py::array make_column(std::vector<RamDomain>&& column) {
+    static_assert(sizeof(T) == sizeof(RamDomain), "column type must match the RAM domain");
+    auto* storage = new std::vector<RamDomain>(std::move(column));
+    py::capsule owner(storage, [](void* p) { delete reinterpret_cast<std::vector<RamDomain>*>(p); });
+    return py::array_t<T>(storage->size(), reinterpret_cast<const T*>(storage->data()), owner);
+}
+
+/**
+ * Convert a column-wise result into a dict mapping attribute names to NumPy
+ * arrays. Symbol columns hold symbol ids; use Program.symbols to resolve them.
+ */
+py::dict to_numpy(Program::Columns&& columns) {
+    py::dict result;
+    for (size_t i = 0; i < columns.data.size(); ++i) {
+        py::str name(columns.names[i]);
+        switch (columns.types[i][0]) {
+            case 'u':
+                result[name] = make_column<RamUnsigned>(std::move(columns.data[i]));
+                break;
+            case 'f':
+                result[name] = make_column<RamFloat>(std::move(columns.data[i]));
+                break;
+            default:
+                result[name] = make_column<RamSigned>(std::move(columns.data[i]));
+        }
+    }
+    return result;
+}
+
+/**
+ * Convert a dict mapping relation names to lists of columns into program
+ * inputs. Numeric columns are viewed (or, if their dtype differs, converted)
+ * as contiguous arrays; the arrays are kept alive in the given holder.
+ */
+Program::Inputs to_inputs(Program& program, const std::map<std::string, std::vector<py::object>>& columns,
+        std::vector<py::array>& holder) {
+    Program::Inputs inputs;
+    for (const auto& cur : columns) {
+        const std::vector<std::string>& types = program.getAttributeTypes(cur.first);
+        if (cur.second.size() != types.size()) {
+            throw std::invalid_argument("wrong number of columns for relation <" + cur.first + ">");
+        }
+        Program::InputColumns& input = inputs[cur.first];
+        input.values.resize(types.size(), nullptr);
+        input.symbols.resize(types.size());
+        for (size_t i = 0; i < types.size(); ++i) {
+            size_t size;
+            if (types[i][0] == 's') {
+                input.symbols[i] = cur.second[i].cast<std::vector<std::string>>();
+                size = input.symbols[i].size();
+            } else {
+                constexpr int flags = py::array::c_style | py::array::forcecast;
+                const RamDomain* values;
+                if (types[i][0] == 'u') {
+                    auto array = cur.second[i].cast<py::array_t<RamUnsigned, flags>>();
+                    values = reinterpret_cast<const RamDomain*>(array.data());
+                    size = array.size();
+                    holder.push_back(array);
+                } else if (types[i][0] == 'f') {
+                    auto array = cur.second[i].cast<py::array_t<RamFloat, flags>>();
+                    values = reinterpret_cast<const RamDomain*>(array.data());
+                    size = array.size();
+                    holder.push_back(array);
+                } else {
+                    auto array = cur.second[i].cast<py::array_t<RamSigned, flags>>();
+                    values = reinterpret_cast<const RamDomain*>(array.data());
+                    size = array.size();
+                    holder.push_back(array);
+                }
+                input.values[i] = values;
+            }
+            if (i > 0 && size != input.size) {
+                throw std::invalid_argument("columns of different length for relation <" + cur.first + ">");
+            }
+            input.size = size;
+        }
+    }
+    return inputs;
+}
+
 PYBIND11_MODULE(PySouffle, m) {
     m.doc() = "pybind11 example plugin"; // optional module docstring
-    m.def("execute", &execute, "A function which takes in the code and return the execution result");
+    py::class_<Program, std::shared_ptr<Program>>(m, "Program")
+        .def(py::init([](const std::string& code) {
+            py::gil_scoped_release release;
+            return ProgramCache::instance().get(code);
+        }))
+        .def("run",
+                [](Program& program, const Program::Facts& facts,
+                        const std::map<std::string, std::vector<py::object>>& columns) {
+                    std::vector<py::array> holder;
+                    Program::Inputs inputs = to_inputs(program, columns, holder);
+                    py::gil_scoped_release release;
+                    return program.run(facts, inputs);
+                },
+                py::arg("facts") = Program::Facts(),
+                py::arg("columns") = std::map<std::string, std::vector<py::object>>(),
+                "Execute the program on the given input facts and return the output relations")
+        .def("run_columnar",
+                [](Program& program, const Program::Facts& facts,
+                        const std::map<std::string, std::vector<py::object>>& columns) {
+                    std::vector<py::array> holder;
+                    Program::Inputs inputs = to_inputs(program, columns, holder);
+                    std::map<std::string, Program::Columns> result;
+                    {
+                        py::gil_scoped_release release;
+                        result = program.runColumnar(facts, inputs);
+                    }
+                    py::dict relations;
+                    for (auto& cur : result) {
+                        relations[py::str(cur.first)] = to_numpy(std::move(cur.second));
+                    }
+                    return relations;
+                },
+                py::arg("facts") = Program::Facts(),
+                py::arg("columns") = std::map<std::string, std::vector<py::object>>(),
+                "Execute the program and return each output relation as a dict of NumPy columns")
+        .def("run_async",
+                [](std::shared_ptr<Program> program, const Program::Facts& facts) {
+                    return submit_async<std::map<std::string, std::vector<std::string>>>(
+                            [program, facts]() { return program->run(facts); });
+                },
+                py::arg("facts") = Program::Facts(),
+                "Execute the program on a worker thread and return a concurrent.futures.Future")
+        .def("run_batch",
+                [](Program& program, const std::vector<Program::Facts>& bundles) {
+                    py::gil_scoped_release release;
+                    return program.runBatch(bundles);
+                },
+                "Execute the program on a list of independent fact sets, evaluating them concurrently")
+        .def("evaluate",
+                [](Program& program, const Program::Facts& facts,
+                        const std::map<std::string, std::vector<py::object>>& columns) {
+                    std::vector<py::array> holder;
+                    Program::Inputs inputs = to_inputs(program, columns, holder);
+                    py::gil_scoped_release release;
+                    return program.evaluate(facts, inputs);
+                },
+                py::arg("facts") = Program::Facts(),
+                py::arg("columns") = std::map<std::string, std::vector<py::object>>(),
+                "Execute the program without rendering the output; read relations through cursors")
+        .def("cursor",
+                [](std::shared_ptr<Program> program, const std::string& name,
+                        const std::map<size_t, std::string>& bound) {
+                    return std::make_shared<Program::Cursor>(program, name, bound);
+                },
+                py::arg("relation"), py::arg("bound") = std::map<size_t, std::string>(),
+                "Open a cursor over a relation of the last evaluation, optionally binding attributes")
+        .def("set_limits", &Program::setLimits, py::arg("time") = 0, py::arg("tuples") = 0,
+                py::arg("memory") = 0,
+                "Limit the milliseconds, derived tuples and megabytes of memory of later evaluations; "
+                "0 is no limit. The memory limit is on the whole process and is rejected by run_batch")
+        .def_property_readonly("status", &Program::getStatus,
+                "Outcome of the last evaluation: 'complete' or the limit it exceeded")
+        .def_property_readonly("batch_status", &Program::getBatchStatus,
+                "Outcome of the evaluation of each fact set of the last batch")
+        .def_property_readonly("compiled", &Program::isCompiled)
+        .def("symbols", &Program::resolveSymbols, "Resolve the symbol ids of a symbol column");
+
+    py::class_<Program::Cursor, std::shared_ptr<Program::Cursor>>(m, "Cursor")
+        .def("fetch",
+                [](Program::Cursor& cursor, size_t size) {
+                    std::vector<RamDomain> buffer;
+                    {
+                        py::gil_scoped_release release;
+                        cursor.fetch(buffer, size);
+                    }
+                    return to_tuples(cursor, buffer);
+                },
+                py::arg("size") = 1024, "Fetch the next chunk of tuples; an empty list once exhausted")
+        .def("__iter__", [](py::object self) { return self; })
+        .def("__next__", [](Program::Cursor& cursor) {
+            // the chunk is fetched into a local buffer without the GIL and only handed to the
+            // cursor once the GIL is held again; other threads may iterate meanwhile
+            std::vector<RamDomain> tuple;
+            bool exhausted = false;
+            while (!cursor.popPending(tuple)) {
+                if (exhausted) {
+                    throw py::stop_iteration();
+                }
+                std::vector<RamDomain> chunk;
+                {
+                    py::gil_scoped_release release;
+                    cursor.fetch(chunk, 1024);
+                }
+                exhausted = chunk.empty();
+                cursor.pushPending(chunk);
+            }
+            return to_tuples(cursor, tuple)[0];
+        });
+
+    m.def("enable_compilation",
+            [](const std::string& cacheDir, const std::string& compiler, const std::string& includeDir) {
+                CompileOptions options;
+                options.enabled = true;
+                options.cacheDir = cacheDir;
+                options.compiler = compiler;
+                options.includeDir = includeDir;
+                ProgramCache::instance().setCompileOptions(options);
+            },
+            py::arg("cache_dir") = ".souffle_cache", py::arg("compiler") = "", py::arg("include_dir") = "",
+            "Build programs created from now on as shared libraries, cached in cache_dir");
+    m.def("disable_compilation", []() { ProgramCache::instance().setCompileOptions(CompileOptions()); },
+            "Interpret programs created from now on");
+    m.def("execute", &execute, py::call_guard<py::gil_scoped_release>(),
+            "A function which takes in the code and return the execution result");
+    m.def("execute_async",
+            [](const std::string& code, bool get_prov) {
+                return submit_async<std::map<std::string, std::vector<std::string>>>(
+                        [code, get_prov]() { return execute(code, get_prov); });
+            },
+            "Execute the code on a worker thread and return a concurrent.futures.Future");
+    m.def("cache_stats", []() { return ProgramCache::instance().stats(); },
+            "Return hit/miss counters and occupancy of the program cache");
+    m.def("set_cache_capacity", [](size_t capacity) { ProgramCache::instance().setCapacity(capacity); },
+            "Set the maximum number of programs kept in the program cache");
+    m.def("clear_cache", []() { ProgramCache::instance().clear(); }, "Drop all cached programs");
 }
\ No newline at end of file
@@ -121,6 +121,18 @@ void MinIndexSelection::solve() {
         return;
     }
 
+    // Hash indexes do not serve searches binding a prefix of their key; hence,
+    // forcing hash indexes requires an order per search
+    if (hashChoice == HashChoice::FORCED) {
+        for (auto search : searches) {
+            LexOrder ids;
+            insertIndex(ids, search);
+            chainToOrder.push_back({search});
+            orders.push_back(ids);
+        }
+        return;
+    }
+
     // Construct the matching poblem
     for (auto search : searches) {
         // For this node check if other nodes are strict subsets
@@ -280,7 +292,9 @@ void RamIndexAnalysis::run(const RamTranslationUnit& translationUnit) {
 
     // find optimal indexes for relations
     for (auto& cur : minIndexCover) {
+        const RamRelation& rel = *cur.first;
         MinIndexSelection& indexes = cur.second;
+        indexes.setHashChoice(getHashChoice(rel), rel.getArity());
         indexes.solve();
     }
 
@@ -329,11 +343,15 @@ void RamIndexAnalysis::print(std::ostream& os) const {
         }
 
         os << "\tNumber of Indexes: " << indexes.getAllOrders().size() << "\n";
-        for (auto& order : indexes.getAllOrders()) {
+        const auto& orders = indexes.getAllOrders();
+        for (size_t idx = 0; idx < orders.size(); ++idx) {
             os << "\t\t";
-            for (auto& i : order) {
+            for (auto& i : orders[idx]) {
                 os << attrib[i] << " ";
             }
+            if (indexes.isHashIndex(idx)) {
+                os << "(hash)";
+            }
             os << "\n";
         }
     }
@@ -361,6 +379,21 @@ SearchSignature searchSignature(Seq const& xs) {
 }
 }  // namespace
 
+MinIndexSelection::HashChoice RamIndexAnalysis::getHashChoice(const RamRelation& rel) const {
+    // hash indexes can not serve the range searches over the auxiliary attributes of provenance
+    if (rel.isNullary() || rel.getAuxiliaryArity() > 0) {
+        return MinIndexSelection::HashChoice::NONE;
+    }
+    switch (rel.getRepresentation()) {
+        case RelationRepresentation::DEFAULT:
+            return MinIndexSelection::HashChoice::AUTO;
+        case RelationRepresentation::HASHSET:
+            return MinIndexSelection::HashChoice::FORCED;
+        default:
+            return MinIndexSelection::HashChoice::NONE;
+    }
+}
+
 SearchSignature RamIndexAnalysis::getSearchSignature(const RamIndexOperation* search) const {
     return searchSignature(search->getRangePattern());
 }
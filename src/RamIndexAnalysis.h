@@ -157,6 +157,13 @@ public:
     using ChainOrderMap = std::vector<Chain>;
     using SearchSet = std::set<SearchSignature>;
 
+    /** @Brief Choice of hash indexes for the orders of a relation */
+    enum class HashChoice {
+        NONE,    // all orders are stored in ordered indexes
+        AUTO,    // orders searched with a single partial signature are hashed
+        FORCED,  // every search gets its own order, and all orders are hashed
+    };
+
     MinIndexSelection() = default;
     ~MinIndexSelection() = default;
 
@@ -193,6 +200,33 @@ public:
         return chainToOrder;
     }
 
+    /** @Brief Set the choice of hash indexes, to be called before solving
+     *  @param choice of hash indexes
+     *  @param arity of the relation
+     */
+    void setHashChoice(HashChoice choice, size_t arity) {
+        hashChoice = choice;
+        totalSignature = (SearchSignature(1) << arity) - 1;
+    }
+
+    /** @Brief check whether an order is stored in a hash index, i.e., it is only
+     *  searched with its first getHashKeyLength(idx) attributes bound
+     */
+    bool isHashIndex(size_t idx) const {
+        assert(idx < chainToOrder.size());
+        const Chain& chain = chainToOrder[idx];
+        if (hashChoice == HashChoice::NONE || chain.size() != 1) {
+            return false;
+        }
+        return hashChoice == HashChoice::FORCED || *chain.begin() != totalSignature;
+    }
+
+    /** @Brief get the number of leading attributes of an order forming the key of its hash index */
+    size_t getHashKeyLength(size_t idx) const {
+        assert(isHashIndex(idx));
+        return card(*chainToOrder[idx].begin());
+    }
+
     /** @Brief check whether number of bits in k is not equal
         to number of columns in lexicographical order */
     bool isSubset(SearchSignature cols) const {
@@ -237,6 +271,8 @@ protected:
     OrderCollection orders;      // collection of lexicographical orders
     ChainOrderMap chainToOrder;  // maps order index to set of searches covered by chain
     MaxMatching matching;        // matching problem for finding minimal number of orders
+    HashChoice hashChoice = HashChoice::NONE;  // choice of hash indexes
+    SearchSignature totalSignature = 0;        // signature binding all attributes of the relation
 
     /** @Brief count the number of bits in key */
     static size_t card(SearchSignature cols) {
@@ -379,6 +415,12 @@ public:
     bool isTotalSignature(const RamAbstractExistenceCheck* existCheck) const;
 
 private:
+    /**
+     * @Brief Choose hash indexes for a relation by its representation;
+     *        the btree representation keeps all indexes ordered
+     */
+    MinIndexSelection::HashChoice getHashChoice(const RamRelation& rel) const;
+
     /**
      * minimal index cover for relations, i.e., maps a relation to a set of indexes
      */
@@ -310,6 +310,39 @@ public:
         return *operation;
     }
 
+    /**
+     * @brief Get the relation merged by this query
+     *
+     * Merges, e.g. of the new knowledge into the full relation of a recursive
+     * stratum, copy all tuples of a relation into another relation:
+     * ~~~~~~~~~~~~~~~~~~~~~~~~~~~
+     * QUERY
+     *   FOR t0 IN A
+     *     PROJECT (t0.0, ..., t0.n-1) INTO B
+     * ~~~~~~~~~~~~~~~~~~~~~~~~~~~
+     * @return the relation copied by this query, or nullptr if it is not a merge
+     */
+    const RamRelation* getMergeSource() const {
+        const auto* scan = dynamic_cast<const RamScan*>(operation.get());
+        if (scan == nullptr) {
+            return nullptr;
+        }
+        const auto* project = dynamic_cast<const RamProject*>(&scan->getOperation());
+        if (project == nullptr || &project->getRelation() == &scan->getRelation() ||
+                project->getRelation().getArity() != scan->getRelation().getArity()) {
+            return nullptr;
+        }
+        const auto values = project->getValues();
+        for (size_t i = 0; i < values.size(); ++i) {
+            const auto* element = dynamic_cast<const RamTupleElement*>(values[i]);
+            if (element == nullptr || element->getTupleId() != scan->getTupleId() ||
+                    element->getElement() != i) {
+                return nullptr;
+            }
+        }
+        return &scan->getRelation();
+    }
+
     std::vector<const RamNode*> getChildNodes() const override {
         return {operation.get()};
     }
@@ -121,6 +121,10 @@ public:
         assert(iter != maps.end() && "Attempting to unpack non-existing record");
         return (iter->second).unpack(ref);
     }
+    /** @brief discard all records */
+    void clear() {
+        maps.clear();
+    }
 
 private:
     /** @brief lookup RecordMap for a given arity; if it does not exist, create new RecordMap */
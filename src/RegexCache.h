@@ -0,0 +1,85 @@
+/*
+ * Souffle - A Datalog Compiler
+ * Copyright (c) 2019, The Souffle Developers. All rights reserved.
+ * Licensed under the Universal Permissive License v 1.0 as shown at:
+ * - https://opensource.org/licenses/UPL
+ * - <souffle root>/licenses/SOUFFLE-UPL.txt
+ */
+
+/************************************************************************
+ *
+ * @file RegexCache.h
+ *
+ * Compiled regular expressions for the match constraint, shared by the
+ * interpreter and the synthesised code.
+ *
+ ***********************************************************************/
+
+#pragma once
+
+#include "RamTypes.h"
+#include "SymbolTable.h"
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <regex>
+#include <shared_mutex>
+#include <string>
+#include <unordered_map>
+
+namespace souffle {
+
+/**
+ * A bounded, thread-safe cache of compiled patterns, keyed by the symbol of the pattern.
+ * Invalid patterns are cached as nullptr so that they are not recompiled either.
+ */
+class RegexCache {
+public:
+    using RegexPtr = std::shared_ptr<const std::regex>;
+
+    /** Default number of patterns held by a cache */
+    static constexpr size_t DEFAULT_CAPACITY = 1024;
+
+    explicit RegexCache(size_t capacity = DEFAULT_CAPACITY) : capacity(capacity) {}
+
+    /** @brief Compile a pattern; return nullptr if it is not a valid regular expression */
+    static RegexPtr compile(const std::string& pattern) {
+        try {
+            return std::make_shared<const std::regex>(pattern);
+        } catch (...) {
+            return nullptr;
+        }
+    }
+
+    /** @brief Return the compiled pattern of the given symbol, compiling it on a miss */
+    RegexPtr get(RamDomain symbol, const SymbolTable& symbolTable) {
+        {
+            std::shared_lock<std::shared_mutex> guard(access);
+            auto pos = regexes.find(symbol);
+            if (pos != regexes.end()) {
+                return pos->second;
+            }
+        }
+
+        // compile outside of the lock; a concurrent miss on the same pattern is harmless
+        RegexPtr regex = compile(symbolTable.resolve(symbol));
+
+        std::unique_lock<std::shared_mutex> guard(access);
+        // the cache is bounded by starting over once it is full
+        if (regexes.size() >= capacity) {
+            regexes.clear();
+        }
+        regexes.emplace(symbol, regex);
+        return regex;
+    }
+
+private:
+    /** Maximum number of cached patterns */
+    const size_t capacity;
+    /** Guards the map of patterns */
+    std::shared_mutex access;
+    /** Compiled patterns, indexed by the symbol of the pattern */
+    std::unordered_map<RamDomain, RegexPtr> regexes;
+};
+
+}  // namespace souffle
@@ -29,6 +29,7 @@ enum class RelationTag {
     BRIE,         // use brie data-structure
     BTREE,        // use btree data-structure
     EQREL,        // use union data-structure
+    HASHSET,      // use hash data-structure
 };
 
 /** Space of qualifiers that a relation can have */
@@ -47,6 +48,8 @@ enum class RelationRepresentation {
     BRIE,     // use brie data-structure
     BTREE,    // use btree data-structure
     EQREL,    // use union data-structure
+    HASHSET,  // use hash data-structure
+    SORTED,   // use sorted arrays, for relations which are read-only after loading
     INFO,     // info relation for provenance
 };
 
@@ -58,6 +61,7 @@ inline bool isRelationRepresentationTag(const RelationTag& tag) {
         case RelationTag::BRIE:
         case RelationTag::BTREE:
         case RelationTag::EQREL:
+        case RelationTag::HASHSET:
             return true;
         default:
             return false;
@@ -114,6 +118,8 @@ inline RelationRepresentation getRelationRepresentationFromTag(const RelationTag
             return RelationRepresentation::BTREE;
         case RelationTag::EQREL:
             return RelationRepresentation::EQREL;
+        case RelationTag::HASHSET:
+            return RelationRepresentation::HASHSET;
         default:
             assert(false && "invalid relation tag");
     }
@@ -157,6 +163,12 @@ inline std::ostream& operator<<(std::ostream& os, RelationRepresentation represe
         case RelationRepresentation::EQREL:
             os << "eqrel";
             break;
+        case RelationRepresentation::HASHSET:
+            os << "hashset";
+            break;
+        case RelationRepresentation::SORTED:
+            os << "sorted";
+            break;
         case RelationRepresentation::INFO:
             os << "info";
             break;
@@ -0,0 +1,315 @@
+/*
+ * Souffle - A Datalog Compiler
+ * Copyright (c) 2020, The Souffle Developers. All rights reserved
+ * Licensed under the Universal Permissive License v 1.0 as shown at:
+ * - https://opensource.org/licenses/UPL
+ * - <souffle root>/licenses/SOUFFLE-UPL.txt
+ */
+
+/************************************************************************
+ *
+ * @file SortedArray.h
+ *
+ * An ordered set stored as a single sorted array. It is meant for relations
+ * which are loaded once and only read afterwards, e.g. input relations
+ * never occurring in the head of a rule: elements are buffered while being
+ * loaded and sorted in one go on the first read. Compared to a B-tree, the
+ * elements are stored without any per-node overhead and searches do not
+ * chase pointers.
+ *
+ ***********************************************************************/
+
+#pragma once
+
+#include "Util.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cassert>
+#include <iterator>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+namespace souffle {
+
+/**
+ * A set of elements kept in a sorted array, ordered by Comparator.
+ *
+ * Insertions are appended to a buffer of pending elements and become
+ * visible once the array is sealed: the pending elements are sorted and
+ * merged into the array, dropping duplicates. Sealing happens explicitly
+ * or implicitly on the first read following an insertion. Insertions are
+ * safe to conduct concurrently with each other, and reads are safe to
+ * conduct concurrently with each other, but the two phases must not
+ * overlap; sealing invalidates all iterators.
+ *
+ * Large arrays are accompanied by a directory sampling every STRIDE-th
+ * element. Searches binary-search the compact directory first and then a
+ * single window of STRIDE elements, touching far fewer cache lines than a
+ * binary search over the whole array.
+ *
+ * @tparam Key the type of the stored elements
+ * @tparam Comparator a functor ordering elements by less(a,b) and equal(a,b)
+ * @tparam isSet whether elements equal according to Comparator are merged;
+ *          otherwise only identical elements are
+ */
+template <typename Key, typename Comparator, bool isSet = true>
+class sorted_array {
+public:
+    using element_type = Key;
+    using size_type = std::size_t;
+    using iterator = typename std::vector<Key>::const_iterator;
+    using chunk = range<iterator>;
+
+    /** Sorted arrays do not exploit access patterns; provided for interface compatibility with B-trees */
+    struct operation_hints {};
+
+    /** The number of elements covered by an entry of the directory */
+    static constexpr size_type STRIDE = 64;
+
+    /** The number of elements from which on a directory is maintained */
+    static constexpr size_type DIRECTORY_THRESHOLD = 8 * STRIDE;
+
+    sorted_array(Comparator comp = Comparator()) : comp(std::move(comp)) {}
+
+    sorted_array(const sorted_array&) = delete;
+    sorted_array& operator=(const sorted_array&) = delete;
+
+    /** Obtains the number of elements of this set */
+    size_type size() const {
+        seal();
+        return elements.size();
+    }
+
+    /** Determines whether this set is empty */
+    bool empty() const {
+        seal();
+        return elements.empty();
+    }
+
+    /**
+     * Inserts the given element; returns false if it is present already.
+     * An element equal to one pending insertion is reported as inserted,
+     * the duplicate is dropped when sealing.
+     */
+    bool insert(const Key& k) {
+        operation_hints hints;
+        return insert(k, hints);
+    }
+
+    /**
+     * Inserts the given element; returns false if it is present already.
+     * An element equal to one pending insertion is reported as inserted,
+     * the duplicate is dropped when sealing.
+     */
+    bool insert(const Key& k, operation_hints&) {
+        std::lock_guard<std::mutex> guard(lock);
+        if (locate(k) != elements.end()) {
+            return false;
+        }
+        pending.push_back(k);
+        dirty.store(true, std::memory_order_release);
+        return true;
+    }
+
+    /** Inserts all elements of the given range */
+    template <typename Iter>
+    void insert(const Iter& a, const Iter& b) {
+        if (a == b) {
+            return;
+        }
+        std::lock_guard<std::mutex> guard(lock);
+        pending.insert(pending.end(), a, b);
+        dirty.store(true, std::memory_order_release);
+    }
+
+    /** Inserts all elements of the given range and seals this set */
+    template <typename Iter>
+    void insertAll(const Iter& a, const Iter& b) {
+        insert(a, b);
+        seal();
+    }
+
+    /** Makes room for the given number of pending insertions */
+    void reserve(size_type n) {
+        std::lock_guard<std::mutex> guard(lock);
+        pending.reserve(n);
+    }
+
+    /** Sorts the pending insertions into the array */
+    void seal() const {
+        if (!dirty.load(std::memory_order_acquire)) {
+            return;
+        }
+        std::lock_guard<std::mutex> guard(lock);
+        if (!dirty.load(std::memory_order_relaxed)) {
+            return;
+        }
+
+        // elements equal according to the comparator are ordered as whole
+        // tuples, such that identical ones end up next to each other
+        auto ordered = [&](const Key& a, const Key& b) {
+            return comp.less(a, b) || (!comp.less(b, a) && a < b);
+        };
+        auto same = [&](const Key& a, const Key& b) { return isSet ? comp.equal(a, b) : a == b; };
+
+        std::vector<Key> batch;
+        batch.swap(pending);
+        if (!std::is_sorted(batch.begin(), batch.end(), ordered)) {
+            std::sort(batch.begin(), batch.end(), ordered);
+        }
+        if (elements.empty()) {
+            elements.swap(batch);
+        } else {
+            std::vector<Key> merged;
+            merged.reserve(elements.size() + batch.size());
+            std::merge(elements.begin(), elements.end(), batch.begin(), batch.end(),
+                    std::back_inserter(merged), ordered);
+            elements.swap(merged);
+        }
+        elements.erase(std::unique(elements.begin(), elements.end(), same), elements.end());
+        elements.shrink_to_fit();
+
+        directory.clear();
+        if (elements.size() >= DIRECTORY_THRESHOLD) {
+            directory.reserve((elements.size() + STRIDE - 1) / STRIDE);
+            for (size_type i = 0; i < elements.size(); i += STRIDE) {
+                directory.push_back(elements[i]);
+            }
+        }
+        dirty.store(false, std::memory_order_release);
+    }
+
+    /** Determines whether the given element is a member of this set */
+    bool contains(const Key& k) const {
+        operation_hints hints;
+        return contains(k, hints);
+    }
+
+    /** Determines whether the given element is a member of this set */
+    bool contains(const Key& k, operation_hints& hints) const {
+        return find(k, hints) != end();
+    }
+
+    /** Locates the given element; returns an end-iterator if it is not present */
+    iterator find(const Key& k) const {
+        operation_hints hints;
+        return find(k, hints);
+    }
+
+    /** Locates the given element; returns an end-iterator if it is not present */
+    iterator find(const Key& k, operation_hints&) const {
+        seal();
+        return locate(k);
+    }
+
+    /** Obtains an iterator to the first element not less than the given one */
+    iterator lower_bound(const Key& k) const {
+        operation_hints hints;
+        return lower_bound(k, hints);
+    }
+
+    /** Obtains an iterator to the first element not less than the given one */
+    iterator lower_bound(const Key& k, operation_hints&) const {
+        seal();
+        return search([&](const Key& element) { return comp.less(element, k); });
+    }
+
+    /** Obtains an iterator to the first element greater than the given one */
+    iterator upper_bound(const Key& k) const {
+        operation_hints hints;
+        return upper_bound(k, hints);
+    }
+
+    /** Obtains an iterator to the first element greater than the given one */
+    iterator upper_bound(const Key& k, operation_hints&) const {
+        seal();
+        return search([&](const Key& element) { return !comp.less(k, element); });
+    }
+
+    iterator begin() const {
+        seal();
+        return elements.begin();
+    }
+
+    iterator end() const {
+        seal();
+        return elements.end();
+    }
+
+    /** Partitions this set into up to the given number of chunks of the same size */
+    std::vector<chunk> getChunks(size_type num) const {
+        seal();
+        std::vector<chunk> res;
+        num = std::max<size_type>(1, std::min(num, elements.size()));
+        for (size_type i = 0; i < num && !elements.empty(); ++i) {
+            res.push_back({elements.begin() + i * elements.size() / num,
+                    elements.begin() + (i + 1) * elements.size() / num});
+        }
+        return res;
+    }
+
+    std::vector<chunk> partition(size_type num) const {
+        return getChunks(num);
+    }
+
+    /** Removes all elements; not to be called concurrently with other operations */
+    void clear() {
+        std::lock_guard<std::mutex> guard(lock);
+        elements.clear();
+        elements.shrink_to_fit();
+        pending.clear();
+        directory.clear();
+        dirty.store(false, std::memory_order_release);
+    }
+
+private:
+    /**
+     * Locates the first element of the sealed array not satisfying the given
+     * predicate, which holds for a prefix of the array. The directory is
+     * searched first to narrow the search down to a window of STRIDE elements.
+     */
+    template <typename Below>
+    iterator search(const Below& below) const {
+        auto pred = [&](const Key& element, bool) { return below(element); };
+        if (directory.empty()) {
+            return std::lower_bound(elements.begin(), elements.end(), true, pred);
+        }
+        // the sampled element at the found position is the first one not below
+        size_type pos = std::lower_bound(directory.begin(), directory.end(), true, pred) - directory.begin();
+        size_type lo = pos == 0 ? 0 : (pos - 1) * STRIDE + 1;
+        size_type hi = std::min(pos * STRIDE, elements.size());
+        return std::lower_bound(elements.begin() + lo, elements.begin() + hi, true, pred);
+    }
+
+    /** Locates the given element in the sealed array; the caller must prevent concurrent sealing */
+    iterator locate(const Key& k) const {
+        auto pos = search([&](const Key& element) { return comp.less(element, k); });
+        for (; pos != elements.end() && comp.equal(*pos, k); ++pos) {
+            if (isSet || *pos == k) {
+                return pos;
+            }
+        }
+        return elements.end();
+    }
+
+    Comparator comp;
+
+    // the sorted elements
+    mutable std::vector<Key> elements;
+
+    // every STRIDE-th element of the sorted elements, empty for small sets
+    mutable std::vector<Key> directory;
+
+    // the inserted elements not sorted into the array yet
+    mutable std::vector<Key> pending;
+
+    // whether there are pending insertions
+    mutable std::atomic<bool> dirty{false};
+
+    // serializes insertions and sealing
+    mutable std::mutex lock;
+};
+
+}  // end namespace souffle
@@ -16,6 +16,7 @@
 
 #pragma once
 
+#include "EvaluationBudget.h"
 #include "RamTypes.h"
 #include "SymbolTable.h"
 
@@ -682,6 +683,11 @@ private:
     std::size_t numThreads = 1;
 
 protected:
+    /**
+     * Limits of an evaluation; the evaluation skips its remaining rules once a limit is exceeded.
+     */
+    EvaluationBudget budget;
+
     /**
      * Add the relation to relationMap (with its name) and allRelations,
      * depends on the properties of the relation, if the relation is an input relation, it will be added to
@@ -771,6 +777,14 @@ public:
         return numThreads;
     }
 
+    /**
+     * Get the budget of the evaluation, to set its limits before and read its status after running
+     * the program
+     */
+    EvaluationBudget& getBudget() {
+        return budget;
+    }
+
     /**
      * Get Relation by its name from relationMap, if relation not found, return a nullptr.
      *
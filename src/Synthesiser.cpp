@@ -42,6 +42,7 @@
 #include <cstdlib>
 #include <functional>
 #include <iostream>
+#include <set>
 #include <sstream>
 #include <typeinfo>
 #include <utility>
@@ -249,6 +250,10 @@ void Synthesiser::emitCode(std::ostream& out, const RamStatement& stmt) {
                 out << "rwOperation, symTable, recordTable";
                 out << ")->readAll(*" << synthesiser.getRelationName(io.getRelation());
                 out << ");\n";
+                // sorted arrays are built once all tuples are loaded
+                if (io.getRelation().getRepresentation() == RelationRepresentation::SORTED) {
+                    out << synthesiser.getRelationName(io.getRelation()) << "->seal();\n";
+                }
                 out << "} catch (std::exception& e) {std::cerr << \"Error loading data: \" << e.what() "
                        "<< "
                        "'\\n';}\n";
@@ -275,6 +280,24 @@ void Synthesiser::emitCode(std::ostream& out, const RamStatement& stmt) {
         void visitQuery(const RamQuery& query, std::ostream& out) override {
             PRINT_BEGIN_COMMENT(out);
 
+            // merges insert all tuples of a relation in bulk
+            const RamRelation* source = query.getMergeSource();
+            if (source != nullptr && !source->isNullary()) {
+                const auto& scan = static_cast<const RamScan&>(query.getOperation());
+                const auto& project = static_cast<const RamProject&>(scan.getOperation());
+                const std::string sourceName = synthesiser.getRelationName(*source);
+                out << "if (!budget.check()) {\n";
+                out << "if (budget.isLimited()) budget.addTuples(" << sourceName << "->size());\n";
+                out << synthesiser.getRelationName(project.getRelation()) << "->insertAll(*" << sourceName
+                    << ");\n";
+                out << "}\n";
+                PRINT_END_COMMENT(out);
+                return;
+            }
+
+            // queries are skipped once the budget of the evaluation is exhausted
+            out << "if (!budget.check()) {\n";
+
             // split terms of conditions of outer filter operation
             // into terms that require a context and terms that
             // do not require a context
@@ -317,6 +340,9 @@ void Synthesiser::emitCode(std::ostream& out, const RamStatement& stmt) {
             preamble.clear();
             preambleIssued = false;
 
+            // derived tuples are counted per thread and accounted for in the budget at the end
+            preamble << "size_t derivedTuples = 0;\n";
+
             // create operation contexts for this operation
             for (const RamRelation* rel : synthesiser.getReferencedRelations(query.getOperation())) {
                 preamble << "CREATE_OP_CONTEXT(" << synthesiser.getOpContextName(*rel);
@@ -348,8 +374,10 @@ void Synthesiser::emitCode(std::ostream& out, const RamStatement& stmt) {
                 }
             }
 
+            out << "budget.addTuples(derivedTuples);\n";
             if (isParallel) {
                 out << "PARALLEL_END;\n";  // end parallel
+                visitBusyTime(out);
             }
 
             out << "}\n";
@@ -358,6 +386,7 @@ void Synthesiser::emitCode(std::ostream& out, const RamStatement& stmt) {
             if (freeOfCtx.size() > 0) {
                 out << "}\n";
             }
+            out << "}\n";
 
             PRINT_END_COMMENT(out);
         }
@@ -430,6 +459,7 @@ void Synthesiser::emitCode(std::ostream& out, const RamStatement& stmt) {
             out << "iter = 0;\n";
             out << "for(;;) {\n";
             visit(loop.getBody(), out);
+            out << "if (budget.check()) break;\n";
             out << "iter++;\n";
             out << "}\n";
             out << "iter = 0;\n";
@@ -538,11 +568,13 @@ void Synthesiser::emitCode(std::ostream& out, const RamStatement& stmt) {
             PRINT_BEGIN_COMMENT(out);
 
             out << "auto part = " << relName << "->partition();\n";
+            out << "WorkStealingLoop loop(part.size());\n";
             out << "PARALLEL_START;\n";
             out << preamble.str();
-            out << "pfor(auto it = part.begin(); it<part.end();++it){\n";
+            out << "size_t partition;\n";
+            out << "while (loop.next(partition)) {\n";
             out << "try{\n";
-            out << "for(const auto& env0 : *it) {\n";
+            out << "for(const auto& env0 : part[partition]) {\n";
 
             visitTupleOperation(pscan, out);
 
@@ -612,11 +644,13 @@ void Synthesiser::emitCode(std::ostream& out, const RamStatement& stmt) {
             PRINT_BEGIN_COMMENT(out);
 
             out << "auto part = " << relName << "->partition();\n";
+            out << "WorkStealingLoop loop(part.size());\n";
             out << "PARALLEL_START;\n";
             out << preamble.str();
-            out << "pfor(auto it = part.begin(); it<part.end();++it){\n";
+            out << "size_t partition;\n";
+            out << "while (loop.next(partition)) {\n";
             out << "try{\n";
-            out << "for(const auto& env0 : *it) {\n";
+            out << "for(const auto& env0 : part[partition]) {\n";
             out << "if( ";
 
             visit(pchoice.getCondition(), out);
@@ -685,12 +719,14 @@ void Synthesiser::emitCode(std::ostream& out, const RamStatement& stmt) {
                 << "->"
                 // TODO (b-scholz): context may be missing here?
                 << "equalRange_" << keys << "(key);\n";
-            out << "auto part = range.partition();\n";
+            out << "auto part = range.partition(MAX_THREADS * PARTITIONS_PER_THREAD);\n";
+            out << "WorkStealingLoop loop(part.size());\n";
             out << "PARALLEL_START;\n";
             out << preamble.str();
-            out << "pfor(auto it = part.begin(); it<part.end(); ++it) { \n";
+            out << "size_t partition;\n";
+            out << "while (loop.next(partition)) {\n";
             out << "try{\n";
-            out << "for(const auto& env0 : *it) {\n";
+            out << "for(const auto& env0 : part[partition]) {\n";
 
             visitTupleOperation(piscan, out);
 
@@ -761,12 +797,14 @@ void Synthesiser::emitCode(std::ostream& out, const RamStatement& stmt) {
                 << "->"
                 // TODO (b-scholz): context may be missing here?
                 << "equalRange_" << keys << "(key);\n";
-            out << "auto part = range.partition();\n";
+            out << "auto part = range.partition(MAX_THREADS * PARTITIONS_PER_THREAD);\n";
+            out << "WorkStealingLoop loop(part.size());\n";
             out << "PARALLEL_START;\n";
             out << preamble.str();
-            out << "pfor(auto it = part.begin(); it<part.end(); ++it) { \n";
+            out << "size_t partition;\n";
+            out << "while (loop.next(partition)) {\n";
             out << "try{";
-            out << "for(const auto& env0 : *it) {\n";
+            out << "for(const auto& env0 : part[partition]) {\n";
             out << "if( ";
 
             visit(pichoice.getCondition(), out);
@@ -811,6 +849,145 @@ void Synthesiser::emitCode(std::ostream& out, const RamStatement& stmt) {
             PRINT_END_COMMENT(out);
         }
 
+        /** Check whether the loop of an aggregate is partitioned among threads */
+        bool isParallelAggregate(const RamTupleOperation& aggregate) const {
+            // as for scans, only the outer-most loop of a query can be made parallel
+            return aggregate.getTupleId() == 0 && std::stoi(Global::config().get("jobs")) != 1;
+        }
+
+        /** Emit the loop folding the tuples of source into the variables with the given suffix */
+        void visitAggregateLoop(const RamAbstractAggregate& aggregate, int identifier,
+                const std::string& type, const std::string& suffix, const std::string& source,
+                std::ostream& out) {
+            const std::string res = "res" + toString(identifier) + suffix;
+            const std::string mean = "accumulateMean" + suffix;
+
+            out << "for(const auto& env" << identifier << " : " << source << ") {\n";
+
+            // produce condition inside the loop
+            out << "if( ";
+            visit(aggregate.getCondition(), out);
+            out << ") {\n";
+
+            out << "shouldRunNested" << suffix << " = true;\n";
+
+            // pick function
+            switch (aggregate.getFunction()) {
+                case AggregateOp::FMIN:
+                case AggregateOp::UMIN:
+                case AggregateOp::MIN:
+                    out << res << " = std::min(" << res << ",ramBitCast<" << type << ">(";
+                    visit(aggregate.getExpression(), out);
+                    out << "));\n";
+                    break;
+                case AggregateOp::FMAX:
+                case AggregateOp::UMAX:
+                case AggregateOp::MAX:
+                    out << res << " = std::max(" << res << ",ramBitCast<" << type << ">(";
+                    visit(aggregate.getExpression(), out);
+                    out << "));\n";
+                    break;
+                case AggregateOp::COUNT:
+                    out << "++" << res << ";\n";
+                    break;
+                case AggregateOp::FSUM:
+                case AggregateOp::USUM:
+                case AggregateOp::SUM:
+                    out << res << " += "
+                        << "ramBitCast<" << type << ">(";
+                    visit(aggregate.getExpression(), out);
+                    out << ");\n";
+                    break;
+
+                case AggregateOp::MEAN:
+                    out << mean << ".first += "
+                        << "ramBitCast<RamFloat>(";
+                    visit(aggregate.getExpression(), out);
+                    out << ");\n";
+                    out << "++" << mean << ".second;\n";
+                    break;
+            }
+
+            out << "}\n";
+
+            // end aggregator loop
+            out << "}\n";
+        }
+
+        /**
+         * Emit the loop of an outer-most aggregate over the partitions of a relation or range:
+         * each thread folds its partitions into partial results which are then reduced.
+         */
+        void visitParallelAggregateLoop(const RamAbstractAggregate& aggregate, const RamOperation& op,
+                const std::string& type, const std::string& init, const std::string& partition,
+                const std::string& relName, std::ostream& out) {
+            const std::string res = "res0";
+            // minimal size of a relation for aggregates over it to be evaluated in parallel
+            constexpr size_t PARALLEL_AGGREGATE_THRESHOLD = 1 << 16;
+
+            out << "auto part = " << partition << ";\n";
+            out << "WorkStealingLoop loop(part.size());\n";
+            // small relations are not worth forking threads
+            out << "PARALLEL_START_IF(" << relName << "->size() >= " << PARALLEL_AGGREGATE_THRESHOLD << ")\n";
+
+            // operation contexts are private to a thread
+            for (const RamRelation* rel : synthesiser.getReferencedRelations(op)) {
+                out << "CREATE_OP_CONTEXT(" << synthesiser.getOpContextName(*rel);
+                out << "," << synthesiser.getRelationName(*rel);
+                out << "->createContext());\n";
+            }
+
+            out << "bool shouldRunNested_part = false;\n";
+            out << type << " " << res << "_part = " << init << ";\n";
+            out << "std::pair<RamFloat, RamFloat> accumulateMean_part = {0, 0};\n";
+
+            out << "size_t partition;\n";
+            out << "while (loop.next(partition)) {\n";
+            out << "try{\n";
+            visitAggregateLoop(aggregate, 0, type, "_part", "part[partition]", out);
+            out << "} catch(std::exception &e) { SignalHandler::instance()->error(e.what());}\n";
+            out << "}\n";
+
+            // reduce the partial results
+            out << "PARALLEL_CRITICAL {\n";
+            out << "shouldRunNested = shouldRunNested || shouldRunNested_part;\n";
+            switch (aggregate.getFunction()) {
+                case AggregateOp::FMIN:
+                case AggregateOp::UMIN:
+                case AggregateOp::MIN:
+                    out << res << " = std::min(" << res << "," << res << "_part);\n";
+                    break;
+                case AggregateOp::FMAX:
+                case AggregateOp::UMAX:
+                case AggregateOp::MAX:
+                    out << res << " = std::max(" << res << "," << res << "_part);\n";
+                    break;
+                case AggregateOp::COUNT:
+                case AggregateOp::FSUM:
+                case AggregateOp::USUM:
+                case AggregateOp::SUM:
+                    out << res << " += " << res << "_part;\n";
+                    break;
+                case AggregateOp::MEAN:
+                    out << "accumulateMean.first += accumulateMean_part.first;\n";
+                    out << "accumulateMean.second += accumulateMean_part.second;\n";
+                    break;
+            }
+            out << "}\n";
+            out << "PARALLEL_END\n";
+            visitBusyTime(out);
+        }
+
+        /** Emit the report of the busy time of the threads of the parallel loop of a query */
+        void visitBusyTime(std::ostream& out) {
+            if (!Global::config().has("profile")) {
+                return;
+            }
+            out << "for (size_t thread = 0; thread < loop.getNumThreads(); ++thread) {\n";
+            out << "ProfileEventSingleton::instance().addBusyTime(thread, loop.getBusyTime(thread));\n";
+            out << "}\n";
+        }
+
         void visitIndexAggregate(const RamIndexAggregate& aggregate, std::ostream& out) override {
             PRINT_BEGIN_COMMENT(out);
             // get some properties
@@ -895,78 +1072,30 @@ void Synthesiser::emitCode(std::ostream& out, const RamStatement& stmt) {
             out << type << " res" << identifier << " = " << init << ";\n";
 
             if (aggregate.getFunction() == AggregateOp::MEAN) {
-                out << "if (accumulateMean.second != 0) {\n";
-                out << "res" << identifier << " = accumulateMean.first / accumulateMean.second;\n";
-                out << "}\n";
+                out << "std::pair<RamFloat, RamFloat> accumulateMean = {0, 0};\n";
             }
 
             // check whether there is an index to use
-            if (keys == 0) {
-                out << "for(const auto& env" << identifier << " : "
-                    << "*" << relName << ") {\n";
-            } else {
+            std::string source = "*" + relName;
+            if (keys != 0) {
                 const auto& patterns = aggregate.getRangePattern();
                 out << "const " << tuple_type << " key{{";
                 out << join(patterns.begin(), patterns.begin() + arity, ",", recWithDefault);
                 out << "}};\n";
                 out << "auto range = " << relName << "->"
                     << "equalRange_" << keys << "(key," << ctxName << ");\n";
-
-                // aggregate result
-                out << "for(const auto& env" << identifier << " : range) {\n";
+                source = "range";
             }
 
-            // produce condition inside the loop
-            out << "if( ";
-            visit(aggregate.getCondition(), out);
-            out << ") {\n";
-
-            out << "shouldRunNested = true;\n";
-
-            // pick function
-            switch (aggregate.getFunction()) {
-                case AggregateOp::FMIN:
-                case AggregateOp::UMIN:
-                case AggregateOp::MIN:
-                    out << "res" << identifier << " = std::min(res" << identifier << ",ramBitCast<" << type
-                        << ">(";
-                    visit(aggregate.getExpression(), out);
-                    out << "));\n";
-                    break;
-                case AggregateOp::FMAX:
-                case AggregateOp::UMAX:
-                case AggregateOp::MAX:
-                    out << "res" << identifier << " = std::max(res" << identifier << ",ramBitCast<" << type
-                        << ">(";
-                    visit(aggregate.getExpression(), out);
-                    out << "));\n";
-                    break;
-                case AggregateOp::COUNT:
-                    out << "++res" << identifier << "\n;";
-                    break;
-                case AggregateOp::FSUM:
-                case AggregateOp::USUM:
-                case AggregateOp::SUM:
-                    out << "res" << identifier << " += "
-                        << "ramBitCast<" << type << ">(";
-                    visit(aggregate.getExpression(), out);
-                    out << ");\n";
-                    break;
-
-                case AggregateOp::MEAN:
-                    out << "accumulateMean.first += "
-                        << "ramBitCast<RamFloat>(";
-                    visit(aggregate.getExpression(), out);
-                    out << ");\n";
-                    out << "++accumulateMean.second;\n";
-                    break;
+            // aggregate result
+            if (isParallelAggregate(aggregate)) {
+                std::string partition = keys == 0 ? relName + "->partition()"
+                                                  : "range.partition(MAX_THREADS * PARTITIONS_PER_THREAD)";
+                visitParallelAggregateLoop(aggregate, aggregate, type, init, partition, relName, out);
+            } else {
+                visitAggregateLoop(aggregate, identifier, type, "", source, out);
             }
 
-            out << "}\n";
-
-            // end aggregator loop
-            out << "}\n";
-
             if (aggregate.getFunction() == AggregateOp::MEAN) {
                 out << "if (accumulateMean.second != 0) {\n";
                 out << "res" << identifier << " = accumulateMean.first / accumulateMean.second;\n";
@@ -1065,61 +1194,14 @@ void Synthesiser::emitCode(std::ostream& out, const RamStatement& stmt) {
                 out << "std::pair<RamFloat, RamFloat> accumulateMean = {0, 0};\n";
             }
 
-            // check whether there is an index to use
-            out << "for(const auto& env" << identifier << " : "
-                << "*" << relName << ") {\n";
-
-            // produce condition inside the loop
-            out << "if( ";
-            visit(aggregate.getCondition(), out);
-            out << ") {\n";
-
-            out << "shouldRunNested = true;\n";
-            // pick function
-            switch (aggregate.getFunction()) {
-                case AggregateOp::FMIN:
-                case AggregateOp::UMIN:
-                case AggregateOp::MIN:
-                    out << "res" << identifier << " = std::min(res" << identifier << ",ramBitCast<" << type
-                        << ">(";
-                    visit(aggregate.getExpression(), out);
-                    out << "));\n";
-                    break;
-                case AggregateOp::FMAX:
-                case AggregateOp::UMAX:
-                case AggregateOp::MAX:
-                    out << "res" << identifier << " = std::max(res" << identifier << ",ramBitCast<" << type
-                        << ">(";
-                    visit(aggregate.getExpression(), out);
-                    out << "));\n";
-                    break;
-                case AggregateOp::COUNT:
-                    out << "++res" << identifier << "\n;";
-                    break;
-                case AggregateOp::FSUM:
-                case AggregateOp::USUM:
-                case AggregateOp::SUM:
-                    out << "res" << identifier << " += "
-                        << "ramBitCast<" << type << ">(";
-                    ;
-                    visit(aggregate.getExpression(), out);
-                    out << ");\n";
-                    break;
-
-                case AggregateOp::MEAN:
-                    out << "accumulateMean.first += "
-                        << "ramBitCast<RamFloat>(";
-                    visit(aggregate.getExpression(), out);
-                    out << ");\n";
-                    out << "++accumulateMean.second;\n";
-                    break;
+            // aggregate result
+            if (isParallelAggregate(aggregate)) {
+                visitParallelAggregateLoop(
+                        aggregate, aggregate, type, init, relName + "->partition()", relName, out);
+            } else {
+                visitAggregateLoop(aggregate, identifier, type, "", "*" + relName, out);
             }
 
-            out << "}\n";
-
-            // end aggregator loop
-            out << "}\n";
-
             if (aggregate.getFunction() == AggregateOp::MEAN) {
                 out << "res" << identifier << " = accumulateMean.first / accumulateMean.second;\n";
             }
@@ -1168,6 +1250,7 @@ void Synthesiser::emitCode(std::ostream& out, const RamStatement& stmt) {
             // insert tuple
             out << relName << "->"
                 << "insert(tuple," << ctxName << ");\n";
+            out << "++derivedTuples;\n";
 
             PRINT_END_COMMENT(out);
         }
@@ -1244,18 +1327,20 @@ void Synthesiser::emitCode(std::ostream& out, const RamStatement& stmt) {
                 COMPARE(GE, >=)
 
                 // strings
-                case BinaryConstraintOp::MATCH: {
-                    out << "regex_wrapper(symTable.resolve(";
-                    visit(rel.getLHS(), out);
-                    out << "),symTable.resolve(";
-                    visit(rel.getRHS(), out);
-                    out << "))";
-                    break;
-                }
+                case BinaryConstraintOp::MATCH:
                 case BinaryConstraintOp::NOT_MATCH: {
-                    out << "!regex_wrapper(symTable.resolve(";
-                    visit(rel.getLHS(), out);
-                    out << "),symTable.resolve(";
+                    if (rel.getOperator() == BinaryConstraintOp::NOT_MATCH) {
+                        out << "!";
+                    }
+                    // constant patterns are compiled once, see generateCode
+                    if (const auto* pattern = dynamic_cast<const RamSignedConstant*>(&rel.getLHS())) {
+                        out << "regex_wrapper(regex_" << pattern->getConstant() << ".get(),";
+                        out << pattern->getConstant();
+                    } else {
+                        out << "regex_wrapper(";
+                        visit(rel.getLHS(), out);
+                    }
+                    out << ",symTable.resolve(";
                     visit(rel.getRHS(), out);
                     out << "))";
                     break;
@@ -1831,15 +1916,21 @@ void Synthesiser::generateCode(std::ostream& os, const std::string& id, bool& wi
 
     os << "class " << classname << " : public SouffleProgram {\n";
 
-    // regex wrapper
+    // regex wrapper; patterns are compiled once, constant ones when the program is constructed
     os << "private:\n";
-    os << "static inline bool regex_wrapper(const std::string& pattern, const std::string& text) {\n";
+    os << "inline bool regex_wrapper(const std::regex* regex, RamDomain pattern, "
+          "const std::string& text) {\n";
     os << "   bool result = false; \n";
-    os << "   try { result = std::regex_match(text, std::regex(pattern)); } catch(...) { \n";
-    os << "     std::cerr << \"warning: wrong pattern provided for match(\\\"\" << pattern << \"\\\",\\\"\" "
-          "<< text << \"\\\").\\n\";\n}\n";
+    os << "   try { if (regex != nullptr) result = std::regex_match(text, *regex); } "
+          "catch(...) { regex = nullptr; }\n";
+    os << "   if (regex == nullptr) {\n";
+    os << "     std::cerr << \"warning: wrong pattern provided for match(\\\"\" << symTable.resolve(pattern) "
+          "<< \"\\\",\\\"\" << text << \"\\\").\\n\";\n}\n";
     os << "   return result;\n";
     os << "}\n";
+    os << "inline bool regex_wrapper(RamDomain pattern, const std::string& text) {\n";
+    os << "   return regex_wrapper(regexCache.get(pattern, symTable).get(), pattern, text);\n";
+    os << "}\n";
 
     // substring wrapper
     os << "private:\n";
@@ -1889,6 +1980,22 @@ void Synthesiser::generateCode(std::ostream& os, const std::string& id, bool& wi
     os << "RecordTable recordTable;"
        << "\n";
 
+    // compiled patterns of match constraints
+    os << "RegexCache regexCache;\n";
+    std::set<RamDomain> patterns;
+    visitDepthFirst(prog, [&](const RamConstraint& constraint) {
+        BinaryConstraintOp op = constraint.getOperator();
+        if (op == BinaryConstraintOp::MATCH || op == BinaryConstraintOp::NOT_MATCH) {
+            if (const auto* pattern = dynamic_cast<const RamSignedConstant*>(&constraint.getLHS())) {
+                patterns.insert(pattern->getConstant());
+            }
+        }
+    });
+    for (RamDomain pattern : patterns) {
+        os << "const RegexCache::RegexPtr regex_" << pattern << " = RegexCache::compile(R\"_("
+           << symTable.resolve(pattern) << ")_\");\n";
+    }
+
     if (Global::config().has("profile")) {
         os << "private:\n";
         size_t numFreq = 0;
@@ -2027,6 +2134,7 @@ void Synthesiser::generateCode(std::ostream& os, const std::string& id, bool& wi
         os << "std::atomic<RamDomain> ctr(0);\n\n";
     }
     os << "std::atomic<size_t> iter(0);\n\n";
+    os << "budget.start();\n";
 
     // set default threads (in embedded mode)
     // if this is not set, and omp is used, the default omp setting of number of cores is used.
@@ -2074,6 +2182,7 @@ void Synthesiser::generateCode(std::ostream& os, const std::string& id, bool& wi
     }
     os << "}\n";
 
+    os << "budget.finish();\n";
     os << "SignalHandler::instance()->reset();\n";
 
     os << "}\n";  // end of runFunction() method
@@ -2140,6 +2249,7 @@ void Synthesiser::generateCode(std::ostream& os, const std::string& id, bool& wi
             os << "\tProfileEventSingleton::instance().makeQuantityEvent(R\"_(@relation-reads;" << cur.first
                << ")_\", reads[" << cur.second << "],0);\n";
         }
+        os << "\tProfileEventSingleton::instance().makeBusyTimeEvents();\n";
         os << "}\n";  // end of dumpFreqs() method
     }
     // issue loadAll method
@@ -2160,6 +2270,9 @@ void Synthesiser::generateCode(std::ostream& os, const std::string& id, bool& wi
         os << "rwOperation, symTable, recordTable";
         os << ")->readAll(*" << getRelationName(load->getRelation());
         os << ");\n";
+        if (load->getRelation().getRepresentation() == RelationRepresentation::SORTED) {
+            os << getRelationName(load->getRelation()) << "->seal();\n";
+        }
         os << "} catch (std::exception& e) {std::cerr << \"Error loading data: \" << e.what() << "
               "'\\n';}\n";
     }
@@ -2316,6 +2429,18 @@ void Synthesiser::generateCode(std::ostream& os, const std::string& id, bool& wi
     os << "obj.setNumThreads(opt.getNumJobs());\n";
     os << "\n#endif\n";
 
+    // limits of the evaluation
+    if (Global::config().has("time-limit")) {
+        os << "obj.getBudget().setTimeLimit(std::chrono::milliseconds(" << Global::config().get("time-limit")
+           << "));\n";
+    }
+    if (Global::config().has("tuple-limit")) {
+        os << "obj.getBudget().setTupleLimit(" << Global::config().get("tuple-limit") << "ULL);\n";
+    }
+    if (Global::config().has("memory-limit")) {
+        os << "obj.getBudget().setMemoryLimit(" << Global::config().get("memory-limit") << "ULL << 20);\n";
+    }
+
     if (Global::config().has("profile")) {
         os << R"_(souffle::ProfileEventSingleton::instance().makeConfigRecord("", opt.getSourceFileName());)_"
            << '\n';
@@ -2329,6 +2454,11 @@ void Synthesiser::generateCode(std::ostream& os, const std::string& id, bool& wi
            << Global::config().get("version") << R"_(");)_" << '\n';
     }
     os << "obj.runAll(opt.getInputFileDir(), opt.getOutputFileDir());\n";
+    os << "if (obj.getBudget().isExhausted()) {\n";
+    os << R"_(std::cerr << "Warning: evaluation stopped early, " << )_"
+       << "souffle::EvaluationBudget::getStatusText(obj.getBudget().getStatus()) << "
+       << R"_("; relations are incomplete\n";)_" << '\n';
+    os << "}\n";
 
     if (Global::config().get("provenance") == "explain") {
         os << "explain(obj, false, false);\n";
@@ -27,7 +27,9 @@ std::unique_ptr<SynthesiserRelation> SynthesiserRelation::getSynthesiserRelation
         rel = new SynthesiserDirectRelation(ramRel, indexSet, isProvenance);
     } else if (ramRel.isNullary()) {
         rel = new SynthesiserNullaryRelation(ramRel, indexSet, isProvenance);
-    } else if (ramRel.getRepresentation() == RelationRepresentation::BTREE) {
+    } else if (ramRel.getRepresentation() == RelationRepresentation::BTREE ||
+               ramRel.getRepresentation() == RelationRepresentation::HASHSET ||
+               ramRel.getRepresentation() == RelationRepresentation::SORTED) {
         rel = new SynthesiserDirectRelation(ramRel, indexSet, isProvenance);
     } else if (ramRel.getRepresentation() == RelationRepresentation::BRIE) {
         rel = new SynthesiserBrieRelation(ramRel, indexSet, isProvenance);
@@ -189,7 +191,11 @@ void SynthesiserDirectRelation::computeIndices() {
     }
 
     if (!isProvenance) {
+        // use the first ordered index as master index, such that iteration is ordered
         masterIndex = 0;
+        while (masterIndex + 1 < inds.size() && isHashIndex(masterIndex)) {
+            masterIndex++;
+        }
     }
 
     assert(masterIndex < inds.size());
@@ -197,13 +203,27 @@ void SynthesiserDirectRelation::computeIndices() {
     computedIndices = inds;
 }
 
+/** Check whether an index of a direct indexed relation is a hash index */
+bool SynthesiserDirectRelation::isHashIndex(size_t i) const {
+    return !isProvenance && i < indices.getAllOrders().size() && indices.isHashIndex(i);
+}
+
+/** Check whether the indexes of a direct indexed relation are sorted arrays */
+bool SynthesiserDirectRelation::isSorted() const {
+    return !isProvenance && relation.getRepresentation() == RelationRepresentation::SORTED;
+}
+
 /** Generate type name of a direct indexed relation */
 std::string SynthesiserDirectRelation::getTypeName() {
     std::stringstream res;
-    res << "t_btree_" << getArity();
+    res << (isSorted() ? "t_sorted_" : "t_btree_") << getArity();
 
-    for (auto& ind : getIndices()) {
-        res << "__" << join(ind, "_");
+    const auto& inds = getIndices();
+    for (size_t i = 0; i < inds.size(); i++) {
+        res << "__" << join(inds[i], "_");
+        if (isHashIndex(i)) {
+            res << "_hash" << indices.getHashKeyLength(i);
+        }
     }
 
     for (auto& search : getMinIndexSelection().getSearches()) {
@@ -265,6 +285,14 @@ void SynthesiserDirectRelation::generateTypeStruct(std::ostream& out) {
                 out << join(ind.begin(), ind.end()) << ">, updater_" << getTypeName() << ">;\n";
             }
             // without provenance, some indices may be not full, so we use btree_multiset for those
+        } else if (isHashIndex(i)) {
+            // the key of a hash index is the prefix of the order bound by its only search
+            auto key = join(ind.begin(), ind.begin() + getMinIndexSelection().getHashKeyLength(i));
+            out << "using t_ind_" << i << " = hash_set<t_tuple, index_utils::hasher<" << key
+                << ">, index_utils::comparator<" << key << ">>;\n";
+        } else if (isSorted()) {
+            out << "using t_ind_" << i << " = sorted_array<t_tuple, index_utils::comparator<" << join(ind)
+                << ">" << (ind.size() == arity ? "" : ", false") << ">;\n";
         } else {
             if (ind.size() == arity) {
                 out << "using t_ind_" << i << " = btree_set<t_tuple, index_utils::comparator<" << join(ind)
@@ -324,6 +352,65 @@ void SynthesiserDirectRelation::generateTypeStruct(std::ostream& out) {
     out << "return insert(data);\n";
     out << "}\n";  // end of insert(RamDomain x1, RamDomain x2, ...)
 
+    // insertAll method merging all tuples of another relation
+    out << "template <typename T>\n";
+    out << "void insertAll(T& other) {\n";
+    if (isProvenance) {
+        // provenance annotations are updated tuple by tuple
+        out << "for (auto const& cur : other) {\n";
+        out << "insert(cur);\n";
+        out << "}\n";
+    } else {
+        // the tuples not present yet, sorted in the order of the master index
+        out << "std::vector<t_tuple> tuples;\n";
+        out << "tuples.reserve(other.size());\n";
+        out << "for (auto const& cur : other) {\n";
+        out << "tuples.push_back(cur);\n";
+        out << "}\n";
+        out << "auto less_" << masterIndex << " = [](const t_tuple& a, const t_tuple& b) { return "
+            << "index_utils::comparator<" << join(inds[masterIndex]) << ">().less(a, b); };\n";
+        out << "if (!std::is_sorted(tuples.begin(), tuples.end(), less_" << masterIndex << ")) {\n";
+        out << "std::sort(tuples.begin(), tuples.end(), less_" << masterIndex << ");\n";
+        out << "}\n";
+        out << "context h;\n";
+        out << "tuples.erase(std::remove_if(tuples.begin(), tuples.end(), [&](const t_tuple& t) { "
+               "return contains(t, h); }), tuples.end());\n";
+
+        // sorted tuples are merged into b-trees in bulk, the indexes in parallel
+        auto mergeIndex = [&](size_t i) {
+            if (isSorted()) {
+                out << "ind_" << i << ".insertAll(tuples.begin(), tuples.end());\n";
+            } else if (isHashIndex(i)) {
+                out << "ind_" << i << ".reserve(ind_" << i << ".size() + tuples.size());\n";
+                out << "ind_" << i << ".insert(tuples.begin(), tuples.end());\n";
+            } else if (i == masterIndex) {
+                out << "ind_" << i << ".insertAll(tuples.begin(), tuples.end());\n";
+            } else {
+                out << "std::vector<t_tuple> sorted(tuples);\n";
+                out << "std::sort(sorted.begin(), sorted.end(), [](const t_tuple& a, const t_tuple& b) { "
+                    << "return index_utils::comparator<" << join(inds[i]) << ">().less(a, b); });\n";
+                out << "ind_" << i << ".insertAll(sorted.begin(), sorted.end());\n";
+            }
+        };
+        if (numIndexes == 1) {
+            mergeIndex(0);
+        } else {
+            out << "PARALLEL_START\n";
+            out << "pfor (int i = 0; i < " << numIndexes << "; ++i) {\n";
+            out << "switch (i) {\n";
+            for (size_t i = 0; i < numIndexes; i++) {
+                out << "case " << i << ": {\n";
+                mergeIndex(i);
+                out << "break;\n";
+                out << "}\n";
+            }
+            out << "}\n";
+            out << "}\n";
+            out << "PARALLEL_END\n";
+        }
+    }
+    out << "}\n";  // end of insertAll(T& other)
+
     // contains methods
     out << "bool contains(const t_tuple& t, context& h) const {\n";
     out << "return ind_" << masterIndex << ".contains(t, h.hints_" << masterIndex << ");\n";
@@ -374,8 +461,11 @@ void SynthesiserDirectRelation::generateTypeStruct(std::ostream& out) {
             }
         }
 
-        // use the more efficient find() method if the search pattern is full
-        if (indSize == arity) {
+        // hash indexes enumerate the tuples sharing the key
+        if (isHashIndex(indNum)) {
+            out << "return ind_" << indNum << ".equal_range(t, h.hints_" << indNum << ");\n";
+        } else if (indSize == arity) {
+            // use the more efficient find() method if the search pattern is full
             out << "auto pos = ind_" << indNum << ".find(t, h.hints_" << indNum << ");\n";
             out << "auto fin = ind_" << indNum << ".end();\n";
             out << "if (pos != fin) {fin = pos; ++fin;}\n";
@@ -410,7 +500,7 @@ void SynthesiserDirectRelation::generateTypeStruct(std::ostream& out) {
 
     // partition method for parallelism
     out << "std::vector<range<iterator>> partition() const {\n";
-    out << "return ind_" << masterIndex << ".getChunks(400);\n";
+    out << "return ind_" << masterIndex << ".getChunks(getPartitionCount(size(), MAX_THREADS));\n";
     out << "}\n";
 
     // purge method
@@ -420,6 +510,25 @@ void SynthesiserDirectRelation::generateTypeStruct(std::ostream& out) {
     }
     out << "}\n";
 
+    // seal method sorting the loaded tuples into the arrays, the indexes in parallel
+    if (isSorted()) {
+        out << "void seal() {\n";
+        if (numIndexes > 1) {
+            out << "PARALLEL_START\n";
+            out << "pfor (int i = 0; i < " << numIndexes << "; ++i) {\n";
+            out << "switch (i) {\n";
+            for (size_t i = 0; i < numIndexes; i++) {
+                out << "case " << i << ": ind_" << i << ".seal(); break;\n";
+            }
+            out << "}\n";
+            out << "}\n";
+            out << "PARALLEL_END\n";
+        } else {
+            out << "ind_0.seal();\n";
+        }
+        out << "}\n";
+    }
+
     // begin and end iterators
     out << "iterator begin() const {\n";
     out << "return ind_" << masterIndex << ".begin();\n";
@@ -443,6 +552,10 @@ void SynthesiserDirectRelation::generateTypeStruct(std::ostream& out) {
     // printHintStatistics method
     out << "void printHintStatistics(std::ostream& o, const std::string prefix) const {\n";
     for (size_t i = 0; i < numIndexes; i++) {
+        // hash indexes and sorted arrays take no hints
+        if (isHashIndex(i) || isSorted()) {
+            continue;
+        }
         out << "const auto& stats_" << i << " = ind_" << i << ".getHintStatistics();\n";
         out << "o << prefix << \"arity " << getArity() << " direct b-tree index " << inds[i]
             << ": (hits/misses/total)\\n\";\n";
@@ -623,6 +736,14 @@ void SynthesiserIndirectRelation::generateTypeStruct(std::ostream& out) {
     out << "return insert(data);\n";
     out << "}\n";  // end of insert(RamDomain x1, RamDomain x2, ...)
 
+    // insertAll method inserting all tuples of another relation
+    out << "template <typename T>\n";
+    out << "void insertAll(T& other) {\n";
+    out << "for (auto const& cur : other) {\n";
+    out << "insert(cur);\n";
+    out << "}\n";
+    out << "}\n";
+
     // contains methods
     out << "bool contains(const t_tuple& t, context& h) const {\n";
     out << "return ind_" << masterIndex << ".contains(&t, h.hints_" << masterIndex << ");\n";
@@ -707,7 +828,8 @@ void SynthesiserIndirectRelation::generateTypeStruct(std::ostream& out) {
     // partition method
     out << "std::vector<range<iterator>> partition() const {\n";
     out << "std::vector<range<iterator>> res;\n";
-    out << "for (const auto& cur : ind_" << masterIndex << ".getChunks(400)) {\n";
+    out << "for (const auto& cur : ind_" << masterIndex
+        << ".getChunks(getPartitionCount(size(), MAX_THREADS))) {\n";
     out << "    res.push_back(make_range(derefIter(cur.begin()), derefIter(cur.end())));\n";
     out << "}\n";
     out << "return res;\n";
@@ -914,6 +1036,14 @@ void SynthesiserBrieRelation::generateTypeStruct(std::ostream& out) {
     out << "return insert(data);\n";
     out << "}\n";
 
+    // insertAll method inserting all tuples of another relation
+    out << "template <typename T>\n";
+    out << "void insertAll(T& other) {\n";
+    out << "for (auto const& cur : other) {\n";
+    out << "insert(cur);\n";
+    out << "}\n";
+    out << "}\n";
+
     // contains methods
     out << "bool contains(const t_tuple& t, context& h) const {\n";
     out << "return ind_" << masterIndex << ".contains(orderIn_" << masterIndex << "(t), h.hints_"
@@ -1147,6 +1277,14 @@ void SynthesiserEqrelRelation::generateTypeStruct(std::ostream& out) {
     out << "return insert(data);\n";
     out << "}\n";
 
+    // insertAll method inserting all tuples of another relation
+    out << "template <typename T>\n";
+    out << "void insertAll(T& other) {\n";
+    out << "for (auto const& cur : other) {\n";
+    out << "insert(cur);\n";
+    out << "}\n";
+    out << "}\n";
+
     // extends method for eqrel
     // performs a delta extension, where we union the sets that share elements between this and other.
     //      i.e. if a in this, and a in other, union(set(this->a), set(other->a))
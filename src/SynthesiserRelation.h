@@ -121,6 +121,13 @@ public:
     void computeIndices() override;
     std::string getTypeName() override;
     void generateTypeStruct(std::ostream& out) override;
+
+private:
+    /** Check whether an index is stored in a hash set rather than a btree */
+    bool isHashIndex(size_t i) const;
+
+    /** Check whether the indexes are stored in sorted arrays rather than btrees */
+    bool isSorted() const;
 };
 
 class SynthesiserIndirectRelation : public SynthesiserRelation {
@@ -0,0 +1,161 @@
+/*
+ * Souffle - A Datalog Compiler
+ * Copyright (c) 2020, The Souffle Developers. All rights reserved.
+ * Licensed under the Universal Permissive License v 1.0 as shown at:
+ * - https://opensource.org/licenses/UPL
+ * - <souffle root>/licenses/SOUFFLE-UPL.txt
+ */
+
+/************************************************************************
+ *
+ * @file WorkStealing.h
+ *
+ * Scheduling of the partitions of parallel loops by work stealing.
+ * Used by the interpreter and the synthesised code.
+ *
+ ***********************************************************************/
+
+#pragma once
+
+#include "ParallelUtils.h"
+#include <algorithm>
+#include <cassert>
+#include <chrono>
+#include <cstddef>
+#include <memory>
+#include <mutex>
+
+namespace souffle {
+
+/** Number of partitions per thread of a parallel loop; the surplus lets idle threads balance skew */
+constexpr std::size_t PARTITIONS_PER_THREAD = 8;
+
+/** Minimal number of tuples per partition, below which scheduling costs more than it balances */
+constexpr std::size_t MIN_PARTITION_SIZE = 256;
+
+/** @brief Return the number of partitions of a parallel loop over the given number of tuples */
+inline std::size_t getPartitionCount(std::size_t size, std::size_t numThreads) {
+    std::size_t count = std::min(numThreads * PARTITIONS_PER_THREAD, size / MIN_PARTITION_SIZE);
+    return std::max(count, numThreads);
+}
+
+/**
+ * @class WorkStealingLoop
+ * @brief Distributes the partitions [0, size) of a loop among the threads of a parallel region.
+ *
+ * Each thread starts with a contiguous range of partitions which it consumes from the front.
+ * A thread whose range is exhausted steals the back half of the range of another thread,
+ * so long partitions delay only the thread processing them.
+ * The time between claiming a partition and asking for the next one counts as busy time.
+ */
+class WorkStealingLoop {
+    using clock = std::chrono::steady_clock;
+
+public:
+    /** Create a loop for the threads of the next parallel region */
+    explicit WorkStealingLoop(std::size_t size) : WorkStealingLoop(size, MAX_THREADS) {}
+
+    WorkStealingLoop(std::size_t size, std::size_t numThreads)
+            : numThreads(std::max<std::size_t>(numThreads, 1)), slots(new Slot[this->numThreads]) {
+        for (std::size_t i = 0; i < this->numThreads; ++i) {
+            slots[i].begin = size * i / this->numThreads;
+            slots[i].end = size * (i + 1) / this->numThreads;
+        }
+    }
+
+    WorkStealingLoop(const WorkStealingLoop&) = delete;
+    WorkStealingLoop& operator=(const WorkStealingLoop&) = delete;
+
+    /** @brief Claim the next partition for the calling thread; return false once the loop is done */
+    bool next(std::size_t& index) {
+        const std::size_t thread = getThreadNum();
+        assert(thread < numThreads && "more threads than expected");
+        Slot& own = slots[thread];
+
+        // the previous partition of this thread is done
+        clock::time_point now = clock::now();
+        if (own.running) {
+            own.busy += now - own.start;
+            own.running = false;
+        }
+
+        if (!take(own, index) && !steal(thread, index)) {
+            return false;
+        }
+        own.start = now;
+        own.running = true;
+        return true;
+    }
+
+    /** @brief Return the number of threads the partitions were distributed among */
+    std::size_t getNumThreads() const {
+        return numThreads;
+    }
+
+    /** @brief Return the time the given thread spent on partitions */
+    std::chrono::microseconds getBusyTime(std::size_t thread) const {
+        return std::chrono::duration_cast<std::chrono::microseconds>(slots[thread].busy);
+    }
+
+private:
+    /** Remaining partitions and busy time of one thread, on a cache line of its own */
+    struct alignas(64) Slot {
+        std::mutex lock;
+        std::size_t begin = 0;
+        std::size_t end = 0;
+        /** Time the current partition was claimed, if running */
+        clock::time_point start;
+        bool running = false;
+        clock::duration busy{0};
+    };
+
+    static std::size_t getThreadNum() {
+#ifdef _OPENMP
+        return omp_get_thread_num();
+#else
+        return 0;
+#endif
+    }
+
+    /** @brief Take the first partition of a range */
+    static bool take(Slot& slot, std::size_t& index) {
+        std::lock_guard<std::mutex> guard(slot.lock);
+        if (slot.begin == slot.end) {
+            return false;
+        }
+        index = slot.begin++;
+        return true;
+    }
+
+    /** @brief Move the back half of the range of another thread to the given thread */
+    bool steal(std::size_t thread, std::size_t& index) {
+        for (std::size_t i = 1; i < numThreads; ++i) {
+            Slot& victim = slots[(thread + i) % numThreads];
+            std::size_t begin;
+            std::size_t end;
+            {
+                std::lock_guard<std::mutex> guard(victim.lock);
+                if (victim.begin == victim.end) {
+                    continue;
+                }
+                begin = victim.begin + (victim.end - victim.begin) / 2;
+                end = victim.end;
+                victim.end = begin;
+            }
+
+            // the range is empty, hence nobody steals from it meanwhile
+            Slot& own = slots[thread];
+            std::lock_guard<std::mutex> guard(own.lock);
+            index = begin;
+            own.begin = begin + 1;
+            own.end = end;
+            return true;
+        }
+        return false;
+    }
+
+    const std::size_t numThreads;
+    std::unique_ptr<Slot[]> slots;
+};
+
+}  // namespace souffle
@@ -25,6 +25,7 @@
 #include "DebugReport.h"
 #include "DebugReporter.h"
 #include "ErrorReport.h"
+#include "EvaluationBudget.h"
 #include "Explain.h"
 #include "Global.h"
 #include "InterpreterEngine.h"
@@ -193,6 +194,24 @@ int main(int argc, char** argv) {
                         "transformed-ram | type-analysis ]",
                         "", false, "Print selected program information."},
                 {"parse-errors", '\5', "", "", false, "Show parsing errors, if any, then exit."},
+                {"parallel-nesting", '\6', "N", "2", false,
+                        "Maximum nesting of parallel regions in the interpreter; 1 runs the operations of "
+                        "concurrently evaluated rules on one thread each."},
+                {"insert-buffers", '\7', "", "", false,
+                        "Let each thread of a parallel loop in the interpreter buffer the tuples it derives "
+                        "and insert them in bulk at the end of the loop."},
+                {"jit", '\10', "MS", "", false,
+                        "Compile queries of the interpreter to native code in the background once the "
+                        "interpreter spent MS milliseconds in them."},
+                {"time-limit", '\11', "MS", "", false,
+                        "Stop the evaluation after MS milliseconds, keeping the "
+                        "relations computed so far."},
+                {"tuple-limit", '\12', "N", "", false,
+                        "Stop the evaluation once it derived N tuples, keeping the "
+                        "relations computed so far."},
+                {"memory-limit", '\13', "MB", "", false,
+                        "Stop the evaluation once the process holds MB megabytes of "
+                        "memory, keeping the relations computed so far."},
                 {"help", 'h', "", "", false, "Display this help message."}};
         Global::config().processArgs(argc, argv, header.str(), footer.str(), options);
 
@@ -256,6 +275,24 @@ int main(int argc, char** argv) {
         }
 #endif
 
+        /* the nesting of parallel regions must be a positive number */
+        if (!isNumber(Global::config().get("parallel-nesting").c_str()) ||
+                std::stoi(Global::config().get("parallel-nesting")) < 1) {
+            throw std::runtime_error("--parallel-nesting may only be set to an integer greater than 0.");
+        }
+
+        /* the threshold of the tiered compilation must be a number of milliseconds */
+        if (Global::config().has("jit") && !isNumber(Global::config().get("jit").c_str())) {
+            throw std::runtime_error("--jit may only be set to a number of milliseconds.");
+        }
+
+        /* the limits of an evaluation must be numbers */
+        for (const char* limit : {"time-limit", "tuple-limit", "memory-limit"}) {
+            if (Global::config().has(limit) && !isNumber(Global::config().get(limit).c_str())) {
+                throw std::runtime_error("--" + std::string(limit) + " may only be set to a number.");
+            }
+        }
+
         /* if an output directory is given, check it exists */
         if (Global::config().has("output-dir") && !Global::config().has("output-dir", "-") &&
                 !existDir(Global::config().get("output-dir")) &&
@@ -332,6 +369,13 @@ int main(int argc, char** argv) {
         throw std::runtime_error("failed to determine souffle executable path");
     }
 
+    /* compiled queries include the installed headers, or the headers next to an uninstalled souffle */
+    std::string jitIncludeDir = dirName(souffleExecutable) + "/../include/souffle";
+    if (!existDir(jitIncludeDir)) {
+        jitIncludeDir = dirName(souffleExecutable);
+    }
+    Global::config().set("jit-include-dir", jitIncludeDir);
+
     /* Create the pipe to establish a communication between cpp and souffle */
     std::string cmd = ::which("mcpp");
 
@@ -569,10 +613,22 @@ int main(int argc, char** argv) {
                 profiler = std::thread([]() { profile::Tui().runProf(); });
             }
 
+#ifdef _OPENMP
+            // the nesting of parallel regions is process-wide state of OpenMP; the command line
+            // owns the process and sets it once, the interpreter only reads it
+            omp_set_max_active_levels(std::stoi(Global::config().get("parallel-nesting")));
+#endif
+
             // configure and execute interpreter
             std::unique_ptr<InterpreterEngine> interpreter(
                     std::make_unique<InterpreterEngine>(*ramTranslationUnit));
             interpreter->executeMain();
+            const EvaluationBudget& budget = interpreter->getEnvironment().getBudget();
+            if (budget.isExhausted()) {
+                std::cerr << "Warning: evaluation stopped early, "
+                          << EvaluationBudget::getStatusText(budget.getStatus())
+                          << "; relations are incomplete\n";
+            }
             // If the profiler was started, join back here once it exits.
             if (profiler.joinable()) {
                 profiler.join();
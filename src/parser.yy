@@ -89,6 +89,7 @@
 %token BRIE_QUALIFIER            "BRIE datastructure qualifier"
 %token BTREE_QUALIFIER           "BTREE datastructure qualifier"
 %token EQREL_QUALIFIER           "equivalence relation qualifier"
+%token HASHSET_QUALIFIER         "HASHSET datastructure qualifier"
 %token OVERRIDABLE_QUALIFIER     "relation qualifier overidable"
 %token INLINE_QUALIFIER          "relation qualifier inline"
 %token TMATCH                    "match predicate"
@@ -574,27 +575,39 @@ relation_tags
   | relation_tags BRIE_QUALIFIER {
         if ($1.find(RelationTag::BRIE) != $1.end() ||
             $1.find(RelationTag::BTREE) != $1.end() ||
-            $1.find(RelationTag::EQREL) != $1.end())
-                driver.error(@2, "btree/brie/eqrel qualifier already set");
+            $1.find(RelationTag::EQREL) != $1.end() ||
+            $1.find(RelationTag::HASHSET) != $1.end())
+                driver.error(@2, "btree/brie/eqrel/hashset qualifier already set");
         $1.insert(RelationTag::BRIE);
         $$ = $1;
     }
   | relation_tags BTREE_QUALIFIER {
         if ($1.find(RelationTag::BRIE) != $1.end() ||
             $1.find(RelationTag::BTREE) != $1.end() ||
-            $1.find(RelationTag::EQREL) != $1.end())
-                driver.error(@2, "btree/brie/eqrel qualifier already set");
+            $1.find(RelationTag::EQREL) != $1.end() ||
+            $1.find(RelationTag::HASHSET) != $1.end())
+                driver.error(@2, "btree/brie/eqrel/hashset qualifier already set");
         $1.insert(RelationTag::BTREE);
         $$ = $1;
     }
   | relation_tags EQREL_QUALIFIER {
         if ($1.find(RelationTag::BRIE) != $1.end() ||
             $1.find(RelationTag::BTREE) != $1.end() ||
-            $1.find(RelationTag::EQREL) != $1.end())
-                driver.error(@2, "btree/brie/eqrel qualifier already set");
+            $1.find(RelationTag::EQREL) != $1.end() ||
+            $1.find(RelationTag::HASHSET) != $1.end())
+                driver.error(@2, "btree/brie/eqrel/hashset qualifier already set");
         $1.insert(RelationTag::EQREL);
         $$ = $1;
     }
+  | relation_tags HASHSET_QUALIFIER {
+        if ($1.find(RelationTag::BRIE) != $1.end() ||
+            $1.find(RelationTag::BTREE) != $1.end() ||
+            $1.find(RelationTag::EQREL) != $1.end() ||
+            $1.find(RelationTag::HASHSET) != $1.end())
+                driver.error(@2, "btree/brie/eqrel/hashset qualifier already set");
+        $1.insert(RelationTag::HASHSET);
+        $$ = $1;
+    }
   | %empty {
         $$ = std::set<RelationTag>();
     }
@@ -15,6 +15,8 @@
  ***********************************************************************/
 
 #include "BTree.h"
+#include "CompiledIndexUtils.h"
+#include "CompiledTuple.h"
 #include "test.h"
 
 #include <algorithm>
@@ -22,8 +24,10 @@
 #include <cstdlib>
 #include <iomanip>
 #include <iostream>
+#include <map>
 #include <random>
 #include <set>
+#include <string>
 #include <tuple>
 #include <unordered_set>
 #include <vector>
@@ -477,6 +481,157 @@ TEST(BTreeSet, Load) {
     }
 }
 
+TEST(BTreeSet, InsertAll) {
+    using test_set = btree_set<int, detail::comparator<int>, std::allocator<int>, 16>;
+
+    // covers both, insertions into large trees and rebuilds
+    for (int N : {0, 1, 10, 100, 1000}) {
+        for (size_t M : {0, 1, 10, 100, 1000}) {
+            test_set a;
+            test_set b;
+            std::set<int> should;
+            for (int i = 0; i < N; i++) {
+                a.insert(2 * i);
+                should.insert(2 * i);
+            }
+            for (size_t i = 0; i < M; i++) {
+                b.insert(3 * i);
+                should.insert(3 * i);
+            }
+
+            a.insertAll(b);
+            EXPECT_TRUE(a.check());
+            EXPECT_EQ(should.size(), a.size());
+            EXPECT_TRUE(std::equal(should.begin(), should.end(), a.begin()));
+            EXPECT_EQ(M, b.size());
+
+            // inserting the same elements again has no effect
+            a.insertAll(b);
+            EXPECT_EQ(should.size(), a.size());
+        }
+    }
+}
+
+/** Replaces the second component of a pair, the payload of sets keyed on the first one */
+struct payload_updater {
+    void update(std::tuple<int, int>& old_t, const std::tuple<int, int>& new_t) {
+        std::get<1>(old_t) = std::get<1>(new_t);
+    }
+};
+
+struct first_comparator {
+    int operator()(const std::tuple<int, int>& a, const std::tuple<int, int>& b) const {
+        return std::get<0>(a) < std::get<0>(b) ? -1 : (std::get<0>(a) > std::get<0>(b) ? 1 : 0);
+    }
+    bool less(const std::tuple<int, int>& a, const std::tuple<int, int>& b) const {
+        return std::get<0>(a) < std::get<0>(b);
+    }
+    bool equal(const std::tuple<int, int>& a, const std::tuple<int, int>& b) const {
+        return std::get<0>(a) == std::get<0>(b);
+    }
+};
+
+TEST(BTreeSet, InsertAllUpdate) {
+    using pair = std::tuple<int, int>;
+    using test_set = btree_set<pair, detail::comparator<pair>, std::allocator<pair>, 64,
+            detail::linear_search, first_comparator, payload_updater>;
+
+    for (int M : {10, 1000}) {
+        test_set a;
+        test_set b;
+        for (int i = 0; i < 1000; i++) {
+            a.insert(pair(i, 5));
+        }
+        for (int i = 0; i < M; i++) {
+            b.insert(pair(2 * i, i % 10));
+        }
+        a.insertAll(b);
+        EXPECT_TRUE(a.check());
+
+        // smaller payloads of equal keys replace present ones
+        std::map<int, int> should;
+        for (int i = 0; i < 1000; i++) {
+            should[i] = 5;
+        }
+        for (int i = 0; i < M; i++) {
+            should[2 * i] = std::min(should.count(2 * i) ? should[2 * i] : 10, i % 10);
+        }
+        EXPECT_EQ(should.size(), a.size());
+        auto it = a.begin();
+        for (const auto& cur : should) {
+            EXPECT_EQ(cur.first, std::get<0>(*it));
+            EXPECT_EQ(cur.second, std::get<1>(*it));
+            ++it;
+        }
+    }
+}
+
+TEST(BTreeSet, SimdSearch) {
+    std::mt19937 generator(7);
+    std::uniform_int_distribution<int> dist(-3, 3);
+
+    // compares the SIMD search with the binary search on sorted sequences of node size
+    auto check = [&](auto key, auto comp) {
+        using Key = decltype(key);
+        static_assert(detail::simd_searchable<Key, decltype(comp), const Key*>::value, "Not SIMD-searchable");
+        for (int n = 0; n < 40; n++) {
+            std::vector<Key> keys(n);
+            for (auto& cur : keys) {
+                for (std::size_t i = 0; i < Key::arity; i++) {
+                    cur[i] = dist(generator);
+                }
+            }
+            std::sort(keys.begin(), keys.end(), [&](const Key& a, const Key& b) { return comp.less(a, b); });
+            const Key* a = keys.data();
+            const Key* b = keys.data() + n;
+            for (int j = 0; j < 20; j++) {
+                Key k;
+                for (std::size_t i = 0; i < Key::arity; i++) {
+                    k[i] = dist(generator);
+                }
+                EXPECT_EQ(detail::binary_search().lower_bound(k, a, b, comp) - a,
+                        detail::simd_search().lower_bound(k, a, b, comp) - a);
+                EXPECT_EQ(detail::binary_search().upper_bound(k, a, b, comp) - a,
+                        detail::simd_search().upper_bound(k, a, b, comp) - a);
+            }
+        }
+    };
+    check(Tuple<int, 1>(), index_utils::comparator<0>());
+    check(Tuple<int, 2>(), index_utils::comparator<1, 0>());
+    check(Tuple<int, 2>(), index_utils::comparator<0>());
+    check(Tuple<int, 3>(), index_utils::comparator<2, 0>());
+    check(Tuple<int, 4>(), index_utils::comparator<3, 1, 0, 2>());
+
+    // narrow tuples are searched by SIMD instructions by default
+    using t_tuple = Tuple<int, 2>;
+    EXPECT_TRUE((std::is_same<detail::default_strategy<t_tuple>::type, detail::simd_search>::value));
+    EXPECT_TRUE((std::is_same<detail::default_strategy<Tuple<int, 5>>::type, detail::binary_search>::value));
+
+    btree_set<t_tuple, index_utils::comparator<1, 0>> t;
+    std::set<std::pair<int, int>> should;
+    std::uniform_int_distribution<int> wide(0, 999);
+    for (int i = 0; i < 10000; i++) {
+        t_tuple cur = {wide(generator), wide(generator) % 50};
+        t.insert(cur);
+        should.insert({cur[1], cur[0]});
+    }
+    EXPECT_EQ(should.size(), t.size());
+    auto pos = should.begin();
+    for (const auto& cur : t) {
+        EXPECT_EQ(pos->first, cur[1]);
+        EXPECT_EQ(pos->second, cur[0]);
+        ++pos;
+    }
+    for (int i = 0; i < 1000; i++) {
+        t_tuple k = {wide(generator), wide(generator) % 60};
+        EXPECT_EQ(should.count({k[1], k[0]}), t.contains(k) ? 1 : 0);
+        EXPECT_EQ(std::distance(should.begin(), should.lower_bound({k[1], k[0]})),
+                std::distance(t.begin(), t.lower_bound(k)));
+        EXPECT_EQ(std::distance(should.begin(), should.upper_bound({k[1], k[0]})),
+                std::distance(t.begin(), t.upper_bound(k)));
+    }
+}
+
 TEST(BTreeSet, Clear) {
     using test_set = btree_set<int, detail::comparator<int>, std::allocator<int>, 16>;
 
@@ -719,6 +874,101 @@ TEST(Performance, Load) {
     time("bulk-load", [&]() { auto t = btree_set<int>::load(data.begin(), data.end()); });
 }
 
+TEST(Performance, InsertAll) {
+    int N = 1 << 20;
+
+    std::vector<int> data;
+    for (int i = 0; i < N; i++) {
+        data.push_back(2 * i);
+    }
+
+    // merge sets of decreasing size into a large set
+    for (int ratio : {1, 4, 16, 64}) {
+        std::vector<int> delta;
+        for (int i = 0; i < N / ratio; i++) {
+            delta.push_back(2 * i * ratio + 1);
+        }
+        auto d = btree_set<int>::load(delta.begin(), delta.end());
+        std::cout << "\tMerging 1/" << ratio << ":\n";
+
+        auto a = btree_set<int>::load(data.begin(), data.end());
+        time("ordered insert", [&]() { a.insert(d.begin(), d.end()); });
+
+        auto b = btree_set<int>::load(data.begin(), data.end());
+        time("bulk merge", [&]() { b.insertAll(d); });
+
+        EXPECT_EQ(a.size(), b.size());
+        EXPECT_TRUE(a == b);
+    }
+}
+
+template <typename T>
+struct type_tag {
+    using type = T;
+};
+
+TEST(Performance, SimdSearch) {
+    int N = 1 << 20;
+
+    // compares binary and SIMD searches in trees of 1, 2 and 4 columns, nodes of the default size
+    auto bench = [&](auto tag, const std::string& name) {
+        using tree = typename decltype(tag)::type;
+        using Key = typename tree::element_type;
+        std::mt19937 generator(42);
+        std::uniform_int_distribution<int> dist(0, N / 4);
+        std::vector<Key> in(N);
+        std::vector<Key> out(N);
+        for (int i = 0; i < N; i++) {
+            for (std::size_t j = 0; j < Key::arity; j++) {
+                in[i][j] = 2 * dist(generator);
+                out[i][j] = 2 * dist(generator) + 1;
+            }
+        }
+
+        std::cout << "Testing: " << name << " ..\n";
+        tree t;
+        time("insert", [&]() {
+            for (const auto& cur : in) {
+                t.insert(cur);
+            }
+        });
+        bool allPresent = true;
+        time("contains in", [&]() {
+            for (const auto& cur : in) {
+                allPresent = t.contains(cur) && allPresent;
+            }
+        });
+        EXPECT_TRUE(allPresent);
+        bool allMissing = true;
+        time("contains out", [&]() {
+            for (const auto& cur : out) {
+                allMissing = !t.contains(cur) && allMissing;
+            }
+        });
+        EXPECT_TRUE(allMissing);
+        bool allFound = true;
+        time("lower_bound", [&]() {
+            for (const auto& cur : out) {
+                allFound = (t.lower_bound(cur) == t.upper_bound(cur)) && allFound;
+            }
+        });
+        EXPECT_TRUE(allFound);
+    };
+
+    using t1 = Tuple<int, 1>;
+    using t2 = Tuple<int, 2>;
+    using t4 = Tuple<int, 4>;
+    using c1 = index_utils::comparator<0>;
+    using c2 = index_utils::comparator<1, 0>;
+    using c4 = index_utils::comparator<0, 1, 2, 3>;
+    bench(type_tag<btree_set<t1, c1, std::allocator<t1>, 256, detail::binary_search>>(), "arity 1 - binary");
+    bench(type_tag<btree_set<t1, c1, std::allocator<t1>, 256, detail::simd_search>>(), "arity 1 - simd");
+    bench(type_tag<btree_set<t2, c2, std::allocator<t2>, 256, detail::binary_search>>(), "arity 2 - binary");
+    bench(type_tag<btree_set<t2, c2, std::allocator<t2>, 256, detail::simd_search>>(), "arity 2 - simd");
+    bench(type_tag<btree_set<t4, c4, std::allocator<t4>, 256, detail::binary_search>>(), "arity 4 - binary");
+    bench(type_tag<btree_set<t4, c4, std::allocator<t4>, 256, detail::simd_search>>(), "arity 4 - simd");
+}
+
 TEST(BTreeSet, Parallel) {
     //        const int N = 600000000;
     //        const int N = 100000;
@@ -0,0 +1,390 @@
+/*
+ * Souffle - A Datalog Compiler
+ * Copyright (c) 2020, The Souffle Developers. All rights reserved
+ * Licensed under the Universal Permissive License v 1.0 as shown at:
+ * - https://opensource.org/licenses/UPL
+ * - <souffle root>/licenses/SOUFFLE-UPL.txt
+ */
+
+/************************************************************************
+ *
+ * @file dyn_btree_test.cpp
+ *
+ * A test case testing the B-trees of runtime arity and the interpreter
+ * indexes built on them.
+ *
+ ***********************************************************************/
+
+#include "DynBTree.h"
+#include "InterpreterIndex.h"
+#include "test.h"
+
+#include <chrono>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <numeric>
+#include <random>
+#include <set>
+#include <string>
+#include <vector>
+
+namespace souffle {
+
+namespace test {
+
+using tuple_set = std::set<std::vector<RamDomain>>;
+
+/** Random tuples of the given arity with components drawn from [0,range) */
+std::vector<std::vector<RamDomain>> generate(std::size_t arity, std::size_t count, RamDomain range) {
+    std::mt19937 generator(42);
+    std::uniform_int_distribution<RamDomain> dist(0, range - 1);
+    std::vector<std::vector<RamDomain>> res(count, std::vector<RamDomain>(arity));
+    for (auto& cur : res) {
+        for (auto& value : cur) {
+            value = dist(generator);
+        }
+    }
+    return res;
+}
+
+tuple_set contents(const DynBTree& tree) {
+    tuple_set res;
+    for (const RamDomain* cur : tree) {
+        res.emplace(cur, cur + tree.getArity());
+    }
+    return res;
+}
+
+TEST(DynBTree, Basic) {
+    DynBTree t(3);
+
+    EXPECT_TRUE(t.empty());
+    EXPECT_EQ(0, t.size());
+
+    RamDomain a[] = {1, 2, 3};
+    RamDomain b[] = {1, 2, 4};
+    EXPECT_FALSE(t.contains(a));
+
+    EXPECT_TRUE(t.insert(a));
+    EXPECT_FALSE(t.insert(a));
+    EXPECT_TRUE(t.contains(a));
+    EXPECT_FALSE(t.contains(b));
+    EXPECT_EQ(1, t.size());
+
+    EXPECT_TRUE(t.insert(b));
+    EXPECT_TRUE(t.contains(b));
+    EXPECT_EQ(2, t.size());
+
+    t.clear();
+    EXPECT_TRUE(t.empty());
+    EXPECT_FALSE(t.contains(a));
+    EXPECT_TRUE(t.begin() == t.end());
+}
+
+TEST(DynBTree, Order) {
+    for (std::size_t arity : {1, 5, 20, 40}) {
+        auto data = generate(arity, 5000, 10);
+        DynBTree t(arity);
+        tuple_set should;
+        for (const auto& cur : data) {
+            EXPECT_EQ(should.insert(cur).second, t.insert(cur.data()));
+        }
+        EXPECT_EQ(should.size(), t.size());
+
+        // iteration visits the tuples in order
+        auto pos = should.begin();
+        for (const RamDomain* cur : t) {
+            EXPECT_TRUE(std::equal(pos->begin(), pos->end(), cur));
+            ++pos;
+        }
+        EXPECT_TRUE(pos == should.end());
+
+        for (const auto& cur : generate(arity, 1000, 11)) {
+            EXPECT_EQ(should.count(cur), t.contains(cur.data()));
+        }
+    }
+}
+
+TEST(DynBTree, Bounds) {
+    const std::size_t arity = 15;
+    DynBTree t(arity);
+    tuple_set should;
+    for (const auto& cur : generate(arity, 2000, 4)) {
+        t.insert(cur.data());
+        should.insert(cur);
+    }
+
+    DynBTree::operation_hints hints;
+    for (const auto& cur : generate(arity, 500, 5)) {
+        auto lower = should.lower_bound(cur);
+        auto a = t.lower_bound(cur.data(), hints);
+        EXPECT_EQ(lower == should.end(), a == t.end());
+        if (a != t.end()) {
+            EXPECT_TRUE(std::equal(lower->begin(), lower->end(), *a));
+        }
+
+        auto upper = should.upper_bound(cur);
+        auto b = t.upper_bound(cur.data(), hints);
+        EXPECT_EQ(upper == should.end(), b == t.end());
+        if (b != t.end()) {
+            EXPECT_TRUE(std::equal(upper->begin(), upper->end(), *b));
+        }
+    }
+
+    // a search on a prefix, with the remaining components open
+    std::vector<RamDomain> low(arity, MIN_RAM_SIGNED);
+    std::vector<RamDomain> high(arity, MAX_RAM_SIGNED);
+    low[0] = high[0] = 2;
+    low[1] = high[1] = 1;
+    std::size_t count = 0;
+    for (auto it = t.lower_bound(low.data(), hints); it != t.upper_bound(high.data(), hints); ++it) {
+        EXPECT_EQ(2, (*it)[0]);
+        EXPECT_EQ(1, (*it)[1]);
+        count++;
+    }
+    EXPECT_EQ(static_cast<std::size_t>(std::distance(should.lower_bound(low), should.upper_bound(high))),
+            count);
+}
+
+TEST(DynBTree, InsertSorted) {
+    const std::size_t arity = 13;
+    auto data = generate(arity, 10000, 6);
+    tuple_set should(data.begin(), data.end());
+
+    std::vector<RamDomain> sorted;
+    for (const auto& cur : should) {
+        sorted.insert(sorted.end(), cur.begin(), cur.end());
+    }
+
+    DynBTree t(arity);
+    t.insertSorted(sorted.data(), should.size());
+    EXPECT_EQ(should.size(), t.size());
+    EXPECT_TRUE(should == contents(t));
+
+    // the bulk-loaded tree accepts further inserts
+    for (const auto& cur : generate(arity, 2000, 7)) {
+        EXPECT_EQ(should.insert(cur).second, t.insert(cur.data()));
+    }
+    EXPECT_EQ(should.size(), t.size());
+    EXPECT_TRUE(should == contents(t));
+}
+
+TEST(DynBTree, Payload) {
+    // tuples are identified by their first two components
+    DynBTree t(4, 2);
+
+    RamDomain a[] = {1, 2, 5, 5};
+    RamDomain larger[] = {1, 2, 6, 0};
+    RamDomain smaller[] = {1, 2, 4, 9};
+    RamDomain other[] = {1, 3, 6, 0};
+
+    EXPECT_TRUE(t.insert(a));
+    EXPECT_FALSE(t.insert(a));
+    EXPECT_FALSE(t.insert(larger));
+    EXPECT_TRUE(t.contains(a));
+    EXPECT_FALSE(t.contains(larger));
+
+    EXPECT_TRUE(t.insert(smaller));
+    EXPECT_EQ(1, t.size());
+    EXPECT_FALSE(t.contains(a));
+    EXPECT_TRUE(t.contains(smaller));
+
+    EXPECT_TRUE(t.insert(other));
+    EXPECT_EQ(2, t.size());
+}
+
+TEST(DynBTree, Chunks) {
+    const std::size_t arity = 16;
+    DynBTree t(arity);
+    EXPECT_TRUE(t.getChunks(10).empty());
+
+    tuple_set should;
+    for (const auto& cur : generate(arity, 5000, 8)) {
+        t.insert(cur.data());
+        should.insert(cur);
+    }
+
+    for (std::size_t num : {1, 3, 10, 100, 100000}) {
+        auto chunks = t.getChunks(num);
+        EXPECT_LT(0, chunks.size());
+        EXPECT_LT(chunks.size(), num + 1);
+
+        tuple_set is;
+        std::size_t count = 0;
+        for (const auto& chunk : chunks) {
+            EXPECT_FALSE(chunk.empty());
+            for (const RamDomain* cur : chunk) {
+                is.emplace(cur, cur + arity);
+                count++;
+            }
+        }
+        EXPECT_EQ(should.size(), count);
+        EXPECT_TRUE(should == is);
+    }
+}
+
+TEST(DynBTreeIndex, Wide) {
+    // a relation of arity 20, indexed on a permutation of its attributes
+    const std::size_t arity = 20;
+    std::vector<int> order(arity);
+    std::iota(order.rbegin(), order.rend(), 0);
+    auto index = createBTreeIndex(Order(order));
+    EXPECT_EQ(arity, index->getArity());
+
+    auto data = generate(arity, 3000, 5);
+    tuple_set should;
+    for (std::size_t i = 0; i < data.size() / 2; ++i) {
+        EXPECT_EQ(should.insert(data[i]).second, index->insert(TupleRef(data[i].data(), arity)));
+    }
+    std::vector<RamDomain> buffer;
+    for (std::size_t i = data.size() / 2; i < data.size(); ++i) {
+        should.insert(data[i]);
+        buffer.insert(buffer.end(), data[i].begin(), data[i].end());
+    }
+    index->insertAll(buffer.data(), data.size() - data.size() / 2);
+    EXPECT_EQ(should.size(), index->size());
+
+    tuple_set is;
+    for (const auto& cur : index->scan()) {
+        is.emplace(cur.getBase(), cur.getBase() + arity);
+        EXPECT_TRUE(index->contains(cur));
+    }
+    EXPECT_TRUE(should == is);
+
+    // the order leads with the last attribute
+    std::vector<RamDomain> low(arity, MIN_RAM_SIGNED);
+    std::vector<RamDomain> high(arity, MAX_RAM_SIGNED);
+    low[arity - 1] = high[arity - 1] = 3;
+    TupleRef a(low.data(), arity);
+    TupleRef b(high.data(), arity);
+    std::size_t count = 0;
+    for (const auto& cur : index->range(a, b)) {
+        EXPECT_EQ(3, cur[arity - 1]);
+        count++;
+    }
+    std::size_t expected = 0;
+    for (const auto& cur : should) {
+        expected += cur[arity - 1] == 3 ? 1 : 0;
+    }
+    EXPECT_EQ(expected, count);
+    EXPECT_TRUE(index->createView()->contains(a, b));
+
+    std::size_t partitioned = 0;
+    for (auto& stream : index->partitionRange(a, b, 4)) {
+        for (const auto& cur : stream) {
+            EXPECT_EQ(3, cur[arity - 1]);
+            partitioned++;
+        }
+    }
+    EXPECT_EQ(expected, partitioned);
+
+    partitioned = 0;
+    for (auto& stream : index->partitionScan(7)) {
+        for (const auto& cur : stream) {
+            EXPECT_TRUE(should.count(std::vector<RamDomain>(cur.getBase(), cur.getBase() + arity)) == 1);
+            partitioned++;
+        }
+    }
+    EXPECT_EQ(should.size(), partitioned);
+
+    index->clear();
+    EXPECT_TRUE(index->empty());
+}
+
+TEST(DynBTreeIndex, WideProvenance) {
+    // the last two attributes are the provenance annotations
+    const std::size_t arity = 16;
+    auto index = createBTreeProvenanceIndex(Order::create(arity));
+
+    std::vector<RamDomain> tuple(arity, 1);
+    tuple[arity - 2] = 5;
+    EXPECT_TRUE(index->insert(TupleRef(tuple.data(), arity)));
+    tuple[arity - 2] = 7;
+    EXPECT_FALSE(index->insert(TupleRef(tuple.data(), arity)));
+    tuple[arity - 2] = 3;
+    EXPECT_TRUE(index->insert(TupleRef(tuple.data(), arity)));
+    EXPECT_EQ(1, index->size());
+
+    for (const auto& cur : index->scan()) {
+        EXPECT_EQ(3, cur[arity - 2]);
+    }
+}
+
+// -- benchmark of the index variants --
+
+using time_point = std::chrono::high_resolution_clock::time_point;
+
+long time(const std::string& name, const std::function<void()>& operation) {
+    std::cout << "\t" << std::setw(30) << std::left << name << std::right << std::flush;
+    time_point a = std::chrono::high_resolution_clock::now();
+    operation();
+    time_point b = std::chrono::high_resolution_clock::now();
+    long res = std::chrono::duration_cast<std::chrono::milliseconds>(b - a).count();
+    std::cout << " done [" << std::setw(5) << res << "ms]\n";
+    return res;
+}
+
+/**
+ * Times inserts, membership tests, a scan and prefix searches of an index over random
+ * tuples; returns whether the index answered all of them correctly.
+ */
+bool checkPerformance(const std::string& name, IndexFactory factory, std::size_t arity) {
+    const std::size_t N = 200000;
+    auto data = generate(arity, N, 1000);
+
+    std::cout << name << " (arity " << arity << "):\n";
+    // declared after the data, which indirect indexes reference
+    auto index = factory(Order::create(arity));
+    bool ok = true;
+    time("inserting tuples", [&]() {
+        for (const auto& cur : data) {
+            index->insert(TupleRef(cur.data(), arity));
+        }
+    });
+    ok = ok && index->size() == N;
+
+    time("membership", [&]() {
+        auto view = index->createView();
+        for (const auto& cur : data) {
+            ok = view->contains(TupleRef(cur.data(), arity)) && ok;
+        }
+    });
+
+    time("full scan", [&]() {
+        std::size_t count = 0;
+        for (const auto& cur : index->scan()) {
+            count += cur[0] >= 0 ? 1 : 0;
+        }
+        ok = ok && count == N;
+    });
+
+    time("prefix searches", [&]() {
+        auto view = index->createView();
+        std::vector<RamDomain> low(arity, MIN_RAM_SIGNED);
+        std::vector<RamDomain> high(arity, MAX_RAM_SIGNED);
+        std::size_t count = 0;
+        for (const auto& cur : data) {
+            low[0] = high[0] = cur[0];
+            low[1] = high[1] = cur[1];
+            for (const auto& tuple : view->range(TupleRef(low.data(), arity), TupleRef(high.data(), arity))) {
+                count += tuple[0] == cur[0] ? 1 : 0;
+            }
+        }
+        ok = ok && count >= N;
+    });
+    return ok;
+}
+
+TEST(Performance, WideIndex) {
+    for (std::size_t arity : {4, 12}) {
+        EXPECT_TRUE(checkPerformance("templated B-tree", createBTreeIndex, arity));
+        EXPECT_TRUE(checkPerformance("runtime-arity B-tree", createDynBTreeIndex, arity));
+        EXPECT_TRUE(checkPerformance("indirect B-tree", createIndirectIndex, arity));
+    }
+    EXPECT_TRUE(checkPerformance("runtime-arity B-tree", createDynBTreeIndex, 24));
+    EXPECT_TRUE(checkPerformance("indirect B-tree", createIndirectIndex, 24));
+}
+
+}  // namespace test
+}  // end namespace souffle
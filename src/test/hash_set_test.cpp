@@ -0,0 +1,202 @@
+/*
+ * Souffle - A Datalog Compiler
+ * Copyright (c) 2020, The Souffle Developers. All rights reserved
+ * Licensed under the Universal Permissive License v 1.0 as shown at:
+ * - https://opensource.org/licenses/UPL
+ * - <souffle root>/licenses/SOUFFLE-UPL.txt
+ */
+
+/************************************************************************
+ *
+ * @file hash_set_test.cpp
+ *
+ * A test case testing the hash sets utilized by hash indexes.
+ *
+ ***********************************************************************/
+
+#include "CompiledIndexUtils.h"
+#include "CompiledTuple.h"
+#include "HashSet.h"
+#include "test.h"
+
+#include <algorithm>
+#include <random>
+#include <set>
+#include <vector>
+
+namespace souffle {
+
+namespace test {
+
+using t_tuple = Tuple<int, 2>;
+
+// a set of pairs keyed on the first component
+using key_set = hash_set<t_tuple, index_utils::hasher<0>, index_utils::comparator<0>>;
+
+// a set of pairs keyed on both components
+using full_set = hash_set<t_tuple, index_utils::hasher<0, 1>, index_utils::comparator<0, 1>>;
+
+TEST(HashSet, Basic) {
+    full_set t;
+
+    EXPECT_TRUE(t.empty());
+    EXPECT_EQ(0, t.size());
+    EXPECT_FALSE(t.contains({1, 2}));
+
+    EXPECT_TRUE(t.insert({1, 2}));
+    EXPECT_FALSE(t.empty());
+    EXPECT_EQ(1, t.size());
+    EXPECT_TRUE(t.contains({1, 2}));
+    EXPECT_FALSE(t.contains({2, 1}));
+
+    EXPECT_FALSE(t.insert({1, 2}));
+    EXPECT_EQ(1, t.size());
+
+    EXPECT_TRUE(t.insert({2, 1}));
+    EXPECT_EQ(2, t.size());
+    EXPECT_TRUE(t.contains({2, 1}));
+
+    t.clear();
+    EXPECT_TRUE(t.empty());
+    EXPECT_FALSE(t.contains({1, 2}));
+}
+
+TEST(HashSet, Growth) {
+    const int N = 10000;
+    full_set t;
+    for (int i = 0; i < N; i++) {
+        EXPECT_TRUE(t.insert({i, -i}));
+    }
+    EXPECT_EQ(N, t.size());
+    EXPECT_LT(2 * N - 1, t.capacity());
+
+    for (int i = 0; i < N; i++) {
+        EXPECT_TRUE(t.contains({i, -i}));
+        EXPECT_FALSE(t.contains({i, i + 1}));
+    }
+
+    std::set<t_tuple> is(t.begin(), t.end());
+    EXPECT_EQ(N, is.size());
+}
+
+TEST(HashSet, EqualRange) {
+    key_set t;
+    for (int i = 0; i < 100; i++) {
+        for (int j = 0; j < i % 7; j++) {
+            t.insert({i, j});
+        }
+    }
+
+    for (int i = 0; i < 100; i++) {
+        std::set<int> is;
+        for (const auto& cur : t.equal_range({i, 0})) {
+            EXPECT_EQ(i, cur[0]);
+            is.insert(cur[1]);
+        }
+        EXPECT_EQ(static_cast<size_t>(i % 7), is.size());
+        EXPECT_EQ(i % 7 != 0, t.contains({i, 0}));
+        EXPECT_FALSE(t.contains({i, 7}));
+    }
+
+    EXPECT_TRUE(t.equal_range({100, 0}).empty());
+}
+
+TEST(HashSet, Find) {
+    key_set t;
+    t.insert({1, 1});
+    t.insert({1, 2});
+    t.insert({2, 1});
+
+    auto pos = t.find({1, 2});
+    EXPECT_TRUE(pos != t.end());
+    EXPECT_EQ(1, (*pos)[0]);
+    EXPECT_EQ(2, (*pos)[1]);
+
+    EXPECT_TRUE(t.find({1, 3}) == t.end());
+    EXPECT_TRUE(t.find({3, 1}) == t.end());
+}
+
+TEST(HashSet, Reserve) {
+    full_set t;
+    t.reserve(1000);
+    auto capacity = t.capacity();
+    EXPECT_LT(1999, capacity);
+
+    for (int i = 0; i < 1000; i++) {
+        t.insert({i, i});
+    }
+    EXPECT_EQ(capacity, t.capacity());
+    EXPECT_EQ(1000, t.size());
+}
+
+TEST(HashSet, ChunkSplit) {
+    full_set t;
+
+    EXPECT_TRUE(t.getChunks(10).empty());
+
+    for (int i = 0; i < 1000; i++) {
+        t.insert({i, 0});
+    }
+
+    for (size_t num : {1, 3, 10, 100, 10000}) {
+        auto chunks = t.getChunks(num);
+        EXPECT_LT(0, chunks.size());
+        EXPECT_LT(chunks.size(), num + 1);
+
+        std::vector<t_tuple> is;
+        for (const auto& cur : chunks) {
+            EXPECT_FALSE(cur.empty());
+            for (const auto& tuple : cur) {
+                is.push_back(tuple);
+            }
+        }
+        std::sort(is.begin(), is.end());
+        EXPECT_EQ(1000, is.size());
+        EXPECT_TRUE(std::unique(is.begin(), is.end()) == is.end());
+    }
+}
+
+TEST(HashSet, Parallel) {
+    const int N = 10000;
+
+    // the number of times duplicates show up in the input set
+    for (int dup = 1; dup < 4; dup++) {
+        std::vector<t_tuple> full;
+        for (int i = 0; i < dup; i++) {
+            for (int j = 0; j < N; j++) {
+                full.push_back({j % 100, j});
+            }
+        }
+
+        // shuffle data
+        std::random_device rd;
+        std::mt19937 generator(rd());
+        std::shuffle(full.begin(), full.end(), generator);
+
+        // now insert all those values into a new set - in parallel
+        key_set res;
+#pragma omp parallel for
+        for (size_t i = 0; i < full.size(); ++i) {
+            res.insert(full[i]);
+        }
+
+        EXPECT_EQ(N, res.size());
+
+        std::set<t_tuple> should(full.begin(), full.end());
+        std::set<t_tuple> is(res.begin(), res.end());
+        EXPECT_EQ(N, is.size());
+        EXPECT_TRUE(should == is);
+
+        for (int j = 0; j < 100; j++) {
+            size_t count = 0;
+            for (const auto& cur : res.equal_range({j, 0})) {
+                EXPECT_EQ(j, cur[0]);
+                count++;
+            }
+            EXPECT_EQ(N / 100, count);
+        }
+    }
+}
+
+}  // namespace test
+}  // end namespace souffle
@@ -14,6 +14,7 @@
  *
  ***********************************************************************/
 
+#include "InterpreterContext.h"
 #include "InterpreterProgInterface.h"
 #include "InterpreterRelation.h"
 #include "SouffleInterface.h"
@@ -161,4 +162,129 @@ TEST(IndependentCopying, Iteration) {
     EXPECT_EQ(1, (*it)[0]);
 }
 
+TEST(BulkInsert, Construction) {
+    // create a binary relation with a secondary index
+    MinIndexSelection order{};
+    order.addSearch(1);
+    order.addSearch(2);
+    order.solve();
+    InterpreterRelation rel(2, 0, "test", {"i", "i"}, order);
+
+    // unsorted input containing a duplicate
+    RamDomain tuples[] = {3, 1, 1, 2, 2, 3, 1, 2};
+    rel.insertAll(tuples, 4);
+    EXPECT_EQ(3, rel.size());
+    RamDomain t[] = {2, 3};
+    EXPECT_TRUE(rel.contains(TupleRef(t, 2)));
+
+    // bulk insert into a non-empty relation
+    RamDomain more[] = {1, 2, 4, 4};
+    rel.insertAll(more, 2);
+    EXPECT_EQ(4, rel.size());
+
+    // every index holds all tuples exactly once
+    for (std::size_t indexPos = 0; indexPos < 2; ++indexPos) {
+        RamDomain low[] = {MIN_RAM_SIGNED, MIN_RAM_SIGNED};
+        RamDomain high[] = {MAX_RAM_SIGNED, MAX_RAM_SIGNED};
+        std::size_t count = 0;
+        for (const auto& cur : rel.range(indexPos, TupleRef(low, 2), TupleRef(high, 2))) {
+            EXPECT_TRUE(rel.contains(cur));
+            ++count;
+        }
+        EXPECT_EQ(4, count);
+    }
+}
+
+TEST(Cursor, Chunks) {
+    // create a binary relation with an index on the second attribute
+    MinIndexSelection order{};
+    order.addSearch(1);
+    order.addSearch(2);
+    order.solve();
+    InterpreterRelation rel(2, 0, "test", {"i", "i"}, order);
+
+    std::vector<RamDomain> tuples;
+    for (RamDomain i = 0; i < 1000; ++i) {
+        tuples.push_back(i);
+        tuples.push_back(i % 10);
+    }
+    rel.insertAll(tuples.data(), 1000);
+
+    // page through all tuples
+    InterpreterCursor all(rel);
+    std::vector<RamDomain> buffer;
+    std::size_t total = 0;
+    for (std::size_t count = all.next(buffer, 300); count != 0; count = all.next(buffer, 300)) {
+        EXPECT_TRUE(count <= 300);
+        total += count;
+    }
+    EXPECT_EQ(1000, total);
+    EXPECT_EQ(2000, buffer.size());
+
+    // bound attributes, with and without a covering index
+    for (std::size_t attribute = 0; attribute < 2; ++attribute) {
+        InterpreterCursor bound(rel, {{attribute, 7}});
+        buffer.clear();
+        while (bound.next(buffer, 3) != 0) {
+        }
+        EXPECT_EQ(attribute == 0 ? 2 : 200, buffer.size());
+        for (std::size_t i = 0; i < buffer.size(); i += 2) {
+            EXPECT_EQ(7, buffer[i + attribute]);
+        }
+    }
+
+    // no index starts with the second attribute; the cursor filters a full scan
+    MinIndexSelection single{};
+    single.addSearch(1);
+    single.solve();
+    InterpreterRelation scanned(2, 0, "test", {"i", "i"}, single);
+    scanned.insertAll(tuples.data(), 1000);
+    EXPECT_EQ(-1, scanned.findPrefixIndex(2));
+    InterpreterCursor filtered(scanned, {{1, 7}});
+    buffer.clear();
+    while (filtered.next(buffer, 64) != 0) {
+    }
+    EXPECT_EQ(200, buffer.size());
+}
+
+TEST(InterpreterContext, Arena) {
+    InterpreterContext ctxt(2, 0);
+
+    // tuples of a query are distinct, also across blocks of the arena
+    std::vector<RamDomain*> tuples;
+    for (RamDomain i = 0; i < 1000; ++i) {
+        RamDomain* tuple = ctxt.allocateNewTuple(3);
+        tuple[0] = i;
+        tuple[1] = i + 1;
+        tuple[2] = i + 2;
+        tuples.push_back(tuple);
+    }
+    for (RamDomain i = 0; i < 1000; ++i) {
+        EXPECT_EQ(i, tuples[i][0]);
+        EXPECT_EQ(i + 2, tuples[i][2]);
+    }
+
+    // the memory is reused once the arena is reset
+    ctxt.resetArena();
+    EXPECT_EQ(tuples[0], ctxt.allocateNewTuple(3));
+
+    // tuples larger than a block get a block of their own
+    RamDomain* large = ctxt.allocateNewTuple(10000);
+    large[9999] = 42;
+    EXPECT_EQ(42, large[9999]);
+}
+
+TEST(InterpreterContext, ThreadContexts) {
+    InterpreterContext ctxt(3, 2);
+    ctxt.reserveThreadContexts(2);
+
+    // thread contexts are reused and have the tuple slots of their parent
+    InterpreterContext& first = ctxt.getThreadContext(1);
+    RamDomain tuple[1] = {7};
+    first[2] = tuple;
+    EXPECT_EQ(&first, &ctxt.getThreadContext(1));
+    EXPECT_NE(&first, &ctxt.getThreadContext(0));
+    EXPECT_EQ(7, ctxt.getThreadContext(1)[2][0]);
+}
+
 }  // end namespace test
@@ -15,7 +15,14 @@
  ***********************************************************************/
 
 #include "ParallelUtils.h"
+#include "WorkStealing.h"
 #include "test.h"
+#include <atomic>
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <thread>
 
 namespace souffle {
 
@@ -91,5 +98,86 @@ TEST(ParallelUtils, OptimisticReadWriteLock) {
 
     EXPECT_EQ(2 * (N / K), c);
 }
+
+TEST(WorkStealing, PartitionCount) {
+    EXPECT_EQ(4u, getPartitionCount(0, 4));
+    EXPECT_EQ(4u, getPartitionCount(1000, 4));
+    EXPECT_EQ(10u, getPartitionCount(10 * MIN_PARTITION_SIZE, 4));
+    EXPECT_EQ(4 * PARTITIONS_PER_THREAD, getPartitionCount(1000000, 4));
+}
+
+TEST(WorkStealing, EachPartitionOnce) {
+    const std::size_t N = 10000;
+
+    WorkStealingLoop loop(N, 4);
+    std::unique_ptr<std::atomic<int>[]> claims(new std::atomic<int>[N]);
+    for (std::size_t i = 0; i < N; i++) {
+        claims[i] = 0;
+    }
+
+#pragma omp parallel num_threads(4)
+    {
+        std::size_t partition;
+        while (loop.next(partition)) {
+            claims[partition]++;
+        }
+    }
+
+    for (std::size_t i = 0; i < N; i++) {
+        EXPECT_EQ(1, claims[i]);
+    }
+}
+
+TEST(WorkStealing, Steal) {
+    // a single thread exhausts its own range and then takes over the ranges of the others
+    WorkStealingLoop loop(100, 4);
+    std::size_t partition;
+    std::size_t count = 0;
+    while (loop.next(partition)) {
+        count++;
+    }
+    EXPECT_EQ(100u, count);
+}
+
+TEST(Performance, WorkStealing) {
+    const std::size_t N = 1 << 14;
+    const std::size_t numThreads = 4;
+
+    // A scan whose first eighth of tuples is expensive, as behind a skewed subtree. The cost of
+    // a tuple is simulated by sleeping, so that the schedules compare the same on any number of cores.
+    auto process = [&](std::size_t begin, std::size_t end) {
+        std::size_t heavy = std::min(end, N / 8) - std::min(begin, N / 8);
+        std::this_thread::sleep_for(std::chrono::microseconds(10 * heavy));
+        return end - begin;
+    };
+
+    std::cout << "\tone partition per thread, dynamic schedule ... " << std::flush;
+    std::atomic<std::size_t> baselineTuples(0);
+    auto start = now();
+#pragma omp parallel for num_threads(numThreads) schedule(dynamic)
+    for (std::size_t i = 0; i < numThreads; ++i) {
+        baselineTuples += process(N * i / numThreads, N * (i + 1) / numThreads);
+    }
+    auto end = now();
+    std::cout << " done [" << std::setw(5) << duration_in_us(start, end) / 1000 << "ms]\n";
+
+    std::cout << "\tadaptive partitions, work stealing ... " << std::flush;
+    const std::size_t count = getPartitionCount(N, numThreads);
+    WorkStealingLoop loop(count, numThreads);
+    std::atomic<std::size_t> stealingTuples(0);
+    start = now();
+#pragma omp parallel num_threads(numThreads)
+    {
+        std::size_t partition;
+        while (loop.next(partition)) {
+            stealingTuples += process(N * partition / count, N * (partition + 1) / count);
+        }
+    }
+    end = now();
+    std::cout << " done [" << std::setw(5) << duration_in_us(start, end) / 1000 << "ms]\n";
+
+    EXPECT_EQ(N, baselineTuples.load());
+    EXPECT_EQ(N, stealingTuples.load());
+}
 }  // namespace test
 }  // end namespace souffle
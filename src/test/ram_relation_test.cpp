@@ -16,22 +16,39 @@
 
 #include "DebugReport.h"
 #include "ErrorReport.h"
+#include "EvaluationBudget.h"
 #include "InterpreterEngine.h"
+#include "InterpreterJit.h"
+#include "ProfileDatabase.h"
+#include "ProfileEvent.h"
 #include "RamExpression.h"
+#include "RamIndexAnalysis.h"
 #include "RamOperation.h"
 #include "RamProgram.h"
 #include "RamRelation.h"
 #include "RamStatement.h"
 #include "RamTranslationUnit.h"
+#include "RamVisitor.h"
 #include "SymbolTable.h"
+#include "Util.h"
 #include "json11.h"
 #include "test.h"
 
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <cstdio>
 #include <fstream>
+#include <iomanip>
+#include <limits>
 #include <map>
+#include <numeric>
 #include <random>
+#include <set>
 #include <sstream>
 #include <string>
+#include <thread>
+#include <unordered_map>
 #include <vector>
 
 namespace souffle::test {
@@ -637,4 +654,1054 @@ meow	-3	3	0.3
     std::cin.rdbuf(backupCin);
 }
 
+// A program of the given relations and statements, with the trees of the interpreter generated
+struct InterpreterFixture {
+    InterpreterFixture(std::vector<std::unique_ptr<RamRelation>> rels, std::unique_ptr<RamStatement> main,
+            std::map<std::string, std::unique_ptr<RamStatement>> subs = {})
+            : translationUnit(std::make_unique<RamProgram>(std::move(rels), std::move(main), std::move(subs)),
+                      symTab, errReport, debugReport),
+              interpreter(translationUnit) {
+        interpreter.generateMain();
+    }
+
+    SymbolTable symTab;
+    ErrorReport errReport;
+    DebugReport debugReport;
+    RamTranslationUnit translationUnit;
+    InterpreterEngine interpreter;
+};
+
+TEST(Interpreter, BatchExecution) {
+    Global::config().set("jobs", "4");
+
+    // B(x + 1) :- A(x).   C($) :- A(x).
+    std::vector<std::unique_ptr<RamRelation>> rels;
+    std::unique_ptr<RamRelation> relA =
+            std::make_unique<RamRelation>("A", 1, 0, std::vector<std::string>{"x"},
+                    std::vector<std::string>{"i"}, RelationRepresentation::BTREE);
+    std::unique_ptr<RamRelation> relB =
+            std::make_unique<RamRelation>("B", 1, 0, std::vector<std::string>{"x"},
+                    std::vector<std::string>{"i"}, RelationRepresentation::BTREE);
+    std::unique_ptr<RamRelation> relC =
+            std::make_unique<RamRelation>("C", 1, 0, std::vector<std::string>{"x"},
+                    std::vector<std::string>{"i"}, RelationRepresentation::BTREE);
+
+    std::vector<std::unique_ptr<RamExpression>> args;
+    args.push_back(std::make_unique<RamTupleElement>(0, 0));
+    args.push_back(std::make_unique<RamSignedConstant>(1));
+    std::vector<std::unique_ptr<RamExpression>> exprs;
+    exprs.push_back(std::make_unique<RamIntrinsicOperator>(FunctorOp::ADD, std::move(args)));
+    std::vector<std::unique_ptr<RamExpression>> counter;
+    counter.push_back(std::make_unique<RamAutoIncrement>());
+
+    std::unique_ptr<RamStatement> main = std::make_unique<RamSequence>(
+            std::make_unique<RamQuery>(std::make_unique<RamScan>(
+                    std::make_unique<RamRelationReference>(relA.get()), 0,
+                    std::make_unique<RamProject>(
+                            std::make_unique<RamRelationReference>(relB.get()), std::move(exprs)))),
+            std::make_unique<RamQuery>(std::make_unique<RamScan>(
+                    std::make_unique<RamRelationReference>(relA.get()), 0,
+                    std::make_unique<RamProject>(
+                            std::make_unique<RamRelationReference>(relC.get()), std::move(counter)))));
+
+    rels.push_back(std::move(relA));
+    rels.push_back(std::move(relB));
+    rels.push_back(std::move(relC));
+    InterpreterFixture fixture(std::move(rels), std::move(main));
+    InterpreterEngine& interpreter = fixture.interpreter;
+
+    // environment i holds the facts A(i), A(i + 100), ...
+    const size_t numEnvs = 32;
+    std::vector<std::unique_ptr<InterpreterEnvironment>> envs;
+    std::vector<InterpreterEnvironment*> batch;
+    for (size_t i = 0; i < numEnvs; ++i) {
+        envs.push_back(interpreter.createEnvironment());
+        std::vector<RamDomain> tuples;
+        for (size_t j = 0; j < i; ++j) {
+            tuples.push_back(j * 100 + i);
+        }
+        envs.back()->getRelation("A")->insertAll(tuples.data(), tuples.size());
+        batch.push_back(envs.back().get());
+    }
+
+    interpreter.executeBatch(batch);
+
+    for (size_t i = 0; i < numEnvs; ++i) {
+        std::vector<std::vector<RamDomain>> columns = InterpreterEngine::getColumns(*envs[i], "B");
+        EXPECT_EQ(columns[0].size(), i);
+        for (RamDomain x : columns[0]) {
+            EXPECT_EQ((x - 1) % 100, static_cast<RamDomain>(i));
+        }
+        // each environment counts from zero, regardless of the other environments
+        std::vector<RamDomain> counted(i);
+        std::iota(counted.begin(), counted.end(), 0);
+        EXPECT_EQ(InterpreterEngine::getColumns(*envs[i], "C")[0], counted);
+    }
+
+    // environments start counting from zero again once they are reset
+    envs[3]->reset();
+    std::vector<RamDomain> tuples = {7, 8};
+    envs[3]->getRelation("A")->insertAll(tuples.data(), tuples.size());
+    interpreter.executeBatch({envs[3].get()});
+    EXPECT_EQ(InterpreterEngine::getColumns(*envs[3], "C")[0], (std::vector<RamDomain>{0, 1}));
+
+    // the environment of the main program is not touched
+    EXPECT_EQ(interpreter.getRelation("B")->size(), 0);
+}
+
+TEST(Interpreter, ParallelStatement) {
+    Global::config().set("jobs", "4");
+
+    // B(x) :- A(x).  C(x) :- A(x).  D(x) :- A(x).  evaluated by one parallel statement
+    std::vector<std::unique_ptr<RamRelation>> rels;
+    for (const char* name : {"A", "B", "C", "D"}) {
+        rels.push_back(std::make_unique<RamRelation>(name, 1, 0, std::vector<std::string>{"x"},
+                std::vector<std::string>{"i"}, RelationRepresentation::BTREE));
+    }
+
+    std::vector<std::unique_ptr<RamStatement>> stmts;
+    for (size_t i = 1; i < rels.size(); ++i) {
+        std::vector<std::unique_ptr<RamExpression>> exprs;
+        exprs.push_back(std::make_unique<RamTupleElement>(0, 0));
+        stmts.push_back(std::make_unique<RamQuery>(
+                std::make_unique<RamScan>(std::make_unique<RamRelationReference>(rels[0].get()), 0,
+                        std::make_unique<RamProject>(
+                                std::make_unique<RamRelationReference>(rels[i].get()), std::move(exprs)))));
+    }
+    std::unique_ptr<RamStatement> main =
+            std::make_unique<RamSequence>(std::make_unique<RamParallel>(std::move(stmts)));
+
+    InterpreterFixture fixture(std::move(rels), std::move(main));
+    InterpreterEngine& interpreter = fixture.interpreter;
+
+    std::vector<RamDomain> tuples;
+    for (RamDomain i = 0; i < 1000; ++i) {
+        tuples.push_back(i);
+    }
+    interpreter.getRelation("A")->insertAll(tuples.data(), tuples.size());
+    interpreter.executeMain();
+
+    for (const char* name : {"B", "C", "D"}) {
+        EXPECT_EQ(interpreter.getRelation(name)->size(), 1000);
+    }
+}
+
+TEST(Interpreter, ConcurrentSubroutine) {
+    Global::config().set("jobs", "1");
+
+    // subroutine lookup(y): return x for each A(x) with x = y
+    std::vector<std::unique_ptr<RamRelation>> rels;
+    std::unique_ptr<RamRelation> relA =
+            std::make_unique<RamRelation>("A", 1, 0, std::vector<std::string>{"x"},
+                    std::vector<std::string>{"i"}, RelationRepresentation::BTREE);
+
+    std::vector<std::unique_ptr<RamExpression>> values;
+    values.push_back(std::make_unique<RamTupleElement>(0, 0));
+    std::map<std::string, std::unique_ptr<RamStatement>> subs;
+    subs["lookup"] = std::make_unique<RamQuery>(std::make_unique<RamScan>(
+            std::make_unique<RamRelationReference>(relA.get()), 0,
+            std::make_unique<RamFilter>(
+                    std::make_unique<RamConstraint>(BinaryConstraintOp::EQ,
+                            std::make_unique<RamTupleElement>(0, 0),
+                            std::make_unique<RamSubroutineArgument>(0)),
+                    std::make_unique<RamSubroutineReturnValue>(std::move(values)))));
+
+    rels.push_back(std::move(relA));
+    std::unique_ptr<RamStatement> main = std::make_unique<RamSequence>();
+    InterpreterFixture fixture(std::move(rels), std::move(main), std::move(subs));
+    InterpreterEngine& interpreter = fixture.interpreter;
+
+    std::vector<RamDomain> tuples;
+    for (RamDomain i = 0; i < 100; ++i) {
+        tuples.push_back(i);
+    }
+    interpreter.getRelation("A")->insertAll(tuples.data(), tuples.size());
+
+    // each thread looks up every value; the tree of the subroutine is generated once
+    const size_t numThreads = 8;
+    std::vector<std::vector<RamDomain>> results(numThreads);
+    std::vector<std::thread> threads;
+    for (size_t t = 0; t < numThreads; ++t) {
+        threads.emplace_back([&, t]() {
+            for (RamDomain i = 0; i < 200; ++i) {
+                std::vector<RamDomain> ret;
+                interpreter.executeSubroutine("lookup", {i}, ret);
+                results[t].insert(results[t].end(), ret.begin(), ret.end());
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+
+    for (const auto& result : results) {
+        EXPECT_EQ(result, tuples);
+    }
+}
+
+TEST(Interpreter, InsertBuffers) {
+    Global::config().set("jobs", "4");
+    Global::config().set("insert-buffers");
+
+    // B(x) :- A(x).  C(x % 100) :- A(x).  evaluated by parallel scans deferring their inserts
+    std::vector<std::unique_ptr<RamRelation>> rels;
+    for (const char* name : {"A", "B", "C"}) {
+        rels.push_back(std::make_unique<RamRelation>(name, 1, 0, std::vector<std::string>{"x"},
+                std::vector<std::string>{"i"}, RelationRepresentation::BTREE));
+    }
+
+    std::vector<std::unique_ptr<RamExpression>> identity;
+    identity.push_back(std::make_unique<RamTupleElement>(0, 0));
+    std::vector<std::unique_ptr<RamExpression>> args;
+    args.push_back(std::make_unique<RamTupleElement>(0, 0));
+    args.push_back(std::make_unique<RamSignedConstant>(100));
+    std::vector<std::unique_ptr<RamExpression>> modulo;
+    modulo.push_back(std::make_unique<RamIntrinsicOperator>(FunctorOp::MOD, std::move(args)));
+
+    std::unique_ptr<RamStatement> main = std::make_unique<RamSequence>(
+            std::make_unique<RamQuery>(std::make_unique<RamParallelScan>(
+                    std::make_unique<RamRelationReference>(rels[0].get()), 0,
+                    std::make_unique<RamProject>(
+                            std::make_unique<RamRelationReference>(rels[1].get()), std::move(identity)),
+                    "")),
+            std::make_unique<RamQuery>(std::make_unique<RamParallelScan>(
+                    std::make_unique<RamRelationReference>(rels[0].get()), 0,
+                    std::make_unique<RamProject>(
+                            std::make_unique<RamRelationReference>(rels[2].get()), std::move(modulo)),
+                    "")));
+
+    InterpreterFixture fixture(std::move(rels), std::move(main));
+    InterpreterEngine& interpreter = fixture.interpreter;
+    Global::config().unset("insert-buffers");
+
+    std::vector<RamDomain> tuples;
+    for (RamDomain i = 0; i < 10000; ++i) {
+        tuples.push_back(i);
+    }
+    interpreter.getRelation("A")->insertAll(tuples.data(), tuples.size());
+    interpreter.executeMain();
+
+    EXPECT_EQ(interpreter.getColumns("B")[0], tuples);
+    std::vector<RamDomain> remainders(tuples.begin(), tuples.begin() + 100);
+    EXPECT_EQ(interpreter.getColumns("C")[0], remainders);
+}
+
+TEST(Interpreter, ParallelAggregate) {
+    Global::config().set("jobs", "4");
+
+    // aggregates over A(x, y), large enough to be partitioned among the threads
+    std::vector<std::unique_ptr<RamRelation>> rels;
+    rels.push_back(std::make_unique<RamRelation>("A", 2, 0, std::vector<std::string>{"x", "y"},
+            std::vector<std::string>{"i", "i"}, RelationRepresentation::BTREE));
+    for (const char* name : {"count", "sum", "min", "max"}) {
+        rels.push_back(std::make_unique<RamRelation>(name, 1, 0, std::vector<std::string>{"x"},
+                std::vector<std::string>{"i"}, RelationRepresentation::BTREE));
+    }
+    const RamRelation* relA = rels[0].get();
+
+    auto project = [&](size_t i) {
+        std::vector<std::unique_ptr<RamExpression>> exprs;
+        exprs.push_back(std::make_unique<RamTupleElement>(0, 0));
+        return std::make_unique<RamProject>(
+                std::make_unique<RamRelationReference>(rels[i].get()), std::move(exprs));
+    };
+    auto atLeastTen = [&]() {
+        return std::make_unique<RamConstraint>(BinaryConstraintOp::GE,
+                std::make_unique<RamTupleElement>(0, 0), std::make_unique<RamSignedConstant>(10));
+    };
+
+    std::vector<std::unique_ptr<RamStatement>> stmts;
+    // count(x >= 10), sum(y)
+    stmts.push_back(std::make_unique<RamQuery>(std::make_unique<RamAggregate>(project(1), AggregateOp::COUNT,
+            std::make_unique<RamRelationReference>(relA), std::make_unique<RamUndefValue>(), atLeastTen(),
+            0)));
+    stmts.push_back(std::make_unique<RamQuery>(std::make_unique<RamAggregate>(project(2), AggregateOp::SUM,
+            std::make_unique<RamRelationReference>(relA), std::make_unique<RamTupleElement>(0, 1),
+            std::make_unique<RamTrue>(), 0)));
+    // min(x >= 10), max(x) for y = 1
+    stmts.push_back(std::make_unique<RamQuery>(std::make_unique<RamAggregate>(project(3), AggregateOp::MIN,
+            std::make_unique<RamRelationReference>(relA), std::make_unique<RamTupleElement>(0, 0),
+            atLeastTen(), 0)));
+    std::vector<std::unique_ptr<RamExpression>> pattern;
+    pattern.push_back(std::make_unique<RamUndefValue>());
+    pattern.push_back(std::make_unique<RamSignedConstant>(1));
+    stmts.push_back(std::make_unique<RamQuery>(std::make_unique<RamIndexAggregate>(project(4),
+            AggregateOp::MAX, std::make_unique<RamRelationReference>(relA),
+            std::make_unique<RamTupleElement>(0, 0), std::make_unique<RamTrue>(), std::move(pattern), 0)));
+
+    std::unique_ptr<RamStatement> main = std::make_unique<RamSequence>(std::move(stmts));
+
+    InterpreterFixture fixture(std::move(rels), std::move(main));
+    InterpreterEngine& interpreter = fixture.interpreter;
+
+    const RamDomain size = 100000;
+    std::vector<RamDomain> tuples;
+    for (RamDomain i = 0; i < size; ++i) {
+        tuples.push_back(i);
+        tuples.push_back(i % 2);
+    }
+    interpreter.getRelation("A")->insertAll(tuples.data(), size);
+    interpreter.executeMain();
+
+    EXPECT_EQ(interpreter.getColumns("count")[0], std::vector<RamDomain>{size - 10});
+    EXPECT_EQ(interpreter.getColumns("sum")[0], std::vector<RamDomain>{size / 2});
+    EXPECT_EQ(interpreter.getColumns("min")[0], std::vector<RamDomain>{10});
+    EXPECT_EQ(interpreter.getColumns("max")[0], std::vector<RamDomain>{size - 1});
+}
+
+TEST(Interpreter, ProfileCounters) {
+    Global::config().set("jobs", "4");
+    const std::string profileLog = tempFile();
+    Global::config().set("profile", profileLog);
+
+    // B(x) :- A(x), C(x).  evaluated by a parallel scan counting its tuples and the reads of C
+    std::vector<std::unique_ptr<RamRelation>> rels;
+    for (const char* name : {"A", "B", "C"}) {
+        rels.push_back(std::make_unique<RamRelation>(name, 1, 0, std::vector<std::string>{"x"},
+                std::vector<std::string>{"i"}, RelationRepresentation::BTREE));
+    }
+    const RamRelation* relA = rels[0].get();
+    const RamRelation* relB = rels[1].get();
+    const RamRelation* relC = rels[2].get();
+
+    const std::string rule = "B(x) :- A(x), C(x).";
+    std::vector<std::unique_ptr<RamExpression>> pattern;
+    pattern.push_back(std::make_unique<RamTupleElement>(0, 0));
+    std::vector<std::unique_ptr<RamExpression>> values;
+    values.push_back(std::make_unique<RamTupleElement>(0, 0));
+
+    std::unique_ptr<RamStatement> main = std::make_unique<RamSequence>(
+            std::make_unique<RamQuery>(std::make_unique<RamParallelScan>(
+                    std::make_unique<RamRelationReference>(relA), 0,
+                    std::make_unique<RamFilter>(
+                            std::make_unique<RamExistenceCheck>(
+                                    std::make_unique<RamRelationReference>(relC), std::move(pattern)),
+                            std::make_unique<RamProject>(
+                                    std::make_unique<RamRelationReference>(relB), std::move(values))),
+                    "@frequency-atom;B;0;" + rule + ";A(x);" + rule + ";0")));
+
+    InterpreterFixture fixture(std::move(rels), std::move(main));
+    InterpreterEngine& interpreter = fixture.interpreter;
+
+    std::vector<RamDomain> tuples;
+    std::vector<RamDomain> even;
+    for (RamDomain i = 0; i < 10000; ++i) {
+        tuples.push_back(i);
+        if (i % 2 == 0) {
+            even.push_back(i);
+        }
+    }
+    interpreter.getRelation("A")->insertAll(tuples.data(), tuples.size());
+    interpreter.getRelation("C")->insertAll(even.data(), even.size());
+    interpreter.executeMain();
+    Global::config().unset("profile");
+    // the log would be written when the program exits; the counters are checked in the database instead
+    ProfileEventSingleton::instance().setOutputFile("");
+    std::remove(profileLog.c_str());
+
+    EXPECT_EQ(interpreter.getColumns("B")[0], even);
+
+    const profile::ProfileDatabase& db = ProfileEventSingleton::instance().getDB();
+    auto* frequency = dynamic_cast<profile::SizeEntry*>(db.lookupEntry({"program", "relation", "B",
+            "non-recursive-rule", rule, "atom-frequency", rule, "A(x)", "num-tuples"}));
+    ASSERT_TRUE(frequency != nullptr);
+    EXPECT_EQ(frequency->getSize(), tuples.size());
+    auto* reads = dynamic_cast<profile::SizeEntry*>(db.lookupEntry({"program", "relation", "C", "reads"}));
+    ASSERT_TRUE(reads != nullptr);
+    EXPECT_EQ(reads->getSize(), tuples.size());
+}
+
+TEST(Interpreter, BatchedFilter) {
+    Global::config().set("jobs", "4");
+
+    // B(x, y) :- A(x, y), x + 1 < y * 2, y != 7.   by a scan and a parallel scan
+    // C(x, y) :- D(x), A(x, y), y - x >= 3.        by an index scan for each tuple of D
+    std::vector<std::unique_ptr<RamRelation>> rels;
+    for (const char* name : {"A", "B", "P", "C"}) {
+        rels.push_back(std::make_unique<RamRelation>(name, 2, 0, std::vector<std::string>{"x", "y"},
+                std::vector<std::string>{"i", "i"}, RelationRepresentation::BTREE));
+    }
+    rels.push_back(std::make_unique<RamRelation>("D", 1, 0, std::vector<std::string>{"x"},
+            std::vector<std::string>{"i"}, RelationRepresentation::BTREE));
+    std::vector<const RamRelation*> rel;
+    for (const auto& cur : rels) {
+        rel.push_back(cur.get());
+    }
+
+    auto element = [](int tupleId, size_t i) { return std::make_unique<RamTupleElement>(tupleId, i); };
+    auto constant = [](RamDomain value) { return std::make_unique<RamSignedConstant>(value); };
+    auto binary = [](FunctorOp op, std::unique_ptr<RamExpression> lhs, std::unique_ptr<RamExpression> rhs) {
+        std::vector<std::unique_ptr<RamExpression>> args;
+        args.push_back(std::move(lhs));
+        args.push_back(std::move(rhs));
+        return std::make_unique<RamIntrinsicOperator>(op, std::move(args));
+    };
+    auto project = [&](const RamRelation* target, int tupleId) {
+        std::vector<std::unique_ptr<RamExpression>> values;
+        values.push_back(element(tupleId, 0));
+        values.push_back(element(tupleId, 1));
+        return std::make_unique<RamProject>(
+                std::make_unique<RamRelationReference>(target), std::move(values));
+    };
+    auto condition = [&]() {
+        return std::make_unique<RamConjunction>(
+                std::make_unique<RamConstraint>(BinaryConstraintOp::LT,
+                        binary(FunctorOp::ADD, element(0, 0), constant(1)),
+                        binary(FunctorOp::MUL, element(0, 1), constant(2))),
+                std::make_unique<RamConstraint>(BinaryConstraintOp::NE, element(0, 1), constant(7)));
+    };
+
+    std::vector<std::unique_ptr<RamExpression>> pattern;
+    pattern.push_back(element(0, 0));
+    pattern.push_back(std::make_unique<RamUndefValue>());
+
+    std::unique_ptr<RamStatement> main = std::make_unique<RamSequence>(
+            std::make_unique<RamQuery>(std::make_unique<RamScan>(
+                    std::make_unique<RamRelationReference>(rel[0]), 0,
+                    std::make_unique<RamFilter>(condition(), project(rel[1], 0)))),
+            std::make_unique<RamQuery>(std::make_unique<RamParallelScan>(
+                    std::make_unique<RamRelationReference>(rel[0]), 0,
+                    std::make_unique<RamFilter>(condition(), project(rel[2], 0)))),
+            std::make_unique<RamQuery>(std::make_unique<RamScan>(
+                    std::make_unique<RamRelationReference>(rel[4]), 0,
+                    std::make_unique<RamIndexScan>(std::make_unique<RamRelationReference>(rel[0]), 1,
+                            std::move(pattern),
+                            std::make_unique<RamFilter>(
+                                    std::make_unique<RamConstraint>(BinaryConstraintOp::GE,
+                                            binary(FunctorOp::SUB, element(1, 1), element(0, 0)),
+                                            constant(3)),
+                                    project(rel[3], 1))))));
+
+    InterpreterFixture fixture(std::move(rels), std::move(main));
+    InterpreterEngine& interpreter = fixture.interpreter;
+
+    std::vector<RamDomain> tuples;
+    std::vector<RamDomain> keys;
+    std::vector<std::vector<RamDomain>> filtered(2);
+    std::vector<std::vector<RamDomain>> joined(2);
+    for (RamDomain x = 0; x < 100; ++x) {
+        keys.push_back(x);
+        for (RamDomain y = 0; y < 100; ++y) {
+            tuples.push_back(x);
+            tuples.push_back(y);
+            if (x + 1 < y * 2 && y != 7) {
+                filtered[0].push_back(x);
+                filtered[1].push_back(y);
+            }
+            if (y - x >= 3) {
+                joined[0].push_back(x);
+                joined[1].push_back(y);
+            }
+        }
+    }
+    interpreter.getRelation("A")->insertAll(tuples.data(), tuples.size() / 2);
+    interpreter.getRelation("D")->insertAll(keys.data(), keys.size());
+    interpreter.executeMain();
+
+    EXPECT_EQ(interpreter.getColumns("B"), filtered);
+    EXPECT_EQ(interpreter.getColumns("P"), filtered);
+    EXPECT_EQ(interpreter.getColumns("C"), joined);
+}
+
+TEST(Interpreter, HashIndexes) {
+    Global::config().set("jobs", "4");
+
+    // C(x, y) :- D(x), A(x, y).      by an index scan binding the first attribute of A
+    // E(x, y) :- D(y), A(x, y).      by an index scan binding the second attribute of A
+    // F(x) :- D(x), A(_, x).         by an existence check binding the second attribute of A
+    // G(x, y) :- A(x, y), x = 5.     by a parallel index scan binding the first attribute of A
+    for (auto representation : {RelationRepresentation::DEFAULT, RelationRepresentation::BTREE,
+                 RelationRepresentation::HASHSET}) {
+        std::vector<std::unique_ptr<RamRelation>> rels;
+        for (const char* name : {"A", "C", "E", "G"}) {
+            rels.push_back(std::make_unique<RamRelation>(name, 2, 0, std::vector<std::string>{"x", "y"},
+                    std::vector<std::string>{"i", "i"}, representation));
+        }
+        for (const char* name : {"D", "F"}) {
+            rels.push_back(std::make_unique<RamRelation>(name, 1, 0, std::vector<std::string>{"x"},
+                    std::vector<std::string>{"i"}, representation));
+        }
+        std::vector<const RamRelation*> rel;
+        for (const auto& cur : rels) {
+            rel.push_back(cur.get());
+        }
+
+        auto element = [](int tupleId, size_t i) { return std::make_unique<RamTupleElement>(tupleId, i); };
+        auto ref = [&](size_t i) { return std::make_unique<RamRelationReference>(rel[i]); };
+        auto pattern = [](std::unique_ptr<RamExpression> x, std::unique_ptr<RamExpression> y) {
+            std::vector<std::unique_ptr<RamExpression>> res;
+            res.push_back(x ? std::move(x) : std::make_unique<RamUndefValue>());
+            res.push_back(y ? std::move(y) : std::make_unique<RamUndefValue>());
+            return res;
+        };
+        auto project = [](std::unique_ptr<RamRelationReference> target,
+                          std::vector<std::unique_ptr<RamExpression>> values) {
+            return std::make_unique<RamProject>(std::move(target), std::move(values));
+        };
+        std::vector<std::unique_ptr<RamExpression>> single;
+        single.push_back(element(0, 0));
+
+        std::unique_ptr<RamStatement> main = std::make_unique<RamSequence>(
+                std::make_unique<RamQuery>(std::make_unique<RamScan>(ref(4), 0,
+                        std::make_unique<RamIndexScan>(ref(0), 1, pattern(element(0, 0), nullptr),
+                                project(ref(1), pattern(element(1, 0), element(1, 1)))))),
+                std::make_unique<RamQuery>(std::make_unique<RamScan>(ref(4), 0,
+                        std::make_unique<RamIndexScan>(ref(0), 1, pattern(nullptr, element(0, 0)),
+                                project(ref(2), pattern(element(1, 0), element(1, 1)))))),
+                std::make_unique<RamQuery>(std::make_unique<RamScan>(ref(4), 0,
+                        std::make_unique<RamFilter>(std::make_unique<RamExistenceCheck>(
+                                                            ref(0), pattern(nullptr, element(0, 0))),
+                                project(ref(5), std::move(single))))),
+                std::make_unique<RamQuery>(std::make_unique<RamParallelIndexScan>(ref(0), 0,
+                        pattern(std::make_unique<RamSignedConstant>(5), nullptr),
+                        project(ref(3), pattern(element(0, 0), element(0, 1))))));
+
+        InterpreterFixture fixture(std::move(rels), std::move(main));
+        InterpreterEngine& interpreter = fixture.interpreter;
+
+        // A is searched by both of its attributes: only one search can share the order of the
+        // total search, the other one is hashed unless hash indexes are forced or forbidden
+        const MinIndexSelection& indexes =
+                fixture.translationUnit.getAnalysis<RamIndexAnalysis>()->getIndexes(*rel[0]);
+        size_t numHashIndexes = 0;
+        for (size_t i = 0; i < indexes.getAllOrders().size(); ++i) {
+            numHashIndexes += indexes.isHashIndex(i) ? 1 : 0;
+        }
+        switch (representation) {
+            case RelationRepresentation::DEFAULT:
+                EXPECT_EQ(2, indexes.getAllOrders().size());
+                EXPECT_EQ(1, numHashIndexes);
+                break;
+            case RelationRepresentation::HASHSET:
+                EXPECT_EQ(3, indexes.getAllOrders().size());
+                EXPECT_EQ(3, numHashIndexes);
+                break;
+            default:
+                EXPECT_EQ(0, numHashIndexes);
+        }
+
+        std::vector<RamDomain> tuples;
+        std::vector<RamDomain> keys;
+        std::set<std::vector<RamDomain>> expected[4];
+        for (RamDomain x = 0; x < 40; ++x) {
+            if (x % 3 == 0) {
+                keys.push_back(x);
+            }
+            for (RamDomain y = x % 7; y < 40; y += 7) {
+                tuples.push_back(x);
+                tuples.push_back(y);
+            }
+        }
+        for (size_t i = 0; i < tuples.size(); i += 2) {
+            RamDomain x = tuples[i];
+            RamDomain y = tuples[i + 1];
+            if (x % 3 == 0) {
+                expected[0].insert({x, y});
+            }
+            if (y % 3 == 0) {
+                expected[1].insert({x, y});
+                expected[2].insert({y});
+            }
+            if (x == 5) {
+                expected[3].insert({x, y});
+            }
+        }
+        interpreter.getRelation("A")->insertAll(tuples.data(), tuples.size() / 2);
+        interpreter.getRelation("D")->insertAll(keys.data(), keys.size());
+        interpreter.executeMain();
+
+        size_t pos = 0;
+        for (const char* name : {"C", "E", "F", "G"}) {
+            const InterpreterRelation* result = interpreter.getRelation(name);
+            std::set<std::vector<RamDomain>> derived;
+            for (const RamDomain* tuple : *result) {
+                derived.emplace(tuple, tuple + result->getArity());
+            }
+            EXPECT_EQ(expected[pos].size(), result->size());
+            EXPECT_TRUE(derived == expected[pos]) << name << " with representation " << representation;
+            ++pos;
+        }
+    }
+}
+
+TEST(Interpreter, WideRelation) {
+    // relations wider than the arities of the templated indexes
+    const size_t arity = 16;
+    std::vector<std::string> attributeNames;
+    std::vector<std::string> attributeTypes;
+    for (size_t i = 0; i < arity; ++i) {
+        attributeNames.push_back("x" + std::to_string(i));
+        attributeTypes.push_back("i");
+    }
+    std::vector<std::unique_ptr<RamRelation>> rels;
+    for (const char* name : {"A", "B", "C"}) {
+        rels.push_back(std::make_unique<RamRelation>(
+                name, arity, 0, attributeNames, attributeTypes, RelationRepresentation::DEFAULT));
+    }
+    const RamRelation* relA = rels[0].get();
+    const RamRelation* relB = rels[1].get();
+    const RamRelation* relC = rels[2].get();
+
+    // B(x0..x15) :- A(x0..x15), x0 = 3.     C(x0..x15) :- A(x0..x15), x1 = 4.
+    auto query = [&](const RamRelation* target, size_t column, RamDomain value) {
+        std::vector<std::unique_ptr<RamExpression>> pattern;
+        std::vector<std::unique_ptr<RamExpression>> values;
+        for (size_t i = 0; i < arity; ++i) {
+            if (i == column) {
+                pattern.push_back(std::make_unique<RamSignedConstant>(value));
+            } else {
+                pattern.push_back(std::make_unique<RamUndefValue>());
+            }
+            values.push_back(std::make_unique<RamTupleElement>(0, i));
+        }
+        return std::make_unique<RamQuery>(std::make_unique<RamIndexScan>(
+                std::make_unique<RamRelationReference>(relA), 0, std::move(pattern),
+                std::make_unique<RamProject>(
+                        std::make_unique<RamRelationReference>(target), std::move(values))));
+    };
+    std::unique_ptr<RamStatement> main = std::make_unique<RamSequence>(query(relB, 0, 3), query(relC, 1, 4));
+
+    InterpreterFixture fixture(std::move(rels), std::move(main));
+    InterpreterEngine& interpreter = fixture.interpreter;
+
+    std::vector<RamDomain> tuples;
+    size_t expectedB = 0;
+    size_t expectedC = 0;
+    for (RamDomain i = 0; i < 1000; ++i) {
+        for (size_t j = 0; j < arity; ++j) {
+            tuples.push_back((i + j) % (j + 5));
+        }
+        expectedB += (i % 5 == 3) ? 1 : 0;
+        expectedC += ((i + 1) % 6 == 4) ? 1 : 0;
+    }
+    interpreter.getRelation("A")->insertAll(tuples.data(), 1000);
+    interpreter.executeMain();
+
+    EXPECT_EQ(1000, interpreter.getRelation("A")->size());
+    EXPECT_EQ(expectedB, interpreter.getRelation("B")->size());
+    EXPECT_EQ(expectedC, interpreter.getRelation("C")->size());
+    for (const auto& cur : interpreter.getRelation("C")->scan()) {
+        EXPECT_EQ(4, cur[1]);
+    }
+}
+
+TEST(Interpreter, MergeRelations) {
+    std::vector<std::unique_ptr<RamRelation>> rels;
+    for (const char* name : {"A", "B", "C"}) {
+        rels.push_back(std::make_unique<RamRelation>(name, 2, 0, std::vector<std::string>{"x", "y"},
+                std::vector<std::string>{"i", "i"}, RelationRepresentation::DEFAULT));
+    }
+    const RamRelation* relA = rels[0].get();
+    const RamRelation* relB = rels[1].get();
+    const RamRelation* relC = rels[2].get();
+
+    // B(x, y) :- A(x, y).
+    auto merge = [&]() {
+        std::vector<std::unique_ptr<RamExpression>> values;
+        values.push_back(std::make_unique<RamTupleElement>(0, 0));
+        values.push_back(std::make_unique<RamTupleElement>(0, 1));
+        return std::make_unique<RamQuery>(
+                std::make_unique<RamScan>(std::make_unique<RamRelationReference>(relA), 0,
+                        std::make_unique<RamProject>(
+                                std::make_unique<RamRelationReference>(relB), std::move(values))));
+    };
+
+    // C(x, y) :- B(x, y), y = 7.   -- requires an index of B on y, which A lacks
+    std::vector<std::unique_ptr<RamExpression>> pattern;
+    pattern.push_back(std::make_unique<RamUndefValue>());
+    pattern.push_back(std::make_unique<RamSignedConstant>(7));
+    std::vector<std::unique_ptr<RamExpression>> values;
+    values.push_back(std::make_unique<RamTupleElement>(0, 0));
+    values.push_back(std::make_unique<RamTupleElement>(0, 1));
+    auto search = std::make_unique<RamQuery>(std::make_unique<RamIndexScan>(
+            std::make_unique<RamRelationReference>(relB), 0, std::move(pattern),
+            std::make_unique<RamProject>(std::make_unique<RamRelationReference>(relC), std::move(values))));
+
+    EXPECT_TRUE(merge()->getMergeSource() == relA);
+    EXPECT_TRUE(search->getMergeSource() == nullptr);
+
+    std::unique_ptr<RamStatement> main = std::make_unique<RamSequence>(merge(), merge(), std::move(search));
+    InterpreterFixture fixture(std::move(rels), std::move(main));
+    InterpreterEngine& interpreter = fixture.interpreter;
+
+    // A and B overlap on the multiples of 3
+    std::set<std::pair<RamDomain, RamDomain>> should;
+    std::vector<RamDomain> tuplesA;
+    std::vector<RamDomain> tuplesB;
+    for (RamDomain i = 0; i < 3000; ++i) {
+        if (i % 2 == 0 || i % 3 == 0) {
+            tuplesA.push_back(i);
+            tuplesA.push_back(i % 10);
+            should.insert({i, i % 10});
+        }
+        if (i % 3 == 0 || i % 5 == 0) {
+            tuplesB.push_back(i);
+            tuplesB.push_back(i % 10);
+            should.insert({i, i % 10});
+        }
+    }
+    interpreter.getRelation("A")->insertAll(tuplesA.data(), tuplesA.size() / 2);
+    interpreter.getRelation("B")->insertAll(tuplesB.data(), tuplesB.size() / 2);
+    interpreter.executeMain();
+
+    std::set<std::pair<RamDomain, RamDomain>> isB;
+    for (const auto& cur : interpreter.getRelation("B")->scan()) {
+        isB.insert({cur[0], cur[1]});
+    }
+    EXPECT_EQ(should.size(), interpreter.getRelation("B")->size());
+    EXPECT_TRUE(should == isB);
+
+    // the index of B on y covers the merged tuples as well
+    size_t expectedC = 0;
+    for (const auto& cur : should) {
+        expectedC += cur.second == 7 ? 1 : 0;
+    }
+    EXPECT_EQ(expectedC, interpreter.getRelation("C")->size());
+    for (const auto& cur : interpreter.getRelation("C")->scan()) {
+        EXPECT_EQ(7, cur[1]);
+        EXPECT_TRUE(should.count({cur[0], cur[1]}) == 1);
+    }
+}
+
+TEST(Interpreter, SortedRelation) {
+    std::vector<std::unique_ptr<RamRelation>> rels;
+    rels.push_back(std::make_unique<RamRelation>("E", 2, 0, std::vector<std::string>{"x", "y"},
+            std::vector<std::string>{"i", "i"}, RelationRepresentation::SORTED));
+    for (const char* name : {"A", "C"}) {
+        rels.push_back(std::make_unique<RamRelation>(name, 2, 0, std::vector<std::string>{"x", "y"},
+                std::vector<std::string>{"i", "i"}, RelationRepresentation::DEFAULT));
+    }
+    const RamRelation* relE = rels[0].get();
+    const RamRelation* relA = rels[1].get();
+    const RamRelation* relC = rels[2].get();
+
+    // A(x, y) :- E(x, y).
+    std::vector<std::unique_ptr<RamExpression>> copied;
+    copied.push_back(std::make_unique<RamTupleElement>(0, 0));
+    copied.push_back(std::make_unique<RamTupleElement>(0, 1));
+    auto copy = std::make_unique<RamQuery>(
+            std::make_unique<RamScan>(std::make_unique<RamRelationReference>(relE), 0,
+                    std::make_unique<RamProject>(
+                            std::make_unique<RamRelationReference>(relA), std::move(copied))));
+
+    // C(x, y) :- E(x, y), y = 7.   -- searches a second sorted array, ordered by y
+    std::vector<std::unique_ptr<RamExpression>> pattern;
+    pattern.push_back(std::make_unique<RamUndefValue>());
+    pattern.push_back(std::make_unique<RamSignedConstant>(7));
+    std::vector<std::unique_ptr<RamExpression>> values;
+    values.push_back(std::make_unique<RamTupleElement>(0, 0));
+    values.push_back(std::make_unique<RamTupleElement>(0, 1));
+    auto search = std::make_unique<RamQuery>(std::make_unique<RamIndexScan>(
+            std::make_unique<RamRelationReference>(relE), 0, std::move(pattern),
+            std::make_unique<RamProject>(std::make_unique<RamRelationReference>(relC), std::move(values))));
+
+    std::unique_ptr<RamStatement> main = std::make_unique<RamSequence>(std::move(copy), std::move(search));
+    InterpreterFixture fixture(std::move(rels), std::move(main));
+    InterpreterEngine& interpreter = fixture.interpreter;
+
+    // load E tuple by tuple, in reverse order and with duplicates
+    std::set<std::pair<RamDomain, RamDomain>> should;
+    for (RamDomain i = 5000; i-- > 0;) {
+        RamDomain tuple[2] = {i, (i * 7) % 13};
+        interpreter.getRelation("E")->insert(tuple);
+        interpreter.getRelation("E")->insert(tuple);
+        should.insert({tuple[0], tuple[1]});
+    }
+    interpreter.getRelation("E")->seal();
+    EXPECT_EQ(should.size(), interpreter.getRelation("E")->size());
+    interpreter.executeMain();
+
+    std::set<std::pair<RamDomain, RamDomain>> isA;
+    for (const auto& cur : interpreter.getRelation("A")->scan()) {
+        isA.insert({cur[0], cur[1]});
+    }
+    EXPECT_EQ(should.size(), interpreter.getRelation("A")->size());
+    EXPECT_TRUE(should == isA);
+
+    size_t expectedC = 0;
+    for (const auto& cur : should) {
+        expectedC += cur.second == 7 ? 1 : 0;
+    }
+    EXPECT_EQ(expectedC, interpreter.getRelation("C")->size());
+    for (const auto& cur : interpreter.getRelation("C")->scan()) {
+        EXPECT_EQ(7, cur[1]);
+        EXPECT_TRUE(should.count({cur[0], cur[1]}) == 1);
+    }
+}
+
+TEST(Interpreter, EvaluationBudget) {
+    Global::config().set("jobs", "1");
+
+    // B(x) :- A(x).   C(x) :- A(x).   and a loop which never ends: N'(x + 1) :- N(x), swapping N and N'.
+    std::vector<std::unique_ptr<RamRelation>> rels;
+    for (const char* name : {"A", "B", "C", "N", "@new_N"}) {
+        rels.push_back(std::make_unique<RamRelation>(name, 1, 0, std::vector<std::string>{"x"},
+                std::vector<std::string>{"i"}, RelationRepresentation::BTREE));
+    }
+    std::vector<const RamRelation*> rel;
+    for (const auto& cur : rels) {
+        rel.push_back(cur.get());
+    }
+
+    auto copy = [&](const RamRelation* source, const RamRelation* target, RamDomain offset) {
+        std::vector<std::unique_ptr<RamExpression>> args;
+        args.push_back(std::make_unique<RamTupleElement>(0, 0));
+        args.push_back(std::make_unique<RamSignedConstant>(offset));
+        std::vector<std::unique_ptr<RamExpression>> values;
+        values.push_back(std::make_unique<RamIntrinsicOperator>(FunctorOp::ADD, std::move(args)));
+        return std::make_unique<RamQuery>(std::make_unique<RamScan>(
+                std::make_unique<RamRelationReference>(source), 0,
+                std::make_unique<RamProject>(
+                        std::make_unique<RamRelationReference>(target), std::move(values))));
+    };
+
+    std::unique_ptr<RamStatement> main = std::make_unique<RamSequence>(copy(rel[0], rel[1], 0),
+            copy(rel[0], rel[2], 0),
+            std::make_unique<RamLoop>(std::make_unique<RamSequence>(copy(rel[3], rel[4], 1),
+                    std::make_unique<RamSwap>(std::make_unique<RamRelationReference>(rel[3]),
+                            std::make_unique<RamRelationReference>(rel[4])),
+                    std::make_unique<RamClear>(std::make_unique<RamRelationReference>(rel[4])))));
+
+    InterpreterFixture fixture(std::move(rels), std::move(main));
+    InterpreterEngine& interpreter = fixture.interpreter;
+    EvaluationBudget& budget = interpreter.getEnvironment().getBudget();
+
+    std::vector<RamDomain> tuples(10000);
+    std::iota(tuples.begin(), tuples.end(), 0);
+
+    // the first query exceeds the tuple limit; it stops early and the other rules are skipped
+    budget.setTupleLimit(100);
+    interpreter.getRelation("A")->insertAll(tuples.data(), tuples.size());
+    interpreter.executeMain();
+    EXPECT_EQ(budget.getStatus(), EvaluationBudget::Status::TupleLimit);
+    EXPECT_LT(interpreter.getRelation("B")->size(), tuples.size());
+    EXPECT_LT(99, interpreter.getRelation("B")->size());
+    EXPECT_EQ(interpreter.getRelation("C")->size(), 0);
+    EXPECT_EQ(interpreter.getRelation("A")->size(), tuples.size());
+
+    // the time limit ends the fixpoint, keeping the relations computed so far
+    interpreter.reset();
+    budget.setTupleLimit(0);
+    budget.setTimeLimit(std::chrono::milliseconds(50));
+    RamDomain zero = 0;
+    interpreter.getRelation("A")->insertAll(tuples.data(), tuples.size());
+    interpreter.getRelation("N")->insertAll(&zero, 1);
+    interpreter.executeMain();
+    EXPECT_EQ(budget.getStatus(), EvaluationBudget::Status::TimeLimit);
+    EXPECT_EQ(interpreter.getRelation("B")->size(), tuples.size());
+    EXPECT_EQ(interpreter.getRelation("C")->size(), tuples.size());
+    // the relations of N and N' trade places in each iteration
+    std::vector<RamDomain> last = interpreter.getColumns("N")[0];
+    std::vector<RamDomain> next = interpreter.getColumns("@new_N")[0];
+    last.insert(last.end(), next.begin(), next.end());
+    ASSERT_TRUE(last.size() == 1);
+    EXPECT_LT(0, last[0]);
+}
+
+// Evaluates the transitive closure of tests/evaluation/components semi-naively, as the translator
+// lowers it; compare builds with and without -DSOUFFLE_NO_COMPUTED_GOTO to measure the dispatch
+TEST(Performance, InterpreterDispatch) {
+    Global::config().set("jobs", "1");
+
+    // reachable(x, y) :- edge(x, y).
+    // reachable(x, z) :- reachable(x, y), edge(y, z).
+    std::vector<std::unique_ptr<RamRelation>> rels;
+    for (const char* name : {"edge", "reachable", "@delta_reachable", "@new_reachable"}) {
+        rels.push_back(std::make_unique<RamRelation>(name, 2, 0, std::vector<std::string>{"x", "y"},
+                std::vector<std::string>{"i", "i"}, RelationRepresentation::BTREE));
+    }
+    const RamRelation* edge = rels[0].get();
+    const RamRelation* reachable = rels[1].get();
+    const RamRelation* delta = rels[2].get();
+    const RamRelation* fresh = rels[3].get();
+
+    auto ref = [](const RamRelation* rel) { return std::make_unique<RamRelationReference>(rel); };
+    auto element = [](int tupleId, size_t i) { return std::make_unique<RamTupleElement>(tupleId, i); };
+    auto pair = [](std::unique_ptr<RamExpression> x, std::unique_ptr<RamExpression> y) {
+        std::vector<std::unique_ptr<RamExpression>> res;
+        res.push_back(std::move(x));
+        res.push_back(std::move(y));
+        return res;
+    };
+    auto copy = [&](const RamRelation* source, const RamRelation* target) {
+        return std::make_unique<RamQuery>(std::make_unique<RamScan>(ref(source), 0,
+                std::make_unique<RamProject>(ref(target), pair(element(0, 0), element(0, 1)))));
+    };
+
+    // FOR t0 IN @delta_reachable  FOR t1 IN edge ON INDEX t1.0 = t0.1
+    //   IF (t0.0, t1.1) NOT IN reachable  PROJECT (t0.0, t1.1) INTO @new_reachable
+    auto step = std::make_unique<RamQuery>(std::make_unique<RamScan>(ref(delta), 0,
+            std::make_unique<RamIndexScan>(ref(edge), 1,
+                    pair(element(0, 1), std::make_unique<RamUndefValue>()),
+                    std::make_unique<RamFilter>(
+                            std::make_unique<RamNegation>(std::make_unique<RamExistenceCheck>(
+                                    ref(reachable), pair(element(0, 0), element(1, 1)))),
+                            std::make_unique<RamProject>(ref(fresh), pair(element(0, 0), element(1, 1)))))));
+    std::unique_ptr<RamStatement> main = std::make_unique<RamSequence>(
+            std::make_unique<RamClear>(ref(reachable)), std::make_unique<RamClear>(ref(delta)),
+            copy(edge, reachable), copy(reachable, delta),
+            std::make_unique<RamLoop>(std::make_unique<RamSequence>(std::move(step),
+                    std::make_unique<RamExit>(std::make_unique<RamEmptinessCheck>(ref(fresh))),
+                    copy(fresh, reachable), std::make_unique<RamSwap>(ref(delta), ref(fresh)),
+                    std::make_unique<RamClear>(ref(fresh)))));
+
+    InterpreterFixture fixture(std::move(rels), std::move(main));
+    InterpreterEngine& interpreter = fixture.interpreter;
+
+    // a chain, hence every iteration joins a delta of about N tuples
+    const RamDomain N = 1000;
+    std::vector<RamDomain> tuples;
+    for (RamDomain x = 0; x + 1 < N; ++x) {
+        tuples.push_back(x);
+        tuples.push_back(x + 1);
+    }
+    interpreter.getRelation("edge")->insertAll(tuples.data(), N - 1);
+
+    // the fastest of several rounds, the others are disturbed by the machine
+    long best = std::numeric_limits<long>::max();
+    for (int i = 0; i < 5; ++i) {
+        auto start = now();
+        interpreter.executeMain();
+        auto end = now();
+        best = std::min<long>(best, duration_in_us(start, end) / 1000);
+    }
+    std::cout << "\tclosure of a chain of " << N << " nodes ... done [" << std::setw(5) << best << "ms]\n";
+    EXPECT_EQ(static_cast<size_t>(N) * (N - 1) / 2, interpreter.getRelation("reachable")->size());
+}
+
+TEST(InterpreterJit, CompileQuery) {
+    // queries are compiled by the host compiler; without one there is nothing to test
+    const char* cxx = std::getenv("CXX");
+    const std::string probe = std::string(cxx != nullptr ? cxx : "c++") + " --version >/dev/null 2>&1";
+    if (std::system(probe.c_str()) != 0) {
+        std::cout << "\tno host compiler, skipped\n";
+        return;
+    }
+    Global::config().set("jobs", "4");
+
+    // B(x, z) :- A(x, y), A(y, z), x + 1 < z * 2, !B(x, z).   by a parallel scan and an index scan
+    std::vector<std::unique_ptr<RamRelation>> rels;
+    for (const char* name : {"A", "B"}) {
+        rels.push_back(std::make_unique<RamRelation>(name, 2, 0, std::vector<std::string>{"x", "y"},
+                std::vector<std::string>{"i", "i"}, RelationRepresentation::BTREE));
+    }
+    const RamRelation* a = rels[0].get();
+    const RamRelation* b = rels[1].get();
+
+    auto element = [](int tupleId, size_t i) { return std::make_unique<RamTupleElement>(tupleId, i); };
+    auto binary = [](FunctorOp op, std::unique_ptr<RamExpression> lhs, std::unique_ptr<RamExpression> rhs) {
+        std::vector<std::unique_ptr<RamExpression>> args;
+        args.push_back(std::move(lhs));
+        args.push_back(std::move(rhs));
+        return std::make_unique<RamIntrinsicOperator>(op, std::move(args));
+    };
+
+    std::vector<std::unique_ptr<RamExpression>> pattern;
+    pattern.push_back(element(0, 1));
+    pattern.push_back(std::make_unique<RamUndefValue>());
+    std::vector<std::unique_ptr<RamExpression>> key;
+    key.push_back(element(0, 0));
+    key.push_back(element(1, 1));
+    std::vector<std::unique_ptr<RamExpression>> values;
+    values.push_back(element(0, 0));
+    values.push_back(element(1, 1));
+
+    auto condition = std::make_unique<RamConjunction>(
+            std::make_unique<RamConstraint>(BinaryConstraintOp::LT,
+                    binary(FunctorOp::ADD, element(0, 0), std::make_unique<RamSignedConstant>(1)),
+                    binary(FunctorOp::MUL, element(1, 1), std::make_unique<RamSignedConstant>(2))),
+            std::make_unique<RamNegation>(std::make_unique<RamExistenceCheck>(
+                    std::make_unique<RamRelationReference>(b), std::move(key))));
+    std::unique_ptr<RamStatement> main = std::make_unique<RamSequence>(std::make_unique<RamQuery>(
+            std::make_unique<RamParallelScan>(std::make_unique<RamRelationReference>(a), 0,
+                    std::make_unique<RamIndexScan>(std::make_unique<RamRelationReference>(a), 1,
+                            std::move(pattern),
+                            std::make_unique<RamFilter>(std::move(condition),
+                                    std::make_unique<RamProject>(std::make_unique<RamRelationReference>(b),
+                                            std::move(values)))))));
+    const RamStatement& query = *main;
+
+    InterpreterFixture fixture(std::move(rels), std::move(main));
+    InterpreterEngine& interpreter = fixture.interpreter;
+
+    // index positions as the node generator encodes them
+    RamIndexAnalysis* isa = fixture.translationUnit.getAnalysis<RamIndexAnalysis>();
+    std::unordered_map<const RamNode*, size_t> indexTable;
+    visitDepthFirst(query, [&](const RamIndexScan& scan) {
+        indexTable[&scan] =
+                isa->getIndexes(scan.getRelation()).getLexOrderNum(isa->getSearchSignature(&scan));
+    });
+    visitDepthFirst(query, [&](const RamExistenceCheck& exists) {
+        indexTable[&exists] =
+                isa->getIndexes(exists.getRelation()).getLexOrderNum(isa->getSearchSignature(&exists));
+    });
+
+    InterpreterJitGenerator generator(isa, indexTable);
+    const RamQuery* ramQuery = nullptr;
+    visitDepthFirst(query, [&](const RamQuery& cur) { ramQuery = &cur; });
+    ASSERT_TRUE(generator.generate(*ramQuery));
+    EXPECT_EQ(generator.getRelations(), (std::vector<const RamRelation*>{a, b}));
+
+    auto jitQuery = std::make_shared<InterpreterJitQuery>(generator.getSource(), std::vector<size_t>{0, 1});
+    EXPECT_FALSE(jitQuery->addTime(std::chrono::milliseconds(1), std::chrono::milliseconds(2)));
+    EXPECT_TRUE(jitQuery->addTime(std::chrono::milliseconds(1), std::chrono::milliseconds(2)));
+    EXPECT_FALSE(jitQuery->addTime(std::chrono::milliseconds(1), std::chrono::milliseconds(2)));
+
+    // the compile command is assembled when the jit is created
+    const bool hasIncludeDir = Global::config().has("jit-include-dir");
+    const std::string includeDir = Global::config().get("jit-include-dir");
+    Global::config().set("jit-include-dir", SRCDIR);
+    InterpreterJit jit(std::chrono::milliseconds(2));
+    if (hasIncludeDir) {
+        Global::config().set("jit-include-dir", includeDir);
+    } else {
+        Global::config().unset("jit-include-dir");
+    }
+    jit.submit(jitQuery);
+    jit.wait();
+    InterpreterJitQueryBody body = jitQuery->getBody();
+    ASSERT_TRUE(body != nullptr);
+
+    std::vector<RamDomain> tuples;
+    std::set<std::pair<RamDomain, RamDomain>> expected;
+    for (RamDomain x = 0; x < 50; ++x) {
+        for (RamDomain y = x; y < x + 3; ++y) {
+            tuples.push_back(x);
+            tuples.push_back(y);
+        }
+    }
+    for (size_t i = 0; i < tuples.size(); i += 2) {
+        for (size_t j = 0; j < tuples.size(); j += 2) {
+            if (tuples[i + 1] == tuples[j] && tuples[i] + 1 < tuples[j + 1] * 2) {
+                expected.emplace(tuples[i], tuples[j + 1]);
+            }
+        }
+    }
+    InterpreterRelation* rel[] = {interpreter.getRelation("A"), interpreter.getRelation("B")};
+    rel[0]->insertAll(tuples.data(), tuples.size() / 2);
+    body(jit.getRuntime(), rel);
+
+    std::set<std::pair<RamDomain, RamDomain>> derived;
+    for (const RamDomain* tuple : *rel[1]) {
+        derived.emplace(tuple[0], tuple[1]);
+    }
+    EXPECT_EQ(derived, expected);
+}
+
+TEST(InterpreterJit, UnsupportedQuery) {
+    // queries with user-defined functors are left to the interpreter
+    RamRelation a("A", 1, 0, {"x"}, {"i"}, RelationRepresentation::BTREE);
+    std::vector<std::unique_ptr<RamExpression>> args;
+    args.push_back(std::make_unique<RamTupleElement>(0, 0));
+    std::vector<std::unique_ptr<RamExpression>> values;
+    values.push_back(std::make_unique<RamUserDefinedOperator>(
+            "f", std::vector<TypeAttribute>{TypeAttribute::Signed}, TypeAttribute::Signed, std::move(args)));
+    RamQuery query(std::make_unique<RamScan>(std::make_unique<RamRelationReference>(&a), 0,
+            std::make_unique<RamProject>(std::make_unique<RamRelationReference>(&a), std::move(values))));
+
+    std::unordered_map<const RamNode*, size_t> indexTable;
+    InterpreterJitGenerator generator(nullptr, indexTable);
+    EXPECT_FALSE(generator.generate(query));
+}
+
 }  // end namespace souffle::test
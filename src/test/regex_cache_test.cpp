@@ -0,0 +1,107 @@
+/*
+ * Souffle - A Datalog Compiler
+ * Copyright (c) 2020, The Souffle Developers. All rights reserved
+ * Licensed under the Universal Permissive License v 1.0 as shown at:
+ * - https://opensource.org/licenses/UPL
+ * - <souffle root>/licenses/SOUFFLE-UPL.txt
+ */
+
+/************************************************************************
+ *
+ * @file regex_cache_test.cpp
+ *
+ * A test case testing the cache of compiled patterns of match constraints.
+ *
+ ***********************************************************************/
+
+#include "RamTypes.h"
+#include "RegexCache.h"
+#include "SymbolTable.h"
+#include "test.h"
+
+#include <iomanip>
+#include <iostream>
+#include <regex>
+#include <string>
+#include <vector>
+
+namespace souffle {
+
+namespace test {
+
+TEST(RegexCache, Basic) {
+    SymbolTable symbols;
+    RegexCache cache;
+
+    RamDomain digits = symbols.lookup("[0-9]+");
+    RegexCache::RegexPtr regex = cache.get(digits, symbols);
+    EXPECT_TRUE(regex != nullptr);
+    EXPECT_TRUE(std::regex_match("42", *regex));
+    EXPECT_FALSE(std::regex_match("x42", *regex));
+
+    // a hit returns the pattern compiled on the miss
+    EXPECT_EQ(regex.get(), cache.get(digits, symbols).get());
+
+    // invalid patterns are cached as nullptr
+    RamDomain invalid = symbols.lookup("[0-9");
+    EXPECT_TRUE(cache.get(invalid, symbols) == nullptr);
+    EXPECT_TRUE(cache.get(invalid, symbols) == nullptr);
+}
+
+TEST(RegexCache, Capacity) {
+    SymbolTable symbols;
+    RegexCache cache(2);
+
+    RamDomain a = symbols.lookup("a*");
+    RamDomain b = symbols.lookup("b*");
+    RamDomain c = symbols.lookup("c*");
+    RegexCache::RegexPtr regexA = cache.get(a, symbols);
+    EXPECT_EQ(regexA.get(), cache.get(a, symbols).get());
+    cache.get(b, symbols);
+
+    // the cache is full, hence it starts over and compiles the patterns again
+    RegexCache::RegexPtr regexC = cache.get(c, symbols);
+    EXPECT_TRUE(std::regex_match("ccc", *regexC));
+    EXPECT_NE(regexA.get(), cache.get(a, symbols).get());
+}
+
+TEST(Performance, RegexCache) {
+    const int N = 1 << 16;
+
+    // few distinct patterns, as computed by a match constraint over many tuples
+    SymbolTable symbols;
+    std::vector<RamDomain> patterns;
+    for (int i = 0; i < 16; i++) {
+        patterns.push_back(symbols.lookup("[a-z]*" + std::to_string(i) + "[0-9]*"));
+    }
+    std::vector<std::string> texts;
+    for (int i = 0; i < N; i++) {
+        texts.push_back("tuple" + std::to_string(i));
+    }
+
+    std::cout << "\tcompiling the pattern per tuple ... " << std::flush;
+    int compiledMatches = 0;
+    auto start = now();
+    for (int i = 0; i < N; i++) {
+        std::regex regex(symbols.resolve(patterns[i % patterns.size()]));
+        compiledMatches += std::regex_match(texts[i], regex) ? 1 : 0;
+    }
+    auto end = now();
+    std::cout << " done [" << std::setw(5) << duration_in_us(start, end) / 1000 << "ms]\n";
+
+    std::cout << "\tlooking the pattern up in the cache ... " << std::flush;
+    RegexCache cache;
+    int cachedMatches = 0;
+    start = now();
+    for (int i = 0; i < N; i++) {
+        RegexCache::RegexPtr regex = cache.get(patterns[i % patterns.size()], symbols);
+        cachedMatches += std::regex_match(texts[i], *regex) ? 1 : 0;
+    }
+    end = now();
+    std::cout << " done [" << std::setw(5) << duration_in_us(start, end) / 1000 << "ms]\n";
+
+    EXPECT_EQ(compiledMatches, cachedMatches);
+}
+
+}  // namespace test
+}  // namespace souffle
@@ -0,0 +1,272 @@
+/*
+ * Souffle - A Datalog Compiler
+ * Copyright (c) 2020, The Souffle Developers. All rights reserved
+ * Licensed under the Universal Permissive License v 1.0 as shown at:
+ * - https://opensource.org/licenses/UPL
+ * - <souffle root>/licenses/SOUFFLE-UPL.txt
+ */
+
+/************************************************************************
+ *
+ * @file sorted_array_test.cpp
+ *
+ * A test case testing the sorted arrays utilized by read-only relations.
+ *
+ ***********************************************************************/
+
+#include "BTree.h"
+#include "CompiledIndexUtils.h"
+#include "CompiledTuple.h"
+#include "SortedArray.h"
+#include "test.h"
+
+#include <algorithm>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <set>
+#include <string>
+#include <vector>
+
+namespace souffle {
+
+namespace test {
+
+using t_tuple = Tuple<int, 2>;
+
+// a set of pairs ordered by both components
+using full_array = sorted_array<t_tuple, index_utils::comparator<0, 1>>;
+
+// a set of pairs ordered by the second component, tolerating shared keys
+using key_array = sorted_array<t_tuple, index_utils::comparator<1>, false>;
+
+TEST(SortedArray, Basic) {
+    full_array t;
+
+    EXPECT_TRUE(t.empty());
+    EXPECT_EQ(0, t.size());
+    EXPECT_FALSE(t.contains({1, 2}));
+
+    EXPECT_TRUE(t.insert({1, 2}));
+    EXPECT_FALSE(t.empty());
+    EXPECT_EQ(1, t.size());
+    EXPECT_TRUE(t.contains({1, 2}));
+    EXPECT_FALSE(t.contains({2, 1}));
+
+    EXPECT_FALSE(t.insert({1, 2}));
+    EXPECT_EQ(1, t.size());
+
+    // duplicates among pending insertions are dropped when sealing
+    EXPECT_TRUE(t.insert({2, 1}));
+    EXPECT_TRUE(t.insert({2, 1}));
+    EXPECT_EQ(2, t.size());
+    EXPECT_TRUE(t.contains({2, 1}));
+
+    t.clear();
+    EXPECT_TRUE(t.empty());
+    EXPECT_FALSE(t.contains({1, 2}));
+}
+
+TEST(SortedArray, Order) {
+    const int N = 10000;
+
+    std::vector<t_tuple> data;
+    for (int i = 0; i < N; i++) {
+        data.push_back({i % 97, i});
+        data.push_back({i % 97, i});
+    }
+    std::shuffle(data.begin(), data.end(), std::mt19937(3));
+
+    // insert in two batches, such that the second one is merged into the sealed array
+    full_array t;
+    t.insert(data.begin(), data.begin() + N);
+    EXPECT_LT(0, t.size());
+    t.insertAll(data.begin() + N, data.end());
+    EXPECT_EQ(N, t.size());
+
+    std::set<t_tuple> should(data.begin(), data.end());
+    EXPECT_TRUE(std::equal(should.begin(), should.end(), t.begin(), t.end()));
+
+    for (int i = 0; i < N; i++) {
+        EXPECT_TRUE(t.contains({i % 97, i}));
+        EXPECT_FALSE(t.contains({i % 97 + 1, i}));
+    }
+}
+
+TEST(SortedArray, Bounds) {
+    // large enough to be searched through the directory
+    const int N = 100 * full_array::STRIDE;
+
+    full_array t;
+    std::set<t_tuple> should;
+    for (int i = 0; i < N; i++) {
+        t.insert({2 * (i / 3), i % 3});
+        should.insert({2 * (i / 3), i % 3});
+    }
+    EXPECT_EQ(N, t.size());
+
+    for (int i = -1; i < 2 * N / 3 + 2; i++) {
+        for (int j = -1; j < 4; j++) {
+            t_tuple probe = {i, j};
+            EXPECT_EQ(std::distance(should.begin(), should.lower_bound(probe)),
+                    std::distance(t.begin(), t.lower_bound(probe)));
+            EXPECT_EQ(std::distance(should.begin(), should.upper_bound(probe)),
+                    std::distance(t.begin(), t.upper_bound(probe)));
+        }
+    }
+}
+
+TEST(SortedArray, Multiset) {
+    key_array t;
+    for (int i = 0; i < 100; i++) {
+        for (int j = 0; j < i % 7; j++) {
+            t.insert({j, i});
+            t.insert({j, i});
+        }
+    }
+
+    std::size_t count = 0;
+    for (int i = 0; i < 100; i++) {
+        auto a = t.lower_bound({0, i});
+        auto b = t.upper_bound({0, i});
+        EXPECT_EQ(i % 7, std::distance(a, b));
+        for (auto cur = a; cur != b; ++cur) {
+            EXPECT_EQ(i, (*cur)[1]);
+        }
+        EXPECT_EQ(i % 7 != 0, t.contains({0, i}));
+        EXPECT_FALSE(t.contains({7, i}));
+        count += i % 7;
+    }
+    EXPECT_EQ(count, t.size());
+}
+
+TEST(SortedArray, ChunkSplit) {
+    full_array t;
+
+    EXPECT_TRUE(t.getChunks(10).empty());
+
+    for (int i = 0; i < 1000; i++) {
+        t.insert({i, 0});
+    }
+
+    for (size_t num : {1, 3, 10, 100, 10000}) {
+        auto chunks = t.getChunks(num);
+        EXPECT_LT(0, chunks.size());
+        EXPECT_LT(chunks.size(), num + 1);
+
+        std::vector<t_tuple> is;
+        for (const auto& cur : chunks) {
+            EXPECT_FALSE(cur.empty());
+            for (const auto& tuple : cur) {
+                is.push_back(tuple);
+            }
+        }
+        EXPECT_EQ(1000, is.size());
+        EXPECT_TRUE(std::is_sorted(is.begin(), is.end()));
+    }
+}
+
+TEST(SortedArray, Parallel) {
+    const int N = 10000;
+
+    // the number of times duplicates show up in the input set
+    for (int dup = 1; dup < 4; dup++) {
+        std::vector<t_tuple> full;
+        for (int i = 0; i < dup; i++) {
+            for (int j = 0; j < N; j++) {
+                full.push_back({j % 100, j});
+            }
+        }
+        std::shuffle(full.begin(), full.end(), std::mt19937(dup));
+
+        // insert all those values in parallel, then read them in parallel
+        full_array res;
+#pragma omp parallel for
+        for (size_t i = 0; i < full.size(); ++i) {
+            res.insert(full[i]);
+        }
+
+        std::size_t found = 0;
+#pragma omp parallel for reduction(+ : found)
+        for (int j = 0; j < N; j++) {
+            found += res.contains({j % 100, j}) ? 1 : 0;
+        }
+
+        EXPECT_EQ(N, found);
+        EXPECT_EQ(N, res.size());
+    }
+}
+
+template <typename Op>
+long time(const std::string& name, const Op& operation) {
+    std::cout << "\t" << std::setw(30) << std::setiosflags(std::ios::left) << name
+              << std::resetiosflags(std::ios::left) << " ... " << std::flush;
+    auto a = now();
+    operation();
+    auto b = now();
+    long time = duration_in_us(a, b) / 1000;
+    std::cout << " done [" << std::setw(5) << time << "ms]\n";
+    return time;
+}
+
+TEST(Performance, SortedArray) {
+    int N = 1 << 20;
+
+    // loaded tuples and probes missing in the relation
+    std::vector<t_tuple> in;
+    std::vector<t_tuple> out;
+    std::mt19937 generator(42);
+    std::uniform_int_distribution<int> dist(0, N);
+    for (int i = 0; i < N; i++) {
+        in.push_back({dist(generator), 2 * i});
+        out.push_back({dist(generator), 2 * i + 1});
+    }
+
+    using btree = btree_set<t_tuple, index_utils::comparator<0, 1>>;
+    std::cout << "Testing: souffle btree_set ..\n";
+    btree a;
+    time("load", [&]() {
+        for (const auto& cur : in) {
+            a.insert(cur);
+        }
+    });
+    bool allPresent = true;
+    time("membership in", [&]() {
+        for (const auto& cur : in) {
+            allPresent = a.contains(cur) && allPresent;
+        }
+    });
+    bool allMissing = true;
+    time("membership out", [&]() {
+        for (const auto& cur : out) {
+            allMissing = !a.contains(cur) && allMissing;
+        }
+    });
+    EXPECT_TRUE(allPresent && allMissing);
+
+    std::cout << "Testing: souffle sorted_array ..\n";
+    full_array b;
+    time("load", [&]() {
+        for (const auto& cur : in) {
+            b.insert(cur);
+        }
+        b.seal();
+    });
+    allPresent = true;
+    time("membership in", [&]() {
+        for (const auto& cur : in) {
+            allPresent = b.contains(cur) && allPresent;
+        }
+    });
+    allMissing = true;
+    time("membership out", [&]() {
+        for (const auto& cur : out) {
+            allMissing = !b.contains(cur) && allMissing;
+        }
+    });
+    EXPECT_TRUE(allPresent && allMissing);
+    EXPECT_EQ(a.size(), b.size());
+}
+
+}  // namespace test
+}  // end namespace souffle